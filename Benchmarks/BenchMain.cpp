@@ -0,0 +1,69 @@
+/*
+ ==============================================================================
+ BenchMain.cpp
+ ==============================================================================
+ ScratchMyVoiceBench のエントリポイント。
+
+   ScratchMyVoiceBench [name] [options...]
+
+ name を省略すると全ベンチマークを実行する。オプションは各ベンチマークへ
+ そのまま渡す（例: library --sizes 1000,10000 --keep-fixtures、kernel --seconds 60、codec --seconds 300、
+ ui --sizes 1920x1080,3840x2160 --frames 240）。
+ ==============================================================================
+ */
+#include <JuceHeader.h>
+#include "Benchmarks.h"
+
+namespace
+{
+    struct BenchmarkInfo
+    {
+        const char* name;
+        bool (*run) (const juce::StringArray&);
+    };
+
+    const BenchmarkInfo benchmarks[] =
+    {
+        { "library", runLibraryListBenchmark },
+        { "kernel",  runSampleKernelBenchmark },
+        { "codec",   runLibraryCodecBenchmark },
+        { "ui",      runUiRenderBenchmark },
+    };
+}
+
+int main (int argc, char* argv[])
+{
+    // コンポーネントを描画するので GUI 側のメッセージループまで初期化
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add (juce::String::fromUTF8 (argv[i]));
+
+    juce::String selected;
+    if (! args.isEmpty() && ! args[0].startsWith ("-"))
+    {
+        selected = args[0];
+        args.remove (0);
+    }
+
+    bool ranAny = false, allPassed = true;
+
+    for (const auto& b : benchmarks)
+    {
+        if (selected.isNotEmpty() && selected != b.name)
+            continue;
+
+        std::cout << "== " << b.name << " ==" << std::endl;
+        allPassed = b.run (args) && allPassed;
+        ranAny = true;
+    }
+
+    if (! ranAny)
+    {
+        std::cerr << "Unknown benchmark: " << selected << std::endl;
+        return 2;
+    }
+
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+/*
+ ==============================================================================
+ BenchUtils.h
+ ==============================================================================
+ ベンチマーク共通の小道具（計測・集計・メモリ使用量）。
+
+ • 計測は高分解能ティックで行い、ミリ秒で集計
+ • 中央値 / p95 / 最大を出す（平均はスパイクを隠すので使わない）
+ • RSS は OS から直接読む（Linux: /proc/self/statm, macOS: mach_task_basic_info）
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+#if JUCE_MAC || JUCE_IOS
+ #include <mach/mach.h>
+#endif
+
+namespace bench
+{
+    // ── 計測 ─────────────────────────────────────────────────────────────────
+    class Stopwatch
+    {
+    public:
+        Stopwatch() : start (juce::Time::getHighResolutionTicks()) {}
+
+        double elapsedMs() const
+        {
+            return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1000.0;
+        }
+
+    private:
+        juce::int64 start;
+    };
+
+    struct Summary
+    {
+        double median = 0.0, p95 = 0.0, max = 0.0;
+    };
+
+    inline Summary summarise (std::vector<double> samples)
+    {
+        Summary s;
+        if (samples.empty())
+            return s;
+
+        std::sort (samples.begin(), samples.end());
+        const auto at = [&samples] (double q)
+        {
+            return samples[juce::jlimit<size_t> (0, samples.size() - 1, (size_t) (q * (double) (samples.size() - 1) + 0.5))];
+        };
+
+        s.median = at (0.5);
+        s.p95 = at (0.95);
+        s.max = samples.back();
+        return s;
+    }
+
+    // ── メモリ ───────────────────────────────────────────────────────────────
+    // 常駐メモリ (RSS) をバイトで返す。取得できない環境では 0
+    inline juce::int64 getResidentBytes()
+    {
+       #if JUCE_LINUX || JUCE_BSD
+        juce::int64 totalPages = 0, residentPages = 0;
+        if (auto* f = std::fopen ("/proc/self/statm", "r"))
+        {
+            if (std::fscanf (f, "%lld %lld", &totalPages, &residentPages) != 2)
+                residentPages = 0;
+            std::fclose (f);
+        }
+        return residentPages * (juce::int64) sysconf (_SC_PAGESIZE);
+       #elif JUCE_MAC || JUCE_IOS
+        mach_task_basic_info info {};
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info (mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS)
+            return 0;
+        return (juce::int64) info.resident_size;
+       #else
+        return 0;
+       #endif
+    }
+
+    inline juce::String formatMB (juce::int64 bytes)
+    {
+        return juce::String ((double) bytes / (1024.0 * 1024.0), 1) + " MB";
+    }
+
+    inline juce::String formatMs (const Summary& s)
+    {
+        return "median " + juce::String (s.median, 2) + " ms, p95 " + juce::String (s.p95, 2)
+             + " ms, max " + juce::String (s.max, 2) + " ms";
+    }
+
+    // ── メッセージループ ─────────────────────────────────────────────────────
+    // 条件が満たされるまでメッセージを処理する（タイムアウトで false）
+    template <typename Predicate>
+    bool pumpUntil (Predicate&& done, int timeoutMs)
+    {
+        const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+
+        while (! done())
+        {
+            if (juce::Time::getMillisecondCounter() > deadline)
+                return false;
+
+            juce::MessageManager::getInstance()->runDispatchLoopUntil (5);
+        }
+
+        return true;
+    }
+}
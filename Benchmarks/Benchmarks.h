@@ -0,0 +1,22 @@
+/*
+ ==============================================================================
+ Benchmarks.h
+ ==============================================================================
+ ScratchMyVoiceBench に含まれるベンチマークの一覧。
+ 各ベンチマークは結果を標準出力に書き、失敗時は false を返す。
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+// ライブラリ一覧: 1k/10k/100k ファイルでの更新時間・スクロールのフレーム時間・メモリ
+bool runLibraryListBenchmark (const juce::StringArray& args);
+
+// デッキの再生カーネル: float32 / int16 サンプルの補間スループット
+bool runSampleKernelBenchmark (const juce::StringArray& args);
+
+// ライブラリの保存形式: WAV / FLAC / Ogg Vorbis のサイズとデコード速度（1 回の read・並列・キャッシュ）
+bool runLibraryCodecBenchmark (const juce::StringArray& args);
+
+// デッキまわりの描画: Turntable / Waveform / Crossfader をソフトウェアレンダラーで描いたフレーム時間
+bool runUiRenderBenchmark (const juce::StringArray& args);
@@ -0,0 +1,228 @@
+/*
+ ==============================================================================
+ LibraryCodecBenchmark.cpp
+ ==============================================================================
+ ライブラリの保存形式 (LibraryEncoder) ごとのサイズとデコード速度。
+
+ 声っぽいステレオ素材（既定 120 秒、48kHz）を 16bit WAV で書き、
+ FLAC / Ogg Vorbis へ変換して
+   • ファイルサイズ（WAV 比）と変換時間
+   • 1 回の reader->read で全体を読む時間（従来のロード）
+   • ChunkedDecoder で並列に読む時間（スロットのロードの経路）
+   • DecodedSampleCache のミス（デコード + 保存）とヒット（マップのみ）の時間
+ を出力する（時間は実時間比 = 素材の長さ / かかった時間 も併記）。
+ FLAC は WAV と、並列デコードは 1 回の read とサンプル単位で一致することを確認する。
+ ==============================================================================
+ */
+#include "Benchmarks.h"
+#include "BenchUtils.h"
+#include "LibraryEncoder.h"
+#include "ChunkedDecoder.h"
+#include "DecodedSampleCache.h"
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int defaultSeconds = 120;
+    constexpr int numTrials = 5;
+
+    int parseSeconds (const juce::StringArray& args)
+    {
+        const int index = args.indexOf ("--seconds");
+        if (index < 0 || index + 1 >= args.size())
+            return defaultSeconds;
+
+        return juce::jmax (1, args[index + 1].getIntValue());
+    }
+
+    // 母音っぽい倍音 + 音節ごとの振幅の揺れ + 少しのノイズ（無音や純音だと FLAC が有利になりすぎる）
+    juce::AudioBuffer<float> makeSource (int numSamples)
+    {
+        juce::AudioBuffer<float> buffer (2, numSamples);
+        juce::Random random (11);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            auto* data = buffer.getWritePointer (ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double t = (double) i / sampleRate;
+                const double f0 = 140.0 + 30.0 * std::sin (juce::MathConstants<double>::twoPi * 0.3 * t);
+                const double envelope = 0.5 + 0.5 * std::sin (juce::MathConstants<double>::twoPi * 4.0 * t + ch);
+
+                double voice = 0.0;
+                for (int h = 1; h <= 6; ++h)
+                    voice += std::sin (juce::MathConstants<double>::twoPi * f0 * h * t) / h;
+
+                data[i] = (float) (0.25 * envelope * voice) + (random.nextFloat() - 0.5f) * 0.02f;
+            }
+        }
+
+        return buffer;
+    }
+
+    bool writeWav (const juce::File& file, const juce::AudioBuffer<float>& buffer)
+    {
+        juce::WavAudioFormat wavFormat;
+        std::unique_ptr<juce::AudioFormatWriter> writer (
+            wavFormat.createWriterFor (new juce::FileOutputStream (file), sampleRate,
+                                       (unsigned int) buffer.getNumChannels(), 16, {}, 0));
+
+        return writer != nullptr && writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+    }
+
+    template <typename Fn>
+    double medianMs (Fn&& fn)
+    {
+        std::vector<double> times;
+        for (int trial = 0; trial < numTrials; ++trial)
+        {
+            bench::Stopwatch sw;
+            fn();
+            times.push_back (sw.elapsedMs());
+        }
+
+        return bench::summarise (std::move (times)).median;
+    }
+
+    juce::String formatTime (double ms, double seconds)
+    {
+        return juce::String (ms, 1) + " ms (x" + juce::String (seconds * 1000.0 / juce::jmax (0.001, ms), 0) + " realtime)";
+    }
+
+    bool buffersEqual (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() != b.getNumSamples())
+            return false;
+
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            if (std::memcmp (a.getReadPointer (ch), b.getReadPointer (ch), (size_t) a.getNumSamples() * sizeof (float)) != 0)
+                return false;
+
+        return true;
+    }
+}
+
+bool runLibraryCodecBenchmark (const juce::StringArray& args)
+{
+    const int seconds = parseSeconds (args);
+    const int numSamples = (int) (seconds * sampleRate);
+
+    auto folder = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                      .getChildFile ("ScratchMyVoiceBench_codec_" + juce::String::toHexString (juce::Random::getSystemRandom().nextInt()));
+    folder.createDirectory();
+
+    const auto wavFile = folder.getChildFile ("take.wav");
+    if (! writeWav (wavFile, makeSource (numSamples)))
+    {
+        std::cerr << "  could not write " << wavFile.getFullPathName() << std::endl;
+        folder.deleteRecursively();
+        return false;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    juce::ThreadPool pool (juce::jmax (1, juce::SystemStats::getNumCpus() - 1));
+
+    struct Candidate
+    {
+        const char* name;
+        LibraryEncoder::Codec codec;
+        int lossyQuality;
+    };
+
+    const Candidate candidates[] =
+    {
+        { "wav16",      LibraryEncoder::Codec::wav,       0 },
+        { "flac",       LibraryEncoder::Codec::flac,      0 },
+        { "ogg q3",     LibraryEncoder::Codec::oggVorbis, 3 },
+        { "ogg q6",     LibraryEncoder::Codec::oggVorbis, 6 },
+    };
+
+    std::cout << "  source: " << seconds << " s, 2 ch, " << (int) sampleRate << " Hz, "
+              << "decode pool " << pool.getNumThreads() << " threads" << std::endl;
+
+    juce::AudioBuffer<float> reference;
+    bool ok = true;
+
+    for (const auto& candidate : candidates)
+    {
+        auto file = wavFile;
+        double encodeMs = 0.0;
+
+        if (candidate.codec != LibraryEncoder::Codec::wav)
+        {
+            file = folder.getChildFile (juce::String ("take_") + juce::String (candidate.name).removeCharacters (" ")
+                                        + LibraryEncoder::getFileExtension (candidate.codec));
+            bench::Stopwatch sw;
+            if (! LibraryEncoder::encodeFile (wavFile, file, candidate.codec, candidate.lossyQuality))
+            {
+                std::cerr << "  " << candidate.name << ": encoding failed" << std::endl;
+                ok = false;
+                continue;
+            }
+            encodeMs = sw.elapsedMs();
+        }
+
+        std::cout << "  " << juce::String (candidate.name).paddedRight (' ', 7) << " "
+                  << bench::formatMB (file.getSize()) << " ("
+                  << juce::String (100.0 * (double) file.getSize() / (double) wavFile.getSize(), 0) << "% of wav)"
+                  << (encodeMs > 0.0 ? ", encode " + juce::String (encodeMs, 0) + " ms" : juce::String()) << std::endl;
+
+        // ── 1 回の read（従来） ───────────────────────────────────────────
+        juce::AudioBuffer<float> serial;
+        const double serialMs = medianMs ([&]
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+            serial.setSize (2, (int) reader->lengthInSamples);
+            reader->read (&serial, 0, serial.getNumSamples(), 0, true, true);
+        });
+
+        // ── チャンク並列 ────────────────────────────────────────────────
+        juce::AudioBuffer<float> chunked;
+        const double chunkedMs = medianMs ([&]
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+            chunked.setSize (2, (int) reader->lengthInSamples);
+            ChunkedDecoder::decode (formatManager, file, *reader, chunked.getArrayOfWritePointers(), 2,
+                                    0, reader->lengthInSamples, pool, {});
+        });
+
+        std::cout << "    read once:  " << formatTime (serialMs, seconds) << std::endl;
+        std::cout << "    chunked:    " << formatTime (chunkedMs, seconds) << std::endl;
+
+        if (! buffersEqual (serial, chunked))
+        {
+            std::cerr << "    MISMATCH: chunked decode differs from a single read" << std::endl;
+            ok = false;
+        }
+
+        if (candidate.codec == LibraryEncoder::Codec::wav)
+            reference.makeCopyOf (serial);
+        else if (candidate.codec == LibraryEncoder::Codec::flac && ! buffersEqual (reference, serial))
+        {
+            std::cerr << "    MISMATCH: flac is not bit-exact with the wav" << std::endl;
+            ok = false;
+        }
+
+        // ── スロットのロード（デコード済みキャッシュのミス / ヒット） ──
+        {
+            DecodedSampleCache cache (folder.getChildFile ("cache_" + juce::String (candidate.name).removeCharacters (" ")));
+
+            const double missMs = medianMs ([&]
+            {
+                cache.getFolder().deleteRecursively();
+                cache.getFolder().createDirectory();
+                cache.open (formatManager, file, sampleRate);
+            });
+
+            const double hitMs = medianMs ([&] { cache.open (formatManager, file, sampleRate); });
+
+            std::cout << "    cache miss: " << formatTime (missMs, seconds) << std::endl;
+            std::cout << "    cache hit:  " << juce::String (hitMs, 2) << " ms" << std::endl;
+        }
+    }
+
+    folder.deleteRecursively();
+    return ok;
+}
@@ -0,0 +1,249 @@
+/*
+ ==============================================================================
+ LibraryListBenchmark.cpp
+ ==============================================================================
+ ライブラリ一覧 (SampleListComponent) のスケール計測。
+
+ 各サイズ (既定 1k / 10k / 100k) ごとに一時フォルダへ極小 WAV を生成し、
+   • コールド更新: インデックス無しの状態から全件が一覧に並ぶまで
+   • ウォーム起動: 保存済みインデックスから全件が並ぶまで
+   • 差分更新: 1% のファイルを追加して refreshLibrary() が反映するまで
+   • スクロール: 1フレーム = ビューポート移動 + 全体描画、の所要時間
+   • 検索: トライグラム索引単体の問い合わせ時間と、一覧への反映を含む時間
+   • メモリ: 一覧を作る前後の RSS と、生成された行コンポーネントの数
+ を出力する。解析スレッドはアプリと同じく裏で動かしたまま計測する。
+ ==============================================================================
+ */
+#include "Benchmarks.h"
+#include "BenchUtils.h"
+#include "AudioEngine.h"
+#include "SampleListComponent.h"
+#include "LibrarySearchIndex.h"
+
+namespace
+{
+    constexpr int defaultSizes[] = { 1000, 10000, 100000 };
+    constexpr int listWidth = 400;
+    constexpr int listHeight = 700;
+    constexpr int numScrollFrames = 600;
+    constexpr int timeoutMs = 10 * 60 * 1000;
+
+    // 入力途中・タイプミス・複数語・タグを混ぜた問い合わせ
+    const char* const searchQueries[] = { "t", "ta", "take", "tkae", "take 0042", "00123", "short", "long low", "zzzz" };
+
+    juce::String fixtureName (int index)
+    {
+        return "take_" + juce::String (index).paddedLeft ('0', 6) + ".wav";
+    }
+
+    // 256 サンプルのモノラル WAV を1つだけメモリ上で作り、全ファイルに使い回す
+    juce::MemoryBlock makeFixtureWav()
+    {
+        juce::MemoryBlock block;
+        juce::AudioBuffer<float> buffer (1, 256);
+        juce::Random random (42);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample (0, i, random.nextFloat() * 0.5f - 0.25f);
+
+        juce::WavAudioFormat wavFormat;
+        std::unique_ptr<juce::AudioFormatWriter> writer (
+            wavFormat.createWriterFor (new juce::MemoryOutputStream (block, false), 44100.0, 1, 16, {}, 0));
+
+        if (writer != nullptr)
+            writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+
+        return block;
+    }
+
+    bool writeFixtures (const juce::File& folder, int firstIndex, int count, const juce::MemoryBlock& wav)
+    {
+        for (int i = firstIndex; i < firstIndex + count; ++i)
+            if (! folder.getChildFile (fixtureName (i)).replaceWithData (wav.getData(), wav.getSize()))
+                return false;
+
+        return true;
+    }
+
+    // ListBox は private メンバーなので子コンポーネントから探す
+    juce::ListBox* findListBox (juce::Component& parent)
+    {
+        for (auto* child : parent.getChildren())
+            if (auto* box = dynamic_cast<juce::ListBox*> (child))
+                return box;
+
+        return nullptr;
+    }
+
+    int countRowComponents (juce::Component& parent)
+    {
+        int count = dynamic_cast<SampleRowComponent*> (&parent) != nullptr ? 1 : 0;
+        for (auto* child : parent.getChildren())
+            count += countRowComponents (*child);
+        return count;
+    }
+
+    std::vector<int> parseSizes (const juce::StringArray& args)
+    {
+        const int index = args.indexOf ("--sizes");
+        if (index < 0 || index + 1 >= args.size())
+            return { std::begin (defaultSizes), std::end (defaultSizes) };
+
+        std::vector<int> sizes;
+        for (const auto& token : juce::StringArray::fromTokens (args[index + 1], ",", {}))
+            if (token.getIntValue() > 0)
+                sizes.push_back (token.getIntValue());
+        return sizes;
+    }
+
+    bool runOneSize (int numFiles, const juce::MemoryBlock& wav, bool keepFixtures)
+    {
+        const auto root = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                              .getChildFile ("ScratchMyVoiceBench_" + juce::String (numFiles));
+        const auto libraryFolder = root.getChildFile ("Library");
+
+        root.deleteRecursively();
+        if (! libraryFolder.createDirectory())
+            return false;
+
+        std::cout << "-- " << numFiles << " files" << std::endl;
+
+        {
+            bench::Stopwatch sw;
+            if (! writeFixtures (libraryFolder, 0, numFiles, wav))
+            {
+                std::cerr << "failed to write fixtures in " << libraryFolder.getFullPathName() << std::endl;
+                return false;
+            }
+            std::cout << "  fixtures:        " << juce::String (sw.elapsedMs(), 0) << " ms" << std::endl;
+        }
+
+        AudioEngine engine;
+        bool ok = true;
+
+        // ── コールド更新（インデックス無し → スキャナが全件を発見）───────────
+        {
+            bench::Stopwatch sw;
+            SampleListComponent list (engine, libraryFolder);
+            list.setSize (listWidth, listHeight);
+            ok = bench::pumpUntil ([&] { return list.getNumRows() == numFiles; }, timeoutMs);
+            std::cout << "  cold refresh:    " << juce::String (sw.elapsedMs(), 1) << " ms" << std::endl;
+        } // 破棄時にインデックスを保存
+
+        if (! ok)
+            return false;
+
+        // ── ウォーム起動 + 差分更新 + スクロール ─────────────────────────────
+        const auto rssBefore = bench::getResidentBytes();
+        bench::Stopwatch warm;
+        auto list = std::make_unique<SampleListComponent> (engine, libraryFolder);
+        list->setSize (listWidth, listHeight);
+        ok = bench::pumpUntil ([&] { return list->getNumRows() == numFiles; }, timeoutMs);
+        std::cout << "  warm load:       " << juce::String (warm.elapsedMs(), 1) << " ms" << std::endl;
+
+        const auto rssAfter = bench::getResidentBytes();
+        std::cout << "  rss:             " << bench::formatMB (rssBefore) << " -> " << bench::formatMB (rssAfter)
+                  << " (" << juce::String ((double) (rssAfter - rssBefore) / numFiles, 0) << " B/entry)" << std::endl;
+
+        const int numAdded = juce::jmax (1, numFiles / 100);
+        if (ok && writeFixtures (libraryFolder, numFiles, numAdded, wav))
+        {
+            bench::Stopwatch sw;
+            list->refreshLibrary();
+            ok = bench::pumpUntil ([&] { return list->getNumRows() == numFiles + numAdded; }, timeoutMs);
+            std::cout << "  delta refresh:   " << juce::String (sw.elapsedMs(), 1) << " ms (+" << numAdded << " files)" << std::endl;
+        }
+
+        auto* listBox = findListBox (*list);
+        if (ok && listBox != nullptr)
+        {
+            juce::Image frame (juce::Image::ARGB, listWidth, listHeight, true);
+            auto* viewport = listBox->getViewport();
+            const int maxY = juce::jmax (0, viewport->getViewedComponent()->getHeight() - viewport->getViewHeight());
+
+            // 前半: 3行ずつの連続スクロール、後半: スクロールバーのドラッグ相当のジャンプ
+            std::vector<double> frameMs;
+            frameMs.reserve (numScrollFrames);
+            juce::Random random (7);
+
+            for (int i = 0; i < numScrollFrames; ++i)
+            {
+                const int y = i < numScrollFrames / 2 ? juce::jmin (maxY, i * listBox->getRowHeight() * 3)
+                                                      : random.nextInt (maxY + 1);
+                bench::Stopwatch sw;
+                viewport->setViewPosition (0, y);
+                {
+                    juce::Graphics g (frame);
+                    list->paintEntireComponent (g, true);
+                }
+                frameMs.push_back (sw.elapsedMs());
+            }
+
+            std::cout << "  scroll frame:    " << bench::formatMs (bench::summarise (std::move (frameMs))) << std::endl;
+            std::cout << "  row components:  " << countRowComponents (*listBox) << std::endl;
+        }
+
+        // ── 検索 ─────────────────────────────────────────────────────────────
+        if (ok)
+        {
+            // 索引単体（ファイル名 + 解析タグ相当のエントリを直接登録）
+            LibrarySearchIndex index;
+            juce::Random random (3);
+            for (int i = 0; i < numFiles; ++i)
+            {
+                LibraryEntry entry;
+                entry.file = libraryFolder.getChildFile (fixtureName (i));
+                entry.analysed = true;
+                entry.durationSeconds = random.nextDouble() * 4.0;
+                entry.medianPitchHz = 80.0f + random.nextFloat() * 200.0f;
+                index.update ((LibraryIndex::EntryId) i, entry);
+            }
+
+            std::vector<double> indexMs, listMs;
+            size_t totalMatches = 0;
+
+            for (int round = 0; round < 20; ++round)
+            {
+                for (auto* query : searchQueries)
+                {
+                    bench::Stopwatch sw;
+                    totalMatches += index.search (query).size();
+                    indexMs.push_back (sw.elapsedMs());
+
+                    bench::Stopwatch swList;
+                    list->setSearchQuery (query);
+                    listMs.push_back (swList.elapsedMs());
+                }
+            }
+
+            list->setSearchQuery ({});
+            std::cout << "  search (index):  " << bench::formatMs (bench::summarise (std::move (indexMs)))
+                      << " (" << (totalMatches / 20) << " matches/round)" << std::endl;
+            std::cout << "  search (list):   " << bench::formatMs (bench::summarise (std::move (listMs))) << std::endl;
+        }
+
+        list.reset();
+
+        if (! keepFixtures)
+            root.deleteRecursively();
+
+        return ok;
+    }
+}
+
+bool runLibraryListBenchmark (const juce::StringArray& args)
+{
+    const auto wav = makeFixtureWav();
+    const bool keepFixtures = args.contains ("--keep-fixtures");
+    bool ok = true;
+
+    for (int numFiles : parseSizes (args))
+    {
+        if (! runOneSize (numFiles, wav, keepFixtures))
+        {
+            std::cerr << "  FAILED (" << numFiles << " files)" << std::endl;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
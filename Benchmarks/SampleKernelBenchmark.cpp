@@ -0,0 +1,180 @@
+/*
+ ==============================================================================
+ SampleKernelBenchmark.cpp
+ ==============================================================================
+ デッキの再生カーネル (SampleRenderKernel) のスループット計測。
+
+ 同じ内容のサンプルを float32 と int16（コンパクト形式）で用意し、
+ いくつかのスクラッチ速度で 512 サンプルずつ描画して
+   • 従来のループ（AudioBuffer::getSample で 1 サンプルずつ補間）
+   • カーネル + float32
+   • カーネル + int16（読む範囲を SIMD で float へ変換しながら補間）
+ の出力スループット（Msamples/s、ステレオ 1 フレーム = 1 サンプル）を比べる。
+ サンプルのメモリ量と、int16 による誤差の最大値も出力する。
+ ==============================================================================
+ */
+#include "Benchmarks.h"
+#include "BenchUtils.h"
+#include "SampleRenderKernel.h"
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int defaultSeconds = 30;
+    constexpr int blockSize = 512;
+    constexpr int blocksPerTrial = 1000;
+    constexpr int numTrials = 15;
+
+    // 通常再生・逆回転・ゆっくり・速いスクラッチ
+    const double speeds[] = { 1.0, -1.0, 0.37, 2.5, -8.0 };
+
+    int parseSeconds (const juce::StringArray& args)
+    {
+        const int index = args.indexOf ("--seconds");
+        if (index < 0 || index + 1 >= args.size())
+            return defaultSeconds;
+
+        return juce::jmax (1, args[index + 1].getIntValue());
+    }
+
+    // 声っぽい帯域の和音 + 少しのノイズ（全部ゼロだと分岐予測やキャッシュが有利になりすぎる）
+    juce::AudioBuffer<float> makeSource (int numSamples)
+    {
+        juce::AudioBuffer<float> buffer (2, numSamples);
+        juce::Random random (7);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            auto* data = buffer.getWritePointer (ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double t = (double) i / sampleRate;
+                data[i] = (float) (0.3 * std::sin (juce::MathConstants<double>::twoPi * (220.0 + 3.0 * ch) * t)
+                                 + 0.2 * std::sin (juce::MathConstants<double>::twoPi * 330.0 * t))
+                        + (random.nextFloat() - 0.5f) * 0.05f;
+            }
+        }
+
+        return buffer;
+    }
+
+    // 変更前の renderDeck と同じ 1 サンプルずつのループ（比較の基準）
+    void renderLegacy (const juce::AudioBuffer<float>& source, int length, double& position, double speed,
+                       juce::AudioBuffer<float>& out)
+    {
+        for (int sample = 0; sample < out.getNumSamples(); ++sample)
+        {
+            int pos0 = static_cast<int> (position);
+            int pos1 = pos0 + 1;
+            const float frac = static_cast<float> (position - pos0);
+
+            pos0 = juce::jlimit (0, length - 1, pos0);
+            pos1 = juce::jlimit (0, length - 1, pos1);
+
+            for (int ch = 0; ch < out.getNumChannels(); ++ch)
+            {
+                const float s0 = source.getSample (ch, pos0);
+                const float s1 = source.getSample (ch, pos1);
+                out.setSample (ch, sample, s0 + frac * (s1 - s0));
+            }
+
+            position += speed;
+            if (position >= length)
+                position = 0.0;
+            else if (position < 0.0)
+                position = length - 1;
+        }
+    }
+
+    // 1 試行 = blocksPerTrial ブロック。試行ごとの Msamples/s の中央値を返す
+    template <typename RenderBlock>
+    double measureThroughput (RenderBlock&& renderBlock)
+    {
+        std::vector<double> rates;
+
+        for (int trial = 0; trial < numTrials; ++trial)
+        {
+            bench::Stopwatch sw;
+            for (int block = 0; block < blocksPerTrial; ++block)
+                renderBlock();
+
+            const double seconds = sw.elapsedMs() / 1000.0;
+            rates.push_back ((double) blocksPerTrial * blockSize / seconds / 1.0e6);
+        }
+
+        return bench::summarise (std::move (rates)).median;
+    }
+
+    float maxDifference (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        float diff = 0.0f;
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                diff = juce::jmax (diff, std::abs (a.getSample (ch, i) - b.getSample (ch, i)));
+        return diff;
+    }
+}
+
+bool runSampleKernelBenchmark (const juce::StringArray& args)
+{
+    const int numSamples = (int) (parseSeconds (args) * sampleRate);
+    auto source = makeSource (numSamples);
+
+    auto floatSample = DecodedSample::fromBuffer (juce::AudioBuffer<float> (source), sampleRate, DecodedSample::Format::float32);
+    auto int16Sample = DecodedSample::fromBuffer (juce::AudioBuffer<float> (source), sampleRate, DecodedSample::Format::int16);
+
+    std::cout << "  sample:          " << numSamples << " frames x 2 ch" << std::endl;
+    std::cout << "  memory float32:  " << bench::formatMB ((juce::int64) floatSample->getResidentBytes()) << std::endl;
+    std::cout << "  memory int16:    " << bench::formatMB ((juce::int64) int16Sample->getResidentBytes()) << std::endl;
+
+    auto kernel = std::make_unique<SampleRenderKernel>(); // スクラッチが大きいのでヒープへ
+    juce::AudioBuffer<float> out (2, blockSize), reference (2, blockSize);
+    bool ok = true;
+
+    for (const double speed : speeds)
+    {
+        // 出力の一致確認（float32 は従来のループと丸め誤差の範囲で一致、int16 は量子化誤差のみ）
+        // カーネルは整数部 + 端数の再生位置なので、double で足していく従来のループとは最下位ビットが揺れる
+        {
+            double p0 = numSamples * 0.5;
+            auto p1 = Playhead::fromPosition (p0), p2 = p1;
+            renderLegacy (source, numSamples, p0, speed, reference);
+
+            kernel->render (*floatSample, numSamples, p1, speed, out.getArrayOfWritePointers(), 2, blockSize);
+            const float floatError = maxDifference (reference, out);
+
+            kernel->render (*int16Sample, numSamples, p2, speed, out.getArrayOfWritePointers(), 2, blockSize);
+            const float int16Error = maxDifference (reference, out);
+
+            if (floatError > 1.0e-6f || int16Error > 2.0f / 32768.0f
+                || std::abs (p0 - p1.toPosition()) > 1.0e-6 || std::abs (p0 - p2.toPosition()) > 1.0e-6)
+            {
+                std::cerr << "  MISMATCH at speed " << speed << ": float " << floatError << ", int16 " << int16Error << std::endl;
+                ok = false;
+            }
+        }
+
+        double legacyPosition = 0.0;
+        const double legacy = measureThroughput ([&] { renderLegacy (source, numSamples, legacyPosition, speed, out); });
+
+        Playhead position;
+        const double kernelFloat = measureThroughput ([&]
+        {
+            kernel->render (*floatSample, numSamples, position, speed, out.getArrayOfWritePointers(), 2, blockSize);
+        });
+
+        position = {};
+        const double kernelInt16 = measureThroughput ([&]
+        {
+            kernel->render (*int16Sample, numSamples, position, speed, out.getArrayOfWritePointers(), 2, blockSize);
+        });
+
+        std::cout << "  speed " << juce::String (speed, 2).paddedLeft (' ', 6) << ":   "
+                  << "legacy " << juce::String (legacy, 1) << ", "
+                  << "float32 " << juce::String (kernelFloat, 1) << ", "
+                  << "int16 " << juce::String (kernelInt16, 1) << " Msamples/s"
+                  << " (int16/float32 x" << juce::String (kernelInt16 / kernelFloat, 2) << ")" << std::endl;
+    }
+
+    return ok;
+}
@@ -0,0 +1,347 @@
+/*
+ ==============================================================================
+ UiRenderBenchmark.cpp
+ ==============================================================================
+ デッキまわりのコンポーネントの描画コスト（ヘッドレス）。
+
+ ウィンドウを開かずに、各コンポーネントをソフトウェアレンダラーの Image へ
+ paintEntireComponent で描き、1 フレームの時間を集計する。画面サイズ
+ （既定 1280x800 / 1920x1080 / 3840x2160）ごとに、アプリのレイアウトに近い大きさで
+   • Turntable:  止まっている / 回っている（フレームごとに FrameScheduler を進める）
+                 それぞれレイヤーキャッシュ無し（キャッシュ導入前の paint と同じ描画）と有り
+   • Waveform:   空 / 30 秒のテイク全体（ステレオのレーン縦並び・重ね）/ 最大ズーム / 最大ズームでスクロール /
+                 再生中（全体を描く場合と、再生位置の前後の帯だけを描く場合）
+   • Crossfader: 静止
+   • Level meter: 入出力に声のような信号が流れ続ける（フレームごとに FIFO を読んで FFT・描画）
+ を測る。最初の 1 フレームはレイヤー・タイルのキャッシュを作るので別に出し、
+ 残りを中央値 / p95 / 最大で出す。テイクは録音経路（recordAudioBlock）で流し込み、
+ 帯域の解析が終わってから測る（定常状態）。
+
+   ScratchMyVoiceBench ui [--sizes 1920x1080,3840x2160] [--frames 240]
+ ==============================================================================
+ */
+#include "Benchmarks.h"
+#include "BenchUtils.h"
+#include "AudioEngine.h"
+#include "FrameScheduler.h"
+#include "TurntableComponent.h"
+#include "WaveformComponent.h"
+#include "CrossfaderComponent.h"
+#include "LevelMeterComponent.h"
+
+namespace
+{
+    constexpr double sampleRate = 44100.0;
+    constexpr int blockSize = 512;      // 録音で流し込むブロック
+    constexpr int maxBlockSize = 1024;  // 再生は 1 フレームぶん（60fps で 735 サンプル）を 1 回で
+    constexpr double takeSeconds = 30.0;
+    constexpr double frameIntervalMs = 1000.0 / 60.0;
+    constexpr int defaultFrames = 240;
+    constexpr int analysisTimeoutMs = 60 * 1000;
+    const char* const defaultSizes = "1280x800,1920x1080,3840x2160";
+
+    double frameClockMs = 0.0; // FrameScheduler に渡す時刻（フィクスチャをまたいで進め続ける）
+
+    struct DisplaySize
+    {
+        int width = 0, height = 0;
+    };
+
+    std::vector<DisplaySize> parseSizes (const juce::StringArray& args)
+    {
+        const int index = args.indexOf ("--sizes");
+        const auto list = index >= 0 && index + 1 < args.size() ? args[index + 1] : juce::String (defaultSizes);
+
+        std::vector<DisplaySize> sizes;
+        for (const auto& token : juce::StringArray::fromTokens (list, ",", {}))
+        {
+            const DisplaySize size { token.upToFirstOccurrenceOf ("x", false, true).getIntValue(),
+                                     token.fromFirstOccurrenceOf ("x", false, true).getIntValue() };
+            if (size.width > 0 && size.height > 0)
+                sizes.push_back (size);
+        }
+        return sizes;
+    }
+
+    int parseFrames (const juce::StringArray& args)
+    {
+        const int index = args.indexOf ("--frames");
+        if (index < 0 || index + 1 >= args.size())
+            return defaultFrames;
+
+        return juce::jmax (2, args[index + 1].getIntValue());
+    }
+
+    // 4 Hz の音節の包絡の母音 + 音節の頭の子音（ノイズ）。帯域の色が全部出るように
+    void fillVoiceLikeBlock (juce::AudioBuffer<float>& block, juce::int64 startSample, juce::Random& random)
+    {
+        for (int i = 0; i < block.getNumSamples(); ++i)
+        {
+            const double t = (double) (startSample + i) / sampleRate;
+            const double syllable = std::fmod (t * 4.0, 1.0);
+            const double envelope = std::sin (juce::MathConstants<double>::pi * syllable);
+            const float vowel = (float) (envelope * (0.4 * std::sin (juce::MathConstants<double>::twoPi * 180.0 * t)
+                                                   + 0.2 * std::sin (juce::MathConstants<double>::twoPi * 900.0 * t)));
+            const float consonant = syllable < 0.08 ? (random.nextFloat() - 0.5f) * 0.6f : 0.0f;
+
+            for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                block.setSample (ch, i, vowel + consonant);
+        }
+    }
+
+    // アプリと同じ録音経路でテイクを作り、ピーク・帯域の解析が揃うまで待つ
+    bool recordTake (AudioEngine& engine)
+    {
+        engine.prepareToPlay (maxBlockSize, sampleRate);
+        engine.startRecording();
+
+        juce::AudioBuffer<float> block (2, blockSize);
+        juce::Random random (11);
+        const auto total = (juce::int64) (takeSeconds * sampleRate);
+
+        for (juce::int64 pos = 0; pos < total && engine.isRecording(); pos += blockSize)
+        {
+            fillVoiceLikeBlock (block, pos, random);
+            engine.recordAudioBlock (juce::AudioSourceChannelInfo (&block, 0, blockSize));
+        }
+
+        if (engine.isRecording())
+            engine.stopRecording();
+
+        // 帯域の解析は窓の後ろ半分が揃わない末尾を残すので、FFT 1 つぶん手前まで
+        auto& peaks = engine.getWaveformPeaks();
+        return bench::pumpUntil ([&peaks]
+        {
+            return peaks.getNumBandSamplesFinished() >= peaks.getNumSamplesFinished() - (1 << WaveformPeaks::bandFftOrder);
+        }, analysisTimeoutMs);
+    }
+
+    struct Fixture
+    {
+        juce::String name;
+        std::function<void (int frame)> advance;                 // 計測の外で状態を進める（省略可）
+        std::function<juce::RectangleList<int> (int frame)> clip; // このフレームで描き直す範囲（省略 = 全体）
+    };
+
+    // numFrames 回描いて、最初の 1 回と残りの集計を出す
+    void measure (const juce::String& label, juce::Component& component, FrameScheduler& scheduler,
+                  const Fixture& fixture, int numFrames)
+    {
+        juce::Image frame (juce::Image::ARGB, component.getWidth(), component.getHeight(), true, juce::SoftwareImageType());
+        std::vector<double> frameMs;
+        frameMs.reserve ((size_t) numFrames);
+        double firstMs = 0.0;
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            if (fixture.advance)
+                fixture.advance (i);
+
+            frameClockMs += frameIntervalMs;
+            scheduler.tick (frameClockMs);
+
+            bench::Stopwatch sw;
+            {
+                juce::Graphics g (frame);
+                if (fixture.clip && i > 0)
+                    g.reduceClipRegion (fixture.clip (i));
+
+                component.paintEntireComponent (g, true);
+            }
+
+            if (i == 0)
+                firstMs = sw.elapsedMs();
+            else
+                frameMs.push_back (sw.elapsedMs());
+        }
+
+        std::cout << "  " << label.paddedRight (' ', 22) << fixture.name.paddedRight (' ', 22)
+                  << "first " << juce::String (firstMs, 2) << " ms | "
+                  << bench::formatMs (bench::summarise (std::move (frameMs))) << std::endl;
+    }
+
+    juce::String sizeLabel (const juce::String& name, const juce::Component& c)
+    {
+        return name + " " + juce::String (c.getWidth()) + "x" + juce::String (c.getHeight());
+    }
+
+    // デスクトップのレイアウトに近い大きさ（盤は正方形、波形は横長の帯）
+    juce::Rectangle<int> turntableBounds (DisplaySize d)
+    {
+        const int side = juce::roundToInt ((float) juce::jmin (d.width, d.height) * 0.6f);
+        return { side, side };
+    }
+
+    juce::Rectangle<int> waveformBounds (DisplaySize d)
+    {
+        return { juce::roundToInt ((float) d.width * 0.9f), juce::roundToInt ((float) d.height * 0.15f) };
+    }
+
+    juce::Rectangle<int> crossfaderBounds (DisplaySize d)
+    {
+        return { juce::roundToInt ((float) d.width * 0.5f), juce::roundToInt ((float) d.height * 0.1f) };
+    }
+
+    // ヘッダーのボタンの間
+    juce::Rectangle<int> levelMeterBounds (DisplaySize d)
+    {
+        return { juce::roundToInt ((float) d.width * 0.6f), juce::jmax (40, d.height / 15) };
+    }
+
+    void runOneSize (DisplaySize display, AudioEngine& emptyEngine, AudioEngine& takeEngine, int numFrames)
+    {
+        std::cout << "-- " << display.width << "x" << display.height << std::endl;
+
+        juce::Component host; // FrameScheduler の VBlank 用（ヘッドレスでは刻まないので tick で進める）
+        FrameScheduler scheduler (host);
+
+        // ── Turntable ───────────────────────────────────────────────────────
+        for (const bool spinning : { false, true })
+        {
+            if (spinning)
+                takeEngine.play();
+
+            // 前（毎フレーム全部を描く）→ 後（キャッシュした層を貼るだけ）の順で
+            for (const bool cached : { false, true })
+            {
+                TurntableComponent turntable (takeEngine, scheduler);
+                turntable.setBounds (turntableBounds (display));
+                turntable.setLayerCacheEnabled (cached);
+
+                const juce::String state = cached ? (spinning ? "spinning platter" : "idle")
+                                                  : (spinning ? "spinning (no cache)" : "idle (no cache)");
+                measure (sizeLabel ("turntable", turntable), turntable, scheduler, { state }, numFrames);
+            }
+
+            takeEngine.stop();
+        }
+
+        // ── Waveform ────────────────────────────────────────────────────────
+        {
+            WaveformComponent waveform (emptyEngine, scheduler);
+            waveform.setBounds (waveformBounds (display));
+            measure (sizeLabel ("waveform", waveform), waveform, scheduler, { "empty" }, numFrames);
+        }
+
+        {
+            WaveformComponent waveform (takeEngine, scheduler);
+            waveform.setBounds (waveformBounds (display));
+            measure (sizeLabel ("waveform", waveform), waveform, scheduler, { "30 s take" }, numFrames);
+
+            waveform.setChannelLayout (WaveformTileCache::ChannelLayout::overlaid);
+            measure (sizeLabel ("waveform", waveform), waveform, scheduler, { "30 s take overlaid" }, numFrames);
+            waveform.setChannelLayout (WaveformTileCache::ChannelLayout::stacked);
+
+            waveform.setView (1.0e9, 0.5); // 最大倍率（1 サンプル = 数ピクセル）
+            measure (sizeLabel ("waveform", waveform), waveform, scheduler, { "deep zoom" }, numFrames);
+
+            // 1 フレームで 1/4 画面ずつ進む → 毎フレーム新しいタイルを描く
+            Fixture scrolling { "deep zoom scroll" };
+            scrolling.advance = [&waveform, &takeEngine] (int frame)
+            {
+                const double visible = waveform.getWidth() / 8.0 / (double) takeEngine.getRecordedSamplesCount();
+                waveform.setView (1.0e9, 0.25 + (double) frame * visible * 0.25);
+            };
+            measure (sizeLabel ("waveform", waveform), waveform, scheduler, scrolling, numFrames);
+        }
+
+        {
+            // 再生: 1 フレームぶんのオーディオを回して再生位置を進める
+            WaveformComponent waveform (takeEngine, scheduler);
+            waveform.setBounds (waveformBounds (display));
+
+            juce::AudioBuffer<float> output (2, juce::roundToInt (sampleRate * frameIntervalMs * 0.001));
+            double lastPosition = 0.0;
+            auto advancePlayback = [&] (int)
+            {
+                lastPosition = takeEngine.getPlaybackPosition();
+                output.clear();
+                takeEngine.getNextAudioBlock (juce::AudioSourceChannelInfo (&output, 0, output.getNumSamples()));
+            };
+
+            // ズーム 1 倍なので再生位置の x = 位置 * 幅。前の線と今の線の帯（WaveformComponent と同じ幅）
+            auto playheadStrips = [&] (int)
+            {
+                juce::RectangleList<int> strips;
+                for (const double position : { lastPosition, takeEngine.getPlaybackPosition() })
+                {
+                    const float x = (float) position * (float) waveform.getWidth();
+                    strips.add (juce::Rectangle<float> (x - 2.0f, 0.0f, 4.0f, (float) waveform.getHeight()).getSmallestIntegerContainer());
+                }
+                return strips;
+            };
+
+            for (const bool stripsOnly : { false, true })
+            {
+                Fixture playing { stripsOnly ? "playing (strips)" : "playing (full)", advancePlayback };
+                if (stripsOnly)
+                    playing.clip = playheadStrips;
+
+                takeEngine.setPlaybackPosition (0.0);
+                takeEngine.play();
+                measure (sizeLabel ("waveform", waveform), waveform, scheduler, playing, numFrames);
+                takeEngine.stop();
+            }
+        }
+
+        // ── Crossfader ──────────────────────────────────────────────────────
+        {
+            CrossfaderComponent crossfader (takeEngine);
+            crossfader.setBounds (crossfaderBounds (display));
+            measure (sizeLabel ("crossfader", crossfader), crossfader, scheduler, { "static" }, numFrames);
+        }
+
+        // ── Level meter ─────────────────────────────────────────────────────
+        {
+            // 1 フレームぶんの信号を入力・出力のメーターへ（オーディオスレッドの代わり）
+            LevelMeterComponent levelMeter (takeEngine, scheduler);
+            levelMeter.setBounds (levelMeterBounds (display));
+
+            juce::AudioBuffer<float> block (2, juce::roundToInt (sampleRate * frameIntervalMs * 0.001));
+            juce::Random random (5);
+            juce::int64 position = 0;
+
+            Fixture live { "live signal" };
+            live.advance = [&] (int)
+            {
+                fillVoiceLikeBlock (block, position, random);
+                position += block.getNumSamples();
+
+                const juce::AudioSourceChannelInfo info (&block, 0, block.getNumSamples());
+                takeEngine.getInputMeter().push (info);
+                takeEngine.getOutputMeter().push (info);
+            };
+            measure (sizeLabel ("level meter", levelMeter), levelMeter, scheduler, live, numFrames);
+        }
+    }
+}
+
+bool runUiRenderBenchmark (const juce::StringArray& args)
+{
+    const int numFrames = parseFrames (args);
+    const auto sizes = parseSizes (args);
+    if (sizes.empty())
+    {
+        std::cerr << "  no valid --sizes (use e.g. 1920x1080,3840x2160)" << std::endl;
+        return false;
+    }
+
+    AudioEngine emptyEngine, takeEngine;
+
+    {
+        bench::Stopwatch sw;
+        if (! recordTake (takeEngine))
+        {
+            std::cerr << "  FAILED: band analysis of the take did not finish" << std::endl;
+            return false;
+        }
+        std::cout << "  take + analysis: " << juce::String (sw.elapsedMs(), 0) << " ms ("
+                  << takeEngine.getRecordedSamplesCount() << " samples)" << std::endl;
+    }
+
+    for (const auto& display : sizes)
+        runOneSize (display, emptyEngine, takeEngine, numFrames);
+
+    takeEngine.releaseResources();
+    return true;
+}
@@ -5,93 +5,195 @@
  */
 #include "AudioEngine.h"
 
+namespace
+{
+	// settings.xml のキー
+	constexpr const char* libraryCodecKey = "libraryCodec";
+	constexpr const char* sampleMemoryBudgetKey = "sampleMemoryBudgetMB";
+	constexpr const char* compactSampleStorageKey = "compactSampleStorage";
+
+	// 保存する名前は拡張子（"wav" / "flac" / "ogg"）
+	juce::String getCodecName(LibraryEncoder::Codec codec)
+	{
+		return LibraryEncoder::getFileExtension(codec).substring(1);
+	}
+}
+
 AudioEngine::AudioEngine()
-: fileThumbnail(512, formatManager, thumbnailCache),
-  recordedThumbnail(512, formatManager, recordedThumbCache)
+: decodedCache(getLibraryFolder().getSiblingFile("DecodedCache"))
 {
 	formatManager.registerBasicFormats();
+	segmenter.addChangeListener(this);
+	sampleCache.addChangeListener(this); // スロットのバックグラウンドロード完了
+	libraryEncoder.addChangeListener(this); // 録音の圧縮完了
+
+	// 保存した設定を戻す（無ければ既定の WAV のまま。元の録音を変換しない）
+	const auto storedCodec = settings.getValue(libraryCodecKey);
+	for (auto codec : { LibraryEncoder::Codec::wav, LibraryEncoder::Codec::flac, LibraryEncoder::Codec::oggVorbis })
+		if (storedCodec == getCodecName(codec))
+			libraryEncoder.setCodec(codec);
+
+	const int storedBudgetMB = settings.getIntValue(sampleMemoryBudgetKey);
+	if (storedBudgetMB > 0)
+		sampleCache.setMemoryBudget(static_cast<size_t>(storedBudgetMB) * 1024 * 1024);
+
+	if (settings.getBoolValue(compactSampleStorageKey, false))
+		sampleCache.setStorageFormat(DecodedSample::Format::int16);
+	transportSource.addChangeListener(this); // プレビュー終了の検知
+	previewReadAheadThread.startThread(juce::Thread::Priority::high);
 
 	// 録音バッファを初期化（最大30秒分）
 	recordedBuffer.setSize(2, 44100 * 30);
 	recordedBuffer.clear();
+
+	// 波形の帯域（低 / 中 / 高）の色分けは裏で解析
+	waveformPeaks.startBandAnalysis([this](int channel, juce::int64 start, int num, float* dest)
+	{
+		return readDeckSamples(channel, start, num, dest);
+	});
 }
 
 AudioEngine::~AudioEngine()
 {
+    cancelPendingUpdate();
+    waveformPeaks.stopBandAnalysis(); // readDeckSamples が触るメンバより先に
+    segmenter.removeChangeListener(this);
+    sampleCache.removeChangeListener(this);
+    libraryEncoder.removeChangeListener(this);
+    transportSource.removeChangeListener(this);
     transportSource.setSource(nullptr);
+    readerSource.reset();
+    previewReadAheadThread.stopThread(2000);
 }
 
 void AudioEngine::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 {
+    const bool rateChanged = sampleRate != currentSampleRate;
     currentSampleRate = sampleRate;
     transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    previewMixBuffer.setSize(2, samplesPerBlockExpected);
+    deckMixBuffer.setSize(2, samplesPerBlockExpected);
+    previewGain.reset(sampleRate, 0.01);
+
+    // 録音バッファは 30 秒分。中身は録音したときのレートのまま（再生時に比率で補正する）ので、
+    // テイクを持っている間は録音時のレートでも 30 秒分を残し、デバイスのレートが下がっても切り詰めない
+    if (recordWritePosition == 0)
+        recordedSampleRate = sampleRate;
 
-    // 録音バッファのサイズを現在のサンプルレートに合わせる（30秒分）
+    const bool holdsTake = recordWritePosition > 0 && deckSample == nullptr;
     int maxSamples = static_cast<int>(sampleRate * 30.0);
-    recordedBuffer.setSize(2, maxSamples, true, true, true);
+    if (holdsTake)
+        maxSamples = juce::jmax(maxSamples, static_cast<int>(recordedSampleRate * 30.0), static_cast<int>(recordWritePosition));
+
+    if (recordedBuffer.getNumSamples() != maxSamples)
+    {
+        // 確保と古いバッファの解放はロックの外で。ロック中はテイクを移して差し替えるだけ
+        juce::AudioBuffer<float> resized(recordedBuffer.getNumChannels(), maxSamples);
+        resized.clear();
+
+        {
+            const juce::ScopedLock bufferLock(recordedBufferLock);
+            juce::SpinLock::ScopedLockType lock(recordLock);
+            if (holdsTake)
+                for (int ch = 0; ch < resized.getNumChannels(); ++ch)
+                    resized.copyFrom(ch, 0, recordedBuffer, ch, 0, static_cast<int>(recordWritePosition));
+            std::swap(recordedBuffer, resized);
+        }
+    }
 
     crossfaderGain.reset(sampleRate, 0.01); // 10msスムージング
+    inputMeter.prepare(sampleRate);
+    outputMeter.prepare(sampleRate);
 
-    if (resamplerSource)
-        resamplerSource->prepareToPlay(samplesPerBlockExpected, sampleRate);
+    // 変換済みサンプルの作り直しはメッセージスレッドで
+    if (rateChanged)
+        triggerAsyncUpdate();
 }
 
 void AudioEngine::releaseResources()
 {
     transportSource.releaseResources();
-    if (resamplerSource)
-        resamplerSource->releaseResources();
 }
 
 void AudioEngine::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    renderDeck(bufferToFill);
+    mixPreview(bufferToFill);
+    outputMeter.push(bufferToFill); // 出力に足し終わった後
+}
+
+void AudioEngine::mixPreview(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    // プレビューはクロスフェーダーを通さずそのまま出力へ足す（試聴用）
+    if (! transportSource.isPlaying() || previewMixBuffer.getNumSamples() == 0)
+    {
+        previewGain.skip(bufferToFill.numSamples);
+        return;
+    }
+
+    auto* outputBuffer = bufferToFill.buffer;
+    const int numChannels = juce::jmin(outputBuffer->getNumChannels(), previewMixBuffer.getNumChannels());
+
+    // ホストのブロックが想定より大きくても確保せず分割して処理
+    for (int offset = 0; offset < bufferToFill.numSamples;)
+    {
+        const int chunk = juce::jmin(previewMixBuffer.getNumSamples(), bufferToFill.numSamples - offset);
+        juce::AudioSourceChannelInfo info(&previewMixBuffer, 0, chunk);
+        transportSource.getNextAudioBlock(info);
+
+        const float startGain = previewGain.getCurrentValue();
+        const float endGain = previewGain.skip(chunk);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            outputBuffer->addFromWithRamp(ch, bufferToFill.startSample + offset,
+                                          previewMixBuffer.getReadPointer(ch), chunk, startGain, endGain);
+
+        offset += chunk;
+    }
+}
+
+void AudioEngine::renderDeck(const juce::AudioSourceChannelInfo& bufferToFill)
 {
     juce::SpinLock::ScopedLockType lock(recordLock);
 
-    // 再生中は録音バッファからスクラッチ再生
-    if (playing && recordedBuffer.getNumSamples() > 0 && recordWritePosition > 0)
+    // 再生中はデッキ（スロットのサンプル、または録音バッファ）からスクラッチ再生
+    if (playing && recordWritePosition > 0 && deckMixBuffer.getNumSamples() > 0)
     {
         auto* outputBuffer = bufferToFill.buffer;
-        int numSamplesToFill = bufferToFill.numSamples;
-        int numChannels = juce::jmin(outputBuffer->getNumChannels(), recordedBuffer.getNumChannels());
+        const int numChannels = juce::jmin(outputBuffer->getNumChannels(), deckMixBuffer.getNumChannels());
+        auto* const* mix = deckMixBuffer.getArrayOfWritePointers();
+
+        // 中身のレートがデバイスと違う間（作り直し待ち・古いレートの録音）は速度で補正
+        const double deckRate = deckSample != nullptr ? deckSample->getSampleRate() : recordedSampleRate;
+        const double speed = targetScratchSpeed * deckRate / currentSampleRate;
 
-        for (int sample = 0; sample < numSamplesToFill; ++sample)
+        // ホストのブロックが想定より大きくても確保せず分割して処理
+        for (int offset = 0; offset < bufferToFill.numSamples;)
         {
-            // 線形補間のためのインデックスと係数を計算
-            int pos0 = static_cast<int>(playbackPosition);
-            int pos1 = pos0 + 1;
-            float frac = static_cast<float>(playbackPosition - pos0);
+            const int chunk = juce::jmin(deckMixBuffer.getNumSamples(), bufferToFill.numSamples - offset);
 
-            // バッファ範囲内にクランプ
-            pos0 = juce::jlimit(0, recordWritePosition - 1, pos0);
-            pos1 = juce::jlimit(0, recordWritePosition - 1, pos1);
+            // 線形補間でサンプル値を計算（int16 のサンプルは読む範囲だけ float へ変換しながら）
+            if (deckSample != nullptr)
+                deckKernel.render(*deckSample, recordWritePosition, playbackPosition, speed,
+                                  mix, numChannels, chunk);
+            else
+                deckKernel.render(recordedBuffer.getArrayOfReadPointers(), recordedBuffer.getNumChannels(),
+                                  recordWritePosition, playbackPosition, speed, mix, numChannels, chunk);
 
-            float gain = crossfaderGain.getNextValue();
+            const float startGain = crossfaderGain.getCurrentValue();
+            const float endGain = crossfaderGain.skip(chunk);
 
             for (int ch = 0; ch < numChannels; ++ch)
-            {
-                // 線形補間でサンプル値を計算（ノイズ軽減）
-                float sample0 = recordedBuffer.getSample(ch, pos0);
-                float sample1 = recordedBuffer.getSample(ch, pos1);
-                float interpolatedSample = sample0 + frac * (sample1 - sample0);
-
-                outputBuffer->addSample(ch, bufferToFill.startSample + sample, interpolatedSample * gain);
-            }
+                outputBuffer->addFromWithRamp(ch, bufferToFill.startSample + offset,
+                                              deckMixBuffer.getReadPointer(ch), chunk, startGain, endGain);
 
-            // 再生位置を進める（スムーズなスピード変化）
-            playbackPosition += targetScratchSpeed;
-
-            // ループ再生（録音範囲内でループ）
-            if (playbackPosition >= recordWritePosition)
-                playbackPosition = 0.0;
-            else if (playbackPosition < 0.0)
-                playbackPosition = recordWritePosition - 1;
+            offset += chunk;
         }
     }
     else
     {
         // 再生していない場合、クロスフェーダーのスムーズ値を更新
-        for (int i = 0; i < bufferToFill.numSamples; ++i)
-            crossfaderGain.getNextValue();
+        crossfaderGain.skip(bufferToFill.numSamples);
     }
 }
 
@@ -113,17 +215,15 @@ void AudioEngine::recordAudioBlock(const juce::AudioSourceChannelInfo& bufferToF
     {
         for (int ch = 0; ch < numChannels; ++ch)
         {
-            recordedBuffer.copyFrom(ch, recordWritePosition,
+            recordedBuffer.copyFrom(ch, static_cast<int>(recordWritePosition),
                                     *inputBuffer, ch, bufferToFill.startSample, numSamples);
         }
 
-        // ── Feed thumbnail (background thread safe) ──────────────────
-        // AudioThumbnail::addBlock is thread-safe and processes data
-        // asynchronously.  This is the key: we NEVER scan the raw buffer
-        // from the UI thread — the thumbnail pre-computes min/max peaks.
-        int numThumbChannels = juce::jmin(numChannels, 2);
-        recordedThumbnail.addBlock(recordWritePosition, *inputBuffer,
-                                   bufferToFill.startSample, numSamples);
+        // ── Feed waveform peaks (no allocation) ──────────────────────
+        // 容量は録音開始時に確保済み。ブロックの min / max を全段へ足し込むだけで、
+        // UIスレッドは生のバッファを走査しない
+        waveformPeaks.addBlock(recordWritePosition, *inputBuffer,
+                               bufferToFill.startSample, numSamples);
 
         recordWritePosition += numSamples;
     }
@@ -134,26 +234,79 @@ void AudioEngine::recordAudioBlock(const juce::AudioSourceChannelInfo& bufferToF
     }
 }
 
-void AudioEngine::resetRecordedThumbnail()
+void AudioEngine::resetRecordedThumbnail(int numChannels, juce::int64 capacity)
 {
-    // Reset thumbnail source info so it can be reused for a new recording
-    recordedThumbnail.reset(static_cast<int>(currentSampleRate), 2,
-                            juce::AudioThumbnail::maxNumChannels);
+    // 確保はここ（メッセージスレッド）で済ませ、オーディオスレッドは足し込むだけ
+    waveformPeaks.reset(numChannels, capacity, getRecordedSampleRate());
+    ++thumbnailGeneration;
 }
 
-void AudioEngine::loadFile(const juce::File& file)
+int AudioEngine::readDeckSamples(int channel, juce::int64 start, int numSamples, float* dest) const
 {
-    auto* reader = formatManager.createReaderFor(file);
-    if (reader != nullptr)
+    std::shared_ptr<const DecodedSample> sample;
+
+    // 帯域解析の低優先度スレッドから呼ばれる。オーディオスレッドが待つ recordLock は
+    // 長さと再生元を読む間だけ持ち、コピーはロックの外で（優先度逆転を起こさない）
+    const juce::ScopedLock bufferLock(recordedBufferLock);
+
     {
-        std::unique_ptr<juce::AudioFormatReaderSource> newSource(new juce::AudioFormatReaderSource(reader, true));
-        transportSource.setSource(newSource.get(), 0, nullptr, reader->sampleRate);
-        readerSource.reset(newSource.release());
+        juce::SpinLock::ScopedLockType lock(const_cast<juce::SpinLock&>(recordLock));
 
-        resamplerSource.reset(new juce::ResamplingAudioSource(&transportSource, false, 2));
+        const auto end = juce::jmin(start + numSamples, recordWritePosition);
+        if (start < 0 || end <= start)
+            return 0;
 
-        sendChangeMessage();
+        numSamples = static_cast<int>(end - start);
+        sample = deckSample;
     }
+
+    if (sample == nullptr)
+    {
+        // 録音中にオーディオスレッドが書くのは recordWritePosition より後ろだけなので、
+        // 読んだ長さまでは書き換わらない（差し替え・消去は recordedBufferLock で止めてある）
+        const int ch = juce::jmin(channel, recordedBuffer.getNumChannels() - 1);
+        juce::FloatVectorOperations::copy(dest, recordedBuffer.getReadPointer(ch, static_cast<int>(start)), numSamples);
+        return numSamples;
+    }
+
+    // サンプルは不変なので同じくロック外で読む（デコード途中なら揃った先頭まで）
+    numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(numSamples), sample->getAvailableSamples() - start));
+    if (numSamples <= 0)
+        return 0;
+
+    sample->readSamples(juce::jmin(channel, sample->getNumChannels() - 1), start, numSamples, dest);
+    return numSamples;
+}
+
+void AudioEngine::startPreview(const juce::File& file)
+{
+    // ヘッダーを開くだけ。サンプルは先読みスレッドが少しずつ読む
+    auto* reader = formatManager.createReaderFor(file);
+    if (reader == nullptr)
+    {
+        stopPreview();
+        return;
+    }
+
+    std::unique_ptr<juce::AudioFormatReaderSource> newSource(new juce::AudioFormatReaderSource(reader, true));
+
+    // setSource はコールバックロック内で差し替えるので、再生中でも安全
+    transportSource.stop();
+    transportSource.setSource(newSource.get(), previewReadAheadSamples, &previewReadAheadThread,
+                              reader->sampleRate, 2); // モノラルは両チャンネルへ複製される
+    readerSource = std::move(newSource); // 古いソースは差し替え後に破棄
+    previewFile = file;
+
+    transportSource.setPosition(0.0);
+    transportSource.start();
+}
+
+void AudioEngine::stopPreview()
+{
+    transportSource.stop();
+    transportSource.setSource(nullptr);
+    readerSource.reset();
+    previewFile = juce::File();
 }
 
 void AudioEngine::play()
@@ -162,12 +315,16 @@ void AudioEngine::play()
     {
         playing = true;
         targetScratchSpeed = 1.0;
+        publishState();
+        sendChangeMessage(); // UI のアニメーションを起こす
     }
 }
 
 void AudioEngine::stop()
 {
     playing = false;
+    publishState();
+    sendChangeMessage();
 }
 
 void AudioEngine::setScratchRate(double rate)
@@ -182,17 +339,28 @@ void AudioEngine::setCrossfaderGain(float gain)
 
 void AudioEngine::startRecording()
 {
+    std::shared_ptr<const DecodedSample> previousSample; // 解放はロック外で
+
     {
+        const juce::ScopedLock bufferLock(recordedBufferLock);
         juce::SpinLock::ScopedLockType lock(recordLock);
+        previousSample = std::exchange(deckSample, nullptr);
         recordWritePosition = 0;
+        recordedSampleRate = currentSampleRate;
         recordedBuffer.clear();
         recordingState = true;
         playing = false; // 録音中は再生停止
     }
 
-    // Reset the thumbnail for the new recording (outside lock)
-    resetRecordedThumbnail();
+    deckSlotIndex = -1;
+    deckReloadFile = juce::File();
+    deckLoadFile = juce::File();
+
+    // Reset the peaks for the new recording (outside lock)
+    resetRecordedThumbnail(recordedBuffer.getNumChannels(), recordedBuffer.getNumSamples());
+    deckContentChanged(juce::File());
 
+    publishState();
     sendChangeMessage();
 }
 
@@ -201,8 +369,9 @@ void AudioEngine::stopRecording()
     {
         juce::SpinLock::ScopedLockType lock(recordLock);
         recordingState = false;
-        playbackPosition = 0.0;
+        playbackPosition = {};
     }
+    state.recording.publish(false); // バッファが一杯になるとオーディオスレッドから来る
     sendChangeMessage();
 }
 
@@ -211,8 +380,8 @@ void AudioEngine::setPlaybackPosition(double normalizedPosition)
     juce::SpinLock::ScopedLockType lock(recordLock);
     if (recordWritePosition > 0)
     {
-        playbackPosition = normalizedPosition * recordWritePosition;
-        playbackPosition = juce::jlimit(0.0, static_cast<double>(recordWritePosition - 1), playbackPosition);
+        const double position = normalizedPosition * static_cast<double>(recordWritePosition);
+        playbackPosition = Playhead::fromPosition(juce::jlimit(0.0, static_cast<double>(recordWritePosition - 1), position));
     }
 }
 
@@ -220,7 +389,7 @@ double AudioEngine::getPlaybackPosition() const
 {
     juce::SpinLock::ScopedLockType lock(const_cast<juce::SpinLock&>(recordLock));
     if (recordWritePosition > 0)
-        return playbackPosition / recordWritePosition;
+        return playbackPosition.toPosition() / static_cast<double>(recordWritePosition);
     return 0.0;
 }
 
@@ -231,8 +400,189 @@ void AudioEngine::setScratchSpeed(double speed)
 
 void AudioEngine::changeListenerCallback(juce::ChangeBroadcaster* source)
 {
-    // 必要に応じて実装
-    juce::ignoreUnused(source);
+    if (source == &transportSource)
+    {
+        // プレビューが最後まで再生されたらファイルを閉じる
+        if (transportSource.hasStreamFinished())
+            stopPreview();
+        return;
+    }
+
+    if (source == &sampleCache)
+    {
+        applyLoadedSamples();
+        return;
+    }
+
+    if (source == &libraryEncoder)
+    {
+        applyEncodedRecordings();
+        return;
+    }
+
+    if (source == &segmenter)
+    {
+        VoiceSegmenter::Result result;
+
+        // デッキが差し替わった後に届いた古い結果は捨てる
+        if (segmenter.popResult(result) && result.requestId == deckGeneration)
+        {
+            cueMarkers = std::move(result.segments);
+            ++cueRevision;
+
+            // 世代が同じならデッキの中身は解析したもの。解析中に圧縮ファイルへ
+            // 置き換わっていることがあるので、依頼時のファイルではなく今のファイルへ保存する
+            if (deckSourceFile.existsAsFile())
+                VoiceSegmenter::saveCues(deckSourceFile, cueMarkers, result.sampleRate, result.numSamples);
+
+            publishState();
+            sendChangeMessage();
+        }
+    }
+}
+
+void AudioEngine::publishState()
+{
+    // メッセージスレッド。値が変わったフィールドだけが購読者に届く
+    state.playing.publish(playing);
+    state.recording.publish(recordingState);
+    state.deckGeneration.publish(deckGeneration);
+    state.cueRevision.publish(cueRevision);
+    state.currentBank.publish(currentBank);
+    state.activeSlot.publish(getActiveSlot());
+    state.slotsRevision.publish(slotsRevision);
+}
+
+void AudioEngine::deckContentChanged(const juce::File& sourceFile)
+{
+    ++deckGeneration;
+    deckSourceFile = sourceFile;
+    cueMarkers.clear();
+    ++cueRevision;
+}
+
+int AudioEngine::copyDeckAudio(juce::AudioBuffer<float>& dest, double& sampleRate)
+{
+    std::shared_ptr<const DecodedSample> sample;
+    int numSamples = 0;
+
+    {
+        juce::SpinLock::ScopedLockType lock(recordLock);
+
+        numSamples = static_cast<int>(juce::jmin(recordWritePosition, static_cast<juce::int64>(std::numeric_limits<int>::max())));
+        if (numSamples <= 0)
+            return 0;
+
+        if (deckSample == nullptr)
+        {
+            sampleRate = recordedSampleRate;
+
+            // 録音バッファは録音中に書き換わるのでロック内でコピー
+            dest.setSize(recordedBuffer.getNumChannels(), numSamples, false, false, true);
+            for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+                dest.copyFrom(ch, 0, recordedBuffer, ch, 0, numSamples);
+            return numSamples;
+        }
+
+        sample = deckSample;
+    }
+
+    sampleRate = sample->getSampleRate();
+    numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(numSamples), sample->getAvailableSamples())); // デコード途中なら揃った先頭だけ
+
+    // サンプルは不変なのでロック外で読む（モノラルは両チャンネルへ）
+    dest.setSize(2, numSamples, false, false, true);
+    for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+        sample->readSamples(juce::jmin(ch, sample->getNumChannels() - 1), 0, numSamples, dest.getWritePointer(ch));
+
+    return numSamples;
+}
+
+// --- Voice segmentation ---
+
+void AudioEngine::analyseSegments()
+{
+    if (recordingState)
+        return;
+
+    // 録音済み範囲だけをコピー（解析はワーカースレッド側で行う）
+    juce::AudioBuffer<float> take;
+    double sr = currentSampleRate;
+    const int numSamples = copyDeckAudio(take, sr);
+    if (numSamples <= 0)
+        return;
+
+    segmenter.requestAnalysis(std::move(take), numSamples, sr, deckSourceFile, deckGeneration);
+}
+
+int AudioEngine::assignSegmentsToSlots()
+{
+    const int numToAssign = juce::jmin(SLOTS_PER_BANK, static_cast<int>(cueMarkers.size()));
+    if (numToAssign == 0)
+        return 0;
+
+    const auto baseName = deckSourceFile.getFullPathName().isNotEmpty()
+                              ? deckSourceFile.getFileNameWithoutExtension()
+                              : juce::String("Take");
+
+    // デッキを一度 float で取り出してから区間を切り出す（スロットはメッセージスレッド専用）
+    juce::AudioBuffer<float> deck;
+    double deckRate = currentSampleRate;
+    const int deckLength = copyDeckAudio(deck, deckRate);
+    if (deckLength <= 0)
+        return 0;
+
+    const auto format = sampleCache.getStorageFormat();
+
+    // スロットのロード完了でデッキが載せ替わるとキューが消えるので、区間は先に写しておく
+    const auto segments = cueMarkers;
+    bool deckSlotReassigned = false;
+
+    // 区間はメモリ上のサンプルとしてスロットへ（キャッシュは通さない）
+    for (int i = 0; i < numToAssign; ++i)
+    {
+        const auto& segment = segments[static_cast<size_t>(i)];
+        const int start = static_cast<int>(juce::jlimit<juce::int64>(0, deckLength, segment.start));
+        const int length = static_cast<int>(juce::jlimit<juce::int64>(0, deckLength - start, segment.end - segment.start));
+
+        juce::AudioBuffer<float> piece(deck.getNumChannels(), length);
+        for (int ch = 0; ch < deck.getNumChannels(); ++ch)
+            piece.copyFrom(ch, 0, deck, ch, start, length);
+
+        auto segmentSample = DecodedSample::fromBuffer(std::move(piece), deckRate, format);
+        if (segmentSample == nullptr)
+            continue; // メモリが足りなければその区間は割り当てない
+
+        const int index = banks.indexOf(currentBank, i);
+        banks.assignSample(index, std::move(segmentSample), baseName + " #" + juce::String(i + 1));
+        slotLoaded(index);
+
+        if (index == deckSlotIndex)
+            deckSlotReassigned = true;
+    }
+
+    ++slotsRevision;
+
+    // デッキが再生していたスロットを上書きしたら、デッキも新しい区間に載せ替える
+    // （古い区間を鳴らし続けない。deckGeneration も進むので波形・キューも追従する）
+    if (deckSlotReassigned)
+        activateSlot(deckSlotIndex);
+
+    publishState();
+    sendChangeMessage();
+    return numToAssign;
+}
+
+juce::File AudioEngine::getSettingsFile() const
+{
+    // ライブラリフォルダの隣（オーディオデバイスの設定と同じ場所）
+    return getLibraryFolder().getSiblingFile("settings.xml");
+}
+
+void AudioEngine::setLibraryCodec(LibraryEncoder::Codec codec)
+{
+    libraryEncoder.setCodec(codec);
+    settings.setValue(libraryCodecKey, getCodecName(codec));
 }
 
 juce::File AudioEngine::getLibraryFolder() const
@@ -250,22 +600,13 @@ juce::File AudioEngine::getLibraryFolder() const
 
 juce::File AudioEngine::saveRecordingToFile()
 {
-    int samplesToSave = 0;
-    double sr = currentSampleRate;
-    unsigned int numCh = 2;
     juce::AudioBuffer<float> localCopy;
+    double sr = currentSampleRate;
+    const int samplesToSave = copyDeckAudio(localCopy, sr);
+    if (samplesToSave <= 0)
+        return juce::File();
 
-    {
-        juce::SpinLock::ScopedLockType lock(recordLock);
-
-        if (recordWritePosition <= 0)
-            return juce::File();
-
-        samplesToSave = recordWritePosition;
-        sr = currentSampleRate;
-        numCh = static_cast<unsigned int>(recordedBuffer.getNumChannels());
-        localCopy.makeCopyOf(recordedBuffer);
-    }
+    const auto numCh = static_cast<unsigned int>(localCopy.getNumChannels());
     // Lock released — safe to do file I/O without blocking the audio thread
 
     auto libraryFolder = getLibraryFolder();
@@ -291,6 +632,13 @@ juce::File AudioEngine::saveRecordingToFile()
     if (writer != nullptr)
     {
         writer->writeFromAudioSampleBuffer(localCopy, 0, samplesToSave);
+        writer.reset(); // フラッシュしてからキュー解析（サイズ/日時をキャッシュに記録するため）
+
+        deckSourceFile = outputFile;
+        analyseSegments();
+
+        // 設定されたコーデックへ裏で変換（終わったら applyEncodedRecordings で置き換え）
+        libraryEncoder.encodeInBackground(outputFile);
         return outputFile;
     }
 
@@ -299,110 +647,479 @@ juce::File AudioEngine::saveRecordingToFile()
 
 void AudioEngine::loadFileToBuffer(const juce::File& file)
 {
-    auto* reader = formatManager.createReaderFor(file);
-    if (reader != nullptr)
+    // メモリにあればその場で（ポインタを受け取るだけ）
+    if (auto sample = sampleCache.findLoaded(file, currentSampleRate))
+    {
+        deckLoadFile = juce::File();
+        showFileOnDeck(file, std::move(sample));
+        return;
+    }
+
+    // デバイスレートへ変換済みのサンプルを裏で（ディスクキャッシュにあればマップするだけ）
+    // 長いファイルはデコードが済んだ先頭部分が先に届くので、そこから再生を始める
+    deckLoadFile = file;
+    sampleCache.requestLoad(file, currentSampleRate, true);
+    publishState();
+    sendChangeMessage();
+}
+
+void AudioEngine::showFileOnDeck(const juce::File& file, std::shared_ptr<const DecodedSample> sample)
+{
+    // 先頭部分を再生中のところへ全体が届いた: 同じ音なので再生位置を保ったまま差し替え
+    if (deckSlotIndex < 0 && deckSourceFile == file && deckSample != nullptr
+        && deckSample->getNumSamples() == sample->getNumSamples() && deckSample != sample)
+    {
+        replaceDeckSample(std::move(sample));
+        loadOrAnalyseCues(file); // 先頭部分の間は見送っていた
+        return;
+    }
+
+    const auto numSamples = sample->getNumSamples();
+    std::shared_ptr<const DecodedSample> previousSample; // 解放はロック外で
+
+    {
+        juce::SpinLock::ScopedLockType lock(recordLock);
+        previousSample = std::exchange(deckSample, sample);
+        recordWritePosition = numSamples;
+        playbackPosition = {};
+    }
+
+    deckSlotIndex = -1;
+    deckReloadFile = juce::File();
+    deckContentChanged(file);
+
+    // ── Populate thumbnail from loaded file data ──────────────────
+    // Feed the loaded sample (or the decoded prefix so far) into the thumbnail
+    // so the waveform is available immediately without UI thread scanning.
+    resetRecordedThumbnail(sample->getNumChannels(), numSamples);
+    populateThumbnail(*sample, sample->getAvailableSamples());
+
+    // キューは全体が揃ってから（先頭部分だけを解析しても区間が欠ける）
+    if (sample->isComplete())
+        loadOrAnalyseCues(file);
+
+    publishState();
+    sendChangeMessage();
+}
+
+void AudioEngine::loadOrAnalyseCues(const juce::File& file)
+{
+    // キャッシュ済みのキューがあれば即座に使い、無ければバックグラウンド解析
+    if (VoiceSegmenter::loadCues(file, cueMarkers, currentSampleRate))
+        ++cueRevision;
+    else
+        analyseSegments();
+}
+
+void AudioEngine::populateThumbnail(const DecodedSample& sample, juce::int64 numSamples)
+{
+    // addBlock in chunks (safe even for large buffers)
+    const int chunkSize = 32768;
+    // チャンネルはサンプルのまま（モノラルは 1 レーン、ステレオ以上はチャンネルごと）
+    juce::AudioBuffer<float> thumbChunk(juce::jmax(1, sample.getNumChannels()), chunkSize);
+    for (juce::int64 offset = 0; offset < numSamples; offset += chunkSize)
+    {
+        int thisChunk = static_cast<int>(juce::jmin(static_cast<juce::int64>(chunkSize), numSamples - offset));
+        for (int ch = 0; ch < thumbChunk.getNumChannels(); ++ch)
+            sample.readSamples(juce::jmin(ch, sample.getNumChannels() - 1), offset, thisChunk, thumbChunk.getWritePointer(ch));
+        waveformPeaks.addBlock(offset, thumbChunk, 0, thisChunk);
+    }
+}
+
+void AudioEngine::replaceDeckSample(std::shared_ptr<const DecodedSample> sample)
+{
+    const auto numSamples = sample->getNumSamples();
+    std::shared_ptr<const DecodedSample> previousSample; // 解放はロック外で
+    double ratio = 1.0;
+
     {
-        // 録音バッファにファイルの内容をロード
-        int numSamples = static_cast<int>(reader->lengthInSamples);
-        int numChannels = static_cast<int>(reader->numChannels);
+        juce::SpinLock::ScopedLockType lock(recordLock);
+
+        if (recordWritePosition > 0)
+            ratio = static_cast<double>(numSamples) / static_cast<double>(recordWritePosition);
 
+        previousSample = std::exchange(deckSample, std::move(sample));
+        recordWritePosition = numSamples;
+
+        // 同じ長さ（先頭部分 → 全体）なら整数部・端数をそのまま引き継ぐ
+        if (ratio != 1.0)
+            playbackPosition = Playhead::fromPosition(juce::jlimit(0.0, static_cast<double>(numSamples - 1),
+                                                                   playbackPosition.toPosition() * ratio));
+    }
+
+    // 中身は同じ音なのでキューは捨てずに換算する
+    for (auto& cue : cueMarkers)
+    {
+        cue.start = static_cast<juce::int64>(std::llround(static_cast<double>(cue.start) * ratio));
+        cue.end = static_cast<juce::int64>(std::llround(static_cast<double>(cue.end) * ratio));
+    }
+    if (ratio != 1.0 && ! cueMarkers.empty())
+        ++cueRevision;
+
+    resetRecordedThumbnail(deckSample->getNumChannels(), numSamples);
+    populateThumbnail(*deckSample, numSamples);
+    publishState();
+    sendChangeMessage();
+}
+
+void AudioEngine::handleAsyncUpdate()
+{
+    const double rate = currentSampleRate;
+
+    // スロット: ファイル由来のものは今のバンクを裏で作り直し（それまでは古いデータのまま
+    // デッキが補正再生する）、他のバンクは手放して表示時に作り直す
+    for (int index = 0; index < banks.getNumSlots(); ++index)
+    {
+        const auto sample = banks.getSample(index);
+        if (sample == nullptr || sample->getSampleRate() == rate)
+            continue;
+
+        if (banks.getFile(index) == juce::File())
         {
-            juce::SpinLock::ScopedLockType lock(recordLock);
-            recordedBuffer.setSize(juce::jmax(2, numChannels), numSamples);
-            reader->read(&recordedBuffer, 0, numSamples, 0, true, true);
+            // キュー区間の切り出しは元ファイルが無いので裏で変換する（届くまでは古いレートのまま）
+            sampleCache.requestResample(sample, rate);
+        }
+        else if (banks.bankOf(index) == currentBank || index == deckSlotIndex)
+        {
+            banks.markLoading(index);
+            sampleCache.requestLoad(banks.getFile(index), rate);
+        }
+        else
+        {
+            banks.unload(index);
+        }
+    }
 
-            recordWritePosition = numSamples;
-            currentSampleRate = reader->sampleRate;
-            playbackPosition = 0.0;
+    // ファイルから載せたデッキも作り直す
+    std::shared_ptr<const DecodedSample> sample;
+    {
+        juce::SpinLock::ScopedLockType lock(recordLock);
+        sample = deckSample;
+    }
+
+    if (sample != nullptr && sample->getSampleRate() != rate && deckSlotIndex < 0 && deckSourceFile.existsAsFile())
+    {
+        deckReloadFile = deckSourceFile;
+        sampleCache.requestLoad(deckReloadFile, rate);
+    }
+
+    ++slotsRevision;
+    publishState();
+    sendChangeMessage();
+}
+
+// --- Sample Banks Implementation ---
+
+void AudioEngine::setCurrentBank(int bankIndex)
+{
+    if (bankIndex < 0 || bankIndex >= NUM_BANKS || bankIndex == currentBank) return;
+
+    // 離れるバンクのデータを手放す（デッキで再生中のものはデッキが持ち続け、
+    // 予算内ならキャッシュにも残るので戻ってきたときはすぐ揃う）
+    for (int i = 0; i < SLOTS_PER_BANK; ++i)
+        banks.unload(banks.indexOf(currentBank, i));
+
+    currentBank = bankIndex;
+
+    // 表示されたバンクは裏でロードしておく（ここではデコードしない）
+    for (int i = 0; i < SLOTS_PER_BANK; ++i)
+        requestSlotLoad(banks.indexOf(currentBank, i));
+
+    ++slotsRevision;
+    publishState();
+    sendChangeMessage();
+}
+
+void AudioEngine::requestSlotLoad(int index)
+{
+    if (banks.getState(index) != SampleBanks::State::unloaded) return;
+
+    // メモリにあればその場で（ポインタを受け取るだけ）
+    if (auto sample = sampleCache.findLoaded(banks.getFile(index), currentSampleRate))
+    {
+        banks.setLoaded(index, std::move(sample));
+        return;
+    }
+
+    banks.markLoading(index);
+    sampleCache.requestLoad(banks.getFile(index), currentSampleRate);
+}
+
+void AudioEngine::applyLoadedSamples()
+{
+    bool changed = false;
+
+    for (auto& result : sampleCache.collectLoaded())
+    {
+        // キュー区間のレート変換: まだ元のサンプルを持っているスロットだけ差し替える
+        // （その後またレートが変わったものは、そのとき頼み直しているので捨てる）
+        if (result.source != nullptr)
+        {
+            if (result.sample == nullptr || result.sampleRate != currentSampleRate)
+                continue; // 確保できなかった: 古いレートのまま（デッキが補正再生する）
+
+            for (int index = 0; index < banks.getNumSlots(); ++index)
+            {
+                if (banks.getSample(index) != result.source || banks.getFile(index) != juce::File())
+                    continue;
+
+                banks.assignSample(index, result.sample, banks.getName(index));
+                if (index == deckSlotIndex)
+                    replaceDeckSample(result.sample);
+                changed = true;
+            }
+            continue;
+        }
+
+        const bool deckLoading = result.file == deckLoadFile;
+
+        // デコード途中の先頭部分: ファイルを待っているデッキだけが使う（スロットは全部揃ってから）
+        if (! result.complete)
+        {
+            if (deckLoading && result.sampleRate == currentSampleRate && result.sample != nullptr)
+                showFileOnDeck(result.file, result.sample);
+            continue;
+        }
+
+        const auto waitingSlots = banks.findLoading(result.file);
+        const bool deckWaiting = result.file == deckReloadFile;
+
+        // デバイスレートが変わる前に頼んだもの: 今のレートで頼み直す
+        if (result.sampleRate != currentSampleRate)
+        {
+            if (! waitingSlots.empty() || deckWaiting || deckLoading)
+                sampleCache.requestLoad(result.file, currentSampleRate, deckLoading);
+            continue;
         }
 
-        delete reader;
+        if (deckLoading)
+        {
+            deckLoadFile = juce::File();
+            if (result.sample != nullptr)
+                showFileOnDeck(result.file, result.sample);
+            changed = true;
+        }
+
+        for (int index : waitingSlots)
+        {
+            banks.setLoaded(index, result.sample);
+
+            // 再生中のスロットが作り直されたらデッキも差し替え
+            if (index == deckSlotIndex && result.sample != nullptr)
+                replaceDeckSample(result.sample);
+
+            slotLoaded(index);
+            changed = true;
+        }
 
-        // ── Populate thumbnail from loaded file data ──────────────────
-        // Feed the entire loaded buffer into the thumbnail so the waveform
-        // is available immediately without UI thread scanning.
-        resetRecordedThumbnail();
-        // addBlock in chunks (safe even for large buffers)
-        const int chunkSize = 32768;
-        for (int offset = 0; offset < numSamples; offset += chunkSize)
+        if (deckWaiting)
         {
-            int thisChunk = juce::jmin(chunkSize, numSamples - offset);
-            recordedThumbnail.addBlock(offset, recordedBuffer, offset, thisChunk);
+            deckReloadFile = juce::File();
+            if (result.sample != nullptr)
+                replaceDeckSample(result.sample);
         }
+    }
 
+    if (changed)
+    {
+        ++slotsRevision;
+        publishState();
         sendChangeMessage();
     }
 }
 
-// --- Sample Slots Implementation ---
-
-void AudioEngine::loadFileToSlot(int slotIndex, const juce::File& file)
+void AudioEngine::applyEncodedRecordings()
 {
-    if (slotIndex < 0 || slotIndex >= NUM_SLOTS) return;
+    bool changed = false;
 
-    auto* reader = formatManager.createReaderFor(file);
-    if (reader != nullptr)
+    for (const auto& result : libraryEncoder.collectFinished())
     {
-        int numSamples = static_cast<int>(reader->lengthInSamples);
-        int numChannels = static_cast<int>(reader->numChannels);
+        if (result.encoded == juce::File())
+            continue; // 変換に失敗: WAV のまま使い続ける
 
-        auto& slot = sampleSlots[static_cast<size_t>(slotIndex)];
-        slot.buffer.setSize(juce::jmax(2, numChannels), numSamples);
-        reader->read(&slot.buffer, 0, numSamples, 0, true, true);
-        slot.numSamples = numSamples;
-        slot.fileName = file.getFileNameWithoutExtension();
+        // デッキ: 録音直後ならキューも新しいファイルの横へ移す
+        if (deckSourceFile == result.source)
+        {
+            deckSourceFile = result.encoded;
+            if (! cueMarkers.empty())
+                VoiceSegmenter::saveCues(deckSourceFile, cueMarkers, getRecordedSampleRate(), recordWritePosition);
+        }
 
-        delete reader;
+        // ロード待ちのものは新しいファイルで頼み直す（WAV の完了は誰も待たなくなる）
+        if (deckLoadFile == result.source)
+        {
+            deckLoadFile = result.encoded;
+            sampleCache.requestLoad(deckLoadFile, currentSampleRate, true);
+        }
 
-        // アクティブスロットならメインバッファにもコピー
-        if (slotIndex == activeSlotIndex)
+        if (deckReloadFile == result.source)
         {
-            setActiveSlot(slotIndex);
+            deckReloadFile = result.encoded;
+            sampleCache.requestLoad(deckReloadFile, currentSampleRate);
         }
 
+        for (int index : banks.replaceFile(result.source, result.encoded))
+            if (banks.getState(index) == SampleBanks::State::loading)
+                sampleCache.requestLoad(result.encoded, currentSampleRate);
+
+        // 読み込み中などで消せなければ WAV も残る（次の走査で両方が一覧に並ぶ）
+        VoiceSegmenter::getCueFileFor(result.source).deleteFile();
+        result.source.deleteFile();
+        changed = true;
+    }
+
+    if (changed)
+    {
+        ++slotsRevision;
+        publishState();
         sendChangeMessage();
     }
 }
 
+void AudioEngine::slotLoaded(int index)
+{
+    if (index != pendingActiveSlot) return;
+
+    pendingActiveSlot = -1;
+    if (banks.getState(index) == SampleBanks::State::loaded)
+        activateSlot(index);
+}
+
+void AudioEngine::loadFileToSlot(int slotIndex, const juce::File& file)
+{
+    if (slotIndex < 0 || slotIndex >= SLOTS_PER_BANK) return;
+
+    const int index = banks.indexOf(currentBank, slotIndex);
+    banks.assignFile(index, file);
+
+    // アクティブスロットならロード完了時にデッキも差し替え
+    if (index == activeSlotIndex)
+        pendingActiveSlot = index;
+
+    // メモリ → ディスクキャッシュ（マップするだけ）→ デコード の順に裏で探す
+    requestSlotLoad(index);
+    if (banks.getState(index) == SampleBanks::State::loaded)
+        slotLoaded(index);
+
+    ++slotsRevision;
+    publishState();
+    sendChangeMessage();
+}
+
 void AudioEngine::setActiveSlot(int slotIndex)
 {
-    if (slotIndex < 0 || slotIndex >= NUM_SLOTS) return;
+    if (slotIndex < 0 || slotIndex >= SLOTS_PER_BANK) return;
 
-    activeSlotIndex = slotIndex;
+    const int index = banks.indexOf(currentBank, slotIndex);
+    const auto state = banks.getState(index);
+    if (state == SampleBanks::State::empty || state == SampleBanks::State::failed) return;
 
-    const auto& slot = sampleSlots[static_cast<size_t>(slotIndex)];
-    if (slot.numSamples > 0)
+    // 未ロードならロード完了を待ってから切り替える（待っている間もデッキは今の音を鳴らす）
+    pendingActiveSlot = index;
+    requestSlotLoad(index);
+
+    if (banks.getState(index) == SampleBanks::State::loaded)
+        slotLoaded(index);
+    else
+    {
+        ++slotsRevision; // ロード待ちになった
+        publishState();
+        sendChangeMessage();
+    }
+}
+
+void AudioEngine::activateSlot(int index)
+{
+    activeSlotIndex = index;
+
+    const auto numSamples = banks.getNumSamples(index);
+    if (numSamples > 0)
     {
+        std::shared_ptr<const DecodedSample> previousSample; // 解放はロック外で
+        const auto sampleToPlay = banks.getSample(index);
+
         {
             juce::SpinLock::ScopedLockType lock(recordLock);
-            // スロットのバッファをメイン再生バッファにコピー
-            recordedBuffer.makeCopyOf(slot.buffer);
-            recordWritePosition = slot.numSamples;
-            playbackPosition = 0.0;
+            // スロットのサンプルをコピーせずそのままデッキの再生元に（形式は問わない）
+            previousSample = std::exchange(deckSample, sampleToPlay);
+            recordWritePosition = numSamples;
+            playbackPosition = {};
         }
 
+        deckSlotIndex = index;
+        deckReloadFile = juce::File();
+        deckLoadFile = juce::File();
+
         // Populate thumbnail for the new slot content (outside lock)
-        resetRecordedThumbnail();
-        const int numSamples = slot.numSamples;
-        const int chunkSize = 32768;
-        for (int offset = 0; offset < numSamples; offset += chunkSize)
-        {
-            int thisChunk = juce::jmin(chunkSize, numSamples - offset);
-            recordedThumbnail.addBlock(offset, recordedBuffer, offset, thisChunk);
-        }
+        resetRecordedThumbnail(sampleToPlay->getNumChannels(), numSamples);
+        deckContentChanged(juce::File());
+        populateThumbnail(*sampleToPlay, numSamples);
 
+        publishState();
         sendChangeMessage();
     }
 }
 
+std::vector<SampleCache::Usage> AudioEngine::getMemoryUsage() const
+{
+    auto usage = sampleCache.getUsage();
+
+    // デッキは録音先でもあるので常に自前のバッファを持つ
+    // （スロット再生中はキャッシュのサンプルを直接読むので、その分は上の一覧に含まれる）
+    SampleCache::Usage deck;
+    deck.file = deckSourceFile;
+    deck.bytes = static_cast<size_t>(recordedBuffer.getNumChannels()) * static_cast<size_t>(recordedBuffer.getNumSamples()) * sizeof(float);
+    deck.inUse = true;
+    usage.insert(usage.begin(), deck);
+
+    return usage;
+}
+
+void AudioEngine::setSampleMemoryBudget(size_t bytes)
+{
+    sampleCache.setMemoryBudget(bytes);
+    settings.setValue(sampleMemoryBudgetKey, static_cast<int>(bytes / (1024 * 1024)));
+}
+
+void AudioEngine::setCompactSampleStorage(bool shouldBeCompact)
+{
+    sampleCache.setStorageFormat(shouldBeCompact ? DecodedSample::Format::int16
+                                                 : DecodedSample::Format::float32);
+    settings.setValue(compactSampleStorageKey, shouldBeCompact);
+}
+
+double AudioEngine::getRecordedSampleRate() const
+{
+    juce::SpinLock::ScopedLockType lock(const_cast<juce::SpinLock&>(recordLock));
+    return deckSample != nullptr ? deckSample->getSampleRate() : recordedSampleRate;
+}
+
+int AudioEngine::getActiveSlot() const
+{
+    if (banks.bankOf(activeSlotIndex) != currentBank) return -1;
+    return activeSlotIndex - banks.indexOf(currentBank, 0);
+}
+
 juce::String AudioEngine::getSlotFileName(int slotIndex) const
 {
-    if (slotIndex < 0 || slotIndex >= NUM_SLOTS) return "";
-    return sampleSlots[static_cast<size_t>(slotIndex)].fileName;
+    if (slotIndex < 0 || slotIndex >= SLOTS_PER_BANK) return "";
+    return banks.getName(banks.indexOf(currentBank, slotIndex));
 }
 
 bool AudioEngine::isSlotLoaded(int slotIndex) const
 {
-    if (slotIndex < 0 || slotIndex >= NUM_SLOTS) return false;
-    return sampleSlots[static_cast<size_t>(slotIndex)].numSamples > 0;
+    if (slotIndex < 0 || slotIndex >= SLOTS_PER_BANK) return false;
+    return banks.getState(banks.indexOf(currentBank, slotIndex)) == SampleBanks::State::loaded;
+}
+
+bool AudioEngine::isSlotAssigned(int slotIndex) const
+{
+    if (slotIndex < 0 || slotIndex >= SLOTS_PER_BANK) return false;
+    return banks.getState(banks.indexOf(currentBank, slotIndex)) != SampleBanks::State::empty;
+}
+
+bool AudioEngine::isSlotLoading(int slotIndex) const
+{
+    if (slotIndex < 0 || slotIndex >= SLOTS_PER_BANK) return false;
+    return banks.getState(banks.indexOf(currentBank, slotIndex)) == SampleBanks::State::loading;
 }
@@ -6,10 +6,20 @@
 #pragma once
 #include <JuceHeader.h>
 #include "Constants.h"
+#include "VoiceSegmenter.h"
+#include "DecodedSampleCache.h"
+#include "SampleCache.h"
+#include "SampleBanks.h"
+#include "SampleRenderKernel.h"
+#include "LibraryEncoder.h"
+#include "WaveformPeaks.h"
+#include "EngineState.h"
+#include "AudioMeter.h"
 
 class AudioEngine : public juce::AudioSource,
 public juce::ChangeListener,
-public juce::ChangeBroadcaster
+public juce::ChangeBroadcaster,
+private juce::AsyncUpdater
 {
 	public:
 	AudioEngine();
@@ -21,7 +31,6 @@ public juce::ChangeBroadcaster
 	void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
 
 	// Control Methods
-	void loadFile(const juce::File& file);
 	void play();
 	void stop();
 	void setScratchRate(double rate); // Controls playback speed/pitch
@@ -38,83 +47,207 @@ public juce::ChangeBroadcaster
 	double getPlaybackPosition() const;
 	void setScratchSpeed(double speed); // 負の値で逆再生
 
-	// Getters for Visualizers
-	juce::AudioTransportSource& getTransportSource() { return transportSource; }
-	double getCurrentPosition() { return transportSource.getCurrentPosition(); }
-	double getLengthInSeconds() { return transportSource.getLengthInSeconds(); }
 	bool isPlaying() const { return playing; }
 
+	// ── ライブラリのプレビュー再生 ─────────────────────────────────────
+	// デッキ（録音バッファ）とは独立したボイス。ディスクから先読みバッファ経由で
+	// ストリーミングするので全体のデコードは不要で、デッキの内容も壊さない。
+	void startPreview(const juce::File& file);
+	void stopPreview();
+	bool isPreviewing() const { return transportSource.isPlaying(); }
+	juce::File getPreviewFile() const { return previewFile; }
+	void setPreviewGain(float gain) { previewGain.setTargetValue(gain); }
+	double getPreviewPosition() const { return transportSource.getCurrentPosition(); }
+	double getPreviewLengthInSeconds() const { return transportSource.getLengthInSeconds(); }
+
 	// 録音バッファへのアクセス（波形表示用）
 	const juce::AudioBuffer<float>& getRecordedBuffer() const { return recordedBuffer; }
-	double getRecordedSampleRate() const { return currentSampleRate; }
-	int getRecordedSamplesCount() const { return recordWritePosition; } // 実際に録音されたサンプル数
+	double getRecordedSampleRate() const; // デッキの内容のレート（通常はデバイスレート）
+	juce::int64 getRecordedSamplesCount() const { return recordWritePosition; } // 実際に録音されたサンプル数
+
+	// ── 波形描画用ピーク（録音中はオーディオスレッドが足し込む） ─────────
+	// 表示の倍率に合った段の min / max を読む。どの倍率でも見える列数ぶんだけ
+	WaveformPeaks& getWaveformPeaks() { return waveformPeaks; }
+	// デッキの生のサンプル（拡大表示用。ピークより細かく見るとき）。読めた数を返す
+	int readDeckSamples(int channel, juce::int64 start, int numSamples, float* dest) const;
+	int getThumbnailGeneration() const { return thumbnailGeneration; }
 
-	// ── 波形描画用 AudioThumbnail（UIスレッドセーフ） ──────────────────
-	// 録音中にバックグラウンドでmin/maxピークを非同期計算。
-	// UIスレッドからは getMinAndMaxChannel() で O(1) アクセス可能。
-	juce::AudioThumbnail& getRecordedThumbnail() { return recordedThumbnail; }
+	// ── レベルメーター・スペクトラム ──────────────────────────────────────
+	// 入力はホストが getNextAudioBlock の前に push する（録音していなくても）。出力は getNextAudioBlock の最後に
+	AudioMeter& getInputMeter() { return inputMeter; }
+	AudioMeter& getOutputMeter() { return outputMeter; }
 
 	// ライブラリフォルダへの保存
 	juce::File getLibraryFolder() const;
 	juce::File saveRecordingToFile(); // 録音データをWAVとして保存し、ファイルを返す
-
-	// ファイルから録音バッファにロード（スクラッチ再生用）
+	// ライブラリの保存形式（既定 WAV = 変換しない）。WAV 以外を選ぶと録音はまず WAV で保存し、
+	// 裏で変換して置き換える。置き換わったらデッキ・スロットの参照も付け替える（ライブラリ一覧はスキャナが拾う）
+	// 選んだ形式は settings.xml に保存し、次回起動時に戻す
+	void setLibraryCodec(LibraryEncoder::Codec codec);
+	LibraryEncoder::Codec getLibraryCodec() const { return libraryEncoder.getCodec(); }
+	LibraryEncoder& getLibraryEncoder() { return libraryEncoder; }
+
+	// ファイルをデッキにロード（スクラッチ再生用）
+	// デバイスレートへ変換済みのものをキャッシュから使う。録音バッファには触らない
+	// メモリに無ければ裏でロードし、長いファイルはデコード済みの先頭部分から再生を始める
 	void loadFileToBuffer(const juce::File& file);
-
-	// --- Sample Slots (A/B/C/D) ---
-	static constexpr int NUM_SLOTS = 4;
-	void loadFileToSlot(int slotIndex, const juce::File& file);
-	void setActiveSlot(int slotIndex);
-	int getActiveSlot() const { return activeSlotIndex; }
+	bool isDeckLoading() const { return deckLoadFile != juce::File(); }
+
+	// --- Sample banks (NUM_BANKS × SLOTS_PER_BANK) ---
+	// スロット番号は現在のバンク内の番号。データはバックグラウンドで遅延ロードし、
+	// バンク切り替え・スロット選択で同期デコードは起きない
+	static constexpr int NUM_BANKS = 8;
+	static constexpr int SLOTS_PER_BANK = 16;
+	void setCurrentBank(int bankIndex);
+	int getCurrentBank() const { return currentBank; }
+	void loadFileToSlot(int slotIndex, const juce::File& file); // 割り当ててバックグラウンドでロード
+	void setActiveSlot(int slotIndex); // 未ロードならロード完了時にアクティブになる
+	int getActiveSlot() const; // 現在のバンク内のアクティブスロット（別バンクなら -1）
 	juce::String getSlotFileName(int slotIndex) const;
 	bool isSlotLoaded(int slotIndex) const;
+	bool isSlotAssigned(int slotIndex) const;
+	bool isSlotLoading(int slotIndex) const;
+	// デコード済みキャッシュ（スロットのロードはここを経由。ヒットすればマップするだけ）
+	DecodedSampleCache& getDecodedSampleCache() { return decodedCache; }
+	// ロード済みサンプルの一元管理（メモリ予算・使用量の報告）
+	SampleCache& getSampleCache() { return sampleCache; }
+	// 次に使われそうなファイルをデバイスレートで先読み
+	void prefetchSample(const juce::File& file) { sampleCache.prefetch(file, currentSampleRate); }
+	// サンプルごとのメモリ使用量（キャッシュ内のサンプル + デッキの作業バッファ）。設定パネルに表示
+	std::vector<SampleCache::Usage> getMemoryUsage() const;
+	// 使われていないサンプルをメモリに残す上限（既定 256 MB）。settings.xml に保存し、次回起動時に戻す
+	void setSampleMemoryBudget(size_t bytes);
+	size_t getSampleMemoryBudget() const { return sampleCache.getMemoryBudget(); }
+	// スロットのサンプルを 16bit 整数で持つ（メモリ半分。再生時に SIMD で float へ変換）
+	// 既定はオフ（float32 のまま。録音・変換の精度を落とさない）。設定パネルで選び、settings.xml に保存
+	// 切り替え後にロードしたものから適用
+	void setCompactSampleStorage(bool shouldBeCompact);
+	bool isCompactSampleStorage() const { return sampleCache.getStorageFormat() == DecodedSample::Format::int16; }
+
+	// --- Voice segmentation (音節/フレーズ分割) ---
+	// デッキの内容をバックグラウンドで解析し、キューマーカーを作る。
+	// ファイル由来なら結果は .cues サイドカーにキャッシュされる。
+	void analyseSegments();
+	bool isAnalysingSegments() const { return segmenter.isBusy(); }
+	const std::vector<VoiceSegmenter::Segment>& getCueMarkers() const { return cueMarkers; }
+	// キューマーカーの区間を現在のバンクのスロットへ先頭から一括割り当て（割り当て数を返す）
+	int assignSegmentsToSlots();
+
+	// デッキの内容が差し替わるたびに増える（UIの再構築判定用）
+	int getDeckGeneration() const { return deckGeneration; }
+
+	// UI 向けの状態（フィールドごとに購読できる。変わったときだけ届く）
+	EngineState& getState() { return state; }
 
 	// ChangeListener
 	void changeListenerCallback(juce::ChangeBroadcaster* source) override;
 
 	private:
 	juce::AudioFormatManager formatManager;
+
+	// Preview voice（AudioTransportSource が先読みとサンプルレート変換を担当）
+	juce::TimeSliceThread previewReadAheadThread { "Preview read-ahead" };
 	std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
 	juce::AudioTransportSource transportSource;
-	std::unique_ptr<juce::ResamplingAudioSource> resamplerSource;
-
-	// Thumbnail Cache（ファイル再生用）
-	juce::AudioThumbnailCache thumbnailCache{ 5 };
-	juce::AudioThumbnail fileThumbnail;
+	juce::AudioBuffer<float> previewMixBuffer; // prepareToPlay で確保（オーディオスレッドで確保しない）
+	juce::LinearSmoothedValue<float> previewGain { 0.8f };
+	juce::File previewFile;
+	static constexpr int previewReadAheadSamples = 32768;
 
-	// ── Recorded buffer thumbnail（録音/スクラッチ用） ─────────────────
-	juce::AudioThumbnailCache recordedThumbCache{ 2 };
-	juce::AudioThumbnail recordedThumbnail;
+	// ── Recorded buffer peaks（録音/スクラッチ用） ─────────────────────
+	WaveformPeaks waveformPeaks;
 
 	// Crossfader
 	juce::LinearSmoothedValue<float> crossfaderGain { 1.0f };
 
 	// Thread safety for recording buffer access (audio thread vs message thread)
 	juce::SpinLock recordLock;
+	// 録音バッファの差し替え・消去と、解析スレッドのロック外コピーの間だけを守る
+	// （オーディオスレッドは取らない。recordLock は位置を読む間しか持たせない）
+	juce::CriticalSection recordedBufferLock;
 
 	// Recording buffer
 	bool recordingState = false;
 	juce::AudioBuffer<float> recordedBuffer;
-	int recordWritePosition = 0;
-	double currentSampleRate = 44100.0;
+	juce::int64 recordWritePosition = 0; // デッキの長さ（スロット再生中はそのサンプル長。数時間の素材も 64bit で）
+	double currentSampleRate = 44100.0;  // デバイスのレート（ファイルのレートで上書きしない）
+	double recordedSampleRate = 44100.0; // 録音バッファの中身のレート
 
 	// Playback state
 	bool playing = false;
-	double playbackPosition = 0.0; // サンプル位置
+	Playhead playbackPosition; // サンプル位置（整数部 + 小数部。長い素材の後半でも補間の精度が落ちない）
 	double targetScratchSpeed = 1.0;     // 目標再生速度
 	double currentScratchSpeed = 1.0;    // 現在の再生速度（スムーズ変化用）
 
-	// Sample Slots
-	struct SampleSlot {
-		juce::AudioBuffer<float> buffer;
-		juce::String fileName;
-		int numSamples = 0;
-	};
-	std::array<SampleSlot, NUM_SLOTS> sampleSlots;
-	int activeSlotIndex = 0;
-
-	// AudioThumbnail用内部ヘルパー
-	void resetRecordedThumbnail();
+	// Sample banks
+	// サンプルデータはキャッシュファイルをマップしたもの（デバイスレート変換済み）
+	DecodedSampleCache decodedCache;
+	SampleCache sampleCache { decodedCache }; // スロットは参照を持つだけ（同じファイルはデータを共有）
+	SampleBanks banks { NUM_BANKS, SLOTS_PER_BANK };
+	int currentBank = 0;
+	int activeSlotIndex = 0;     // 通し番号
+	int pendingActiveSlot = -1;  // ロード完了を待ってアクティブにするスロット（通し番号）
+
+	// デッキの再生元。スロットを選ぶとそのサンプルを（コピーせず）直接再生し、
+	// null なら録音バッファを再生する。差し替えは recordLock 内で
+	std::shared_ptr<const DecodedSample> deckSample;
+	int deckSlotIndex = -1;   // デッキが再生中のスロット（通し番号。スロット以外なら -1）
+	juce::File deckReloadFile; // デバイスレート変更後、作り直しを待っているデッキのファイル
+	juce::File deckLoadFile;   // loadFileToBuffer でロード待ちのファイル（先頭部分の再生中も含む）
+	SampleRenderKernel deckKernel;
+	juce::AudioBuffer<float> deckMixBuffer; // prepareToPlay で確保（クロスフェーダーのランプを掛けてから足す）
+
+	// ユーザーが選んだエンジンの設定（ライブラリの保存形式など）。変更は少し遅れて自動保存
+	juce::File getSettingsFile() const;
+	juce::PropertiesFile settings { getSettingsFile(), juce::PropertiesFile::Options() };
+
+	// 録音のバックグラウンド圧縮
+	LibraryEncoder libraryEncoder;
+	void applyEncodedRecordings(); // WAV → 圧縮ファイルへ参照を付け替えて WAV を消す
+
+	// Segmentation / cue markers
+	VoiceSegmenter segmenter;
+	std::vector<VoiceSegmenter::Segment> cueMarkers;
+	juce::File deckSourceFile; // デッキに載っているファイル（録音直後は保存先）
+	int deckGeneration = 0;
+	int thumbnailGeneration = 0;
+	int cueRevision = 0;    // cueMarkers を書き換えるたびに
+	int slotsRevision = 0;  // スロットの割り当て・ロード状態を変えるたびに
+
+	// メーター（オーディオスレッドは FIFO へ書くだけ）
+	AudioMeter inputMeter;
+	AudioMeter outputMeter;
+
+	// UI 向けの状態。publishState で今の値を流す（変わったフィールドだけ届く）
+	EngineState state;
+	void publishState();
+
+	void deckContentChanged(const juce::File& sourceFile);
+	// スロット（通し番号）の管理
+	void requestSlotLoad(int index);  // 未ロードならバックグラウンドロードを依頼
+	void slotLoaded(int index);       // アクティブ化待ちなら差し替え
+	void activateSlot(int index);     // ロード済みのスロットをデッキへ
+	void applyLoadedSamples();
+	// デッキの内容（再生範囲）を float の dest へコピーし、サンプル数を返す
+	// スロットのサンプルはロック外で変換する（オーディオスレッドを待たせない）
+	// AudioBuffer に入る長さ (int) まで。それより長い素材は先頭から切り詰める
+	int copyDeckAudio(juce::AudioBuffer<float>& dest, double& sampleRate);
+	// 作り直したサンプルへデッキを差し替える（再生位置・キューは比率で換算）
+	void replaceDeckSample(std::shared_ptr<const DecodedSample> sample);
+	// ファイルのサンプルをデッキへ（先頭部分なら残りが届いたときに差し替える）
+	void showFileOnDeck(const juce::File& file, std::shared_ptr<const DecodedSample> sample);
+	void loadOrAnalyseCues(const juce::File& file);
+	void populateThumbnail(const DecodedSample& sample, juce::int64 numSamples);
+
+	// オーディオスレッド: デッキ（スクラッチ）とプレビューを順に出力へ足す
+	void renderDeck(const juce::AudioSourceChannelInfo& bufferToFill);
+	void mixPreview(const juce::AudioSourceChannelInfo& bufferToFill);
+
+	// 波形ピーク用内部ヘルパー（capacity = デッキに載る最大サンプル数、チャンネルはデッキの中身のまま）
+	void resetRecordedThumbnail(int numChannels, juce::int64 capacity);
+
+	// デバイスレートが変わったら、変換済みサンプルを裏で作り直す
+	void handleAsyncUpdate() override;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioEngine)
 };
@@ -0,0 +1,195 @@
+/*
+ ==============================================================================
+ AudioMeter.cpp
+ ==============================================================================
+ */
+#include "AudioMeter.h"
+
+namespace
+{
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+
+    // デバイスのバッファは SIMD 境界に揃っているとは限らないので、前後の半端は 1 つずつ
+    float sumOfSquares (const float* data, int num)
+    {
+        const auto* aligned = SIMDFloat::getNextSIMDAlignedPtr (const_cast<float*> (data));
+        const int head = juce::jmin (num, (int) (aligned - data));
+        const int body = (num - head) / (int) SIMDFloat::SIMDNumElements * (int) SIMDFloat::SIMDNumElements;
+
+        float sum = 0.0f;
+        for (int i = 0; i < head; ++i)
+            sum += data[i] * data[i];
+
+        auto acc = SIMDFloat::expand (0.0f);
+        for (int i = 0; i < body; i += (int) SIMDFloat::SIMDNumElements)
+        {
+            const auto v = SIMDFloat::fromRawArray (aligned + i);
+            acc += v * v;
+        }
+        sum += acc.sum();
+
+        for (int i = head + body; i < num; ++i)
+            sum += data[i] * data[i];
+
+        return sum;
+    }
+}
+
+AudioMeter::AudioMeter()
+    : samples ((size_t) sampleFifoSize, 0.0f),
+      history ((size_t) spectrumSize, 0.0f),
+      fftData ((size_t) spectrumSize * 2, 0.0f)
+{
+}
+
+AudioMeter::~AudioMeter()
+{
+    cancelPendingUpdate();
+}
+
+void AudioMeter::prepare (double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    pendingSample = 0.0f;
+    hasPendingSample = false;
+}
+
+// ── オーディオスレッド ──────────────────────────────────────────────────────
+void AudioMeter::push (const juce::AudioSourceChannelInfo& info)
+{
+    const auto& buffer = *info.buffer;
+    const int numChannels = juce::jmin (buffer.getNumChannels(), maxChannels);
+    const int numSamples = info.numSamples;
+    if (numChannels <= 0 || numSamples <= 0)
+        return;
+
+    // レベル: チャンネルごとに peak と二乗和の 2 つのリダクションだけ
+    BlockLevels block;
+    block.numChannels = numChannels;
+    block.numSamples = numSamples;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* data = buffer.getReadPointer (ch, info.startSample);
+        const auto range = juce::FloatVectorOperations::findMinAndMax (data, numSamples);
+        block.peak[(size_t) ch] = juce::jmax (-range.getStart(), range.getEnd());
+        block.sumOfSquares[(size_t) ch] = sumOfSquares (data, numSamples);
+    }
+
+    // 待ち受け中: 見える大きさならメッセージスレッドを起こす（一度だけ）。静かなら誰も読まないので積まない
+    if (waitingForAudio.load (std::memory_order_relaxed))
+    {
+        const float blockPeak = *std::max_element (block.peak.begin(), block.peak.begin() + numChannels);
+        if (blockPeak < audibleLevel)
+            return;
+
+        if (waitingForAudio.exchange (false))
+            triggerAsyncUpdate();
+    }
+
+    levelFifo.write (1).forEach ([this, &block] (int index) { levelBlocks[(size_t) index] = block; });
+
+    // スペクトラム: チャンネルの平均を 2 点ずつ平均して 1 点に（入らない分は捨てる）
+    const float channelGain = 0.5f / (float) numChannels;
+    const float* left = buffer.getReadPointer (0, info.startSample);
+    const float* right = buffer.getReadPointer (numChannels - 1, info.startSample);
+    const int numOut = (numSamples + (hasPendingSample ? 1 : 0)) / decimation;
+
+    int i = 0;
+    sampleFifo.write (numOut).forEach ([&] (int index)
+    {
+        float pair = 0.0f;
+
+        if (hasPendingSample)
+        {
+            pair = pendingSample;
+            hasPendingSample = false;
+        }
+        else
+        {
+            pair = (left[i] + (numChannels > 1 ? right[i] : 0.0f)) * channelGain;
+            ++i;
+        }
+
+        pair += (left[i] + (numChannels > 1 ? right[i] : 0.0f)) * channelGain;
+        ++i;
+        samples[(size_t) index] = pair;
+    });
+
+    // 一杯で書けなかった分は飛ばし、奇数で余った最後の 1 点は次のブロックへ
+    if ((numSamples - i) % decimation != 0)
+    {
+        const int last = numSamples - 1;
+        pendingSample = (left[last] + (numChannels > 1 ? right[last] : 0.0f)) * channelGain;
+        hasPendingSample = true;
+    }
+}
+
+// ── メッセージスレッド ──────────────────────────────────────────────────────
+void AudioMeter::notifyWhenAudible (std::function<void()> onAudible)
+{
+    audibleCallback = std::move (onAudible);
+    waitingForAudio = true;
+}
+
+void AudioMeter::cancelNotification()
+{
+    waitingForAudio = false;
+    cancelPendingUpdate();
+    audibleCallback = nullptr;
+}
+
+void AudioMeter::handleAsyncUpdate()
+{
+    if (auto callback = std::exchange (audibleCallback, nullptr))
+        callback();
+}
+
+AudioMeter::Levels AudioMeter::collect()
+{
+    Levels levels;
+    std::array<double, maxChannels> totalSquares {};
+
+    levelFifo.read (levelFifo.getNumReady()).forEach ([&] (int index)
+    {
+        const auto& block = levelBlocks[(size_t) index];
+        levels.numChannels = juce::jmax (levels.numChannels, block.numChannels);
+        levels.numSamples += block.numSamples;
+
+        for (int ch = 0; ch < block.numChannels; ++ch)
+        {
+            levels.peak[(size_t) ch] = juce::jmax (levels.peak[(size_t) ch], block.peak[(size_t) ch]);
+            totalSquares[(size_t) ch] += block.sumOfSquares[(size_t) ch];
+        }
+    });
+
+    if (levels.numSamples > 0)
+        for (int ch = 0; ch < levels.numChannels; ++ch)
+            levels.meanSquare[(size_t) ch] = (float) (totalSquares[(size_t) ch] / levels.numSamples);
+
+    sampleFifo.read (sampleFifo.getNumReady()).forEach ([&] (int index)
+    {
+        history[(size_t) historyPosition] = samples[(size_t) index];
+        historyPosition = (historyPosition + 1) % spectrumSize;
+        ++levels.numSpectrumSamples;
+    });
+
+    return levels;
+}
+
+void AudioMeter::computeSpectrum (float* magnitudesDb, float floorDb)
+{
+    // リングを古い順に並べ直してから窓を掛ける
+    std::copy (history.begin() + historyPosition, history.end(), fftData.begin());
+    std::copy (history.begin(), history.begin() + historyPosition, fftData.begin() + (spectrumSize - historyPosition));
+    std::fill (fftData.begin() + spectrumSize, fftData.end(), 0.0f);
+
+    window.multiplyWithWindowingTable (fftData.data(), (size_t) spectrumSize);
+    fft.performFrequencyOnlyForwardTransform (fftData.data(), true);
+
+    // 振幅 A の正弦波 → A * N / 2 * (Hann の平均 0.5)
+    const float normalise = 4.0f / (float) spectrumSize;
+
+    for (int bin = 0; bin < numSpectrumBins; ++bin)
+        magnitudesDb[bin] = juce::Decibels::gainToDecibels (fftData[(size_t) bin] * normalise, floorDb);
+}
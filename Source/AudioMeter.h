@@ -0,0 +1,101 @@
+/*
+ ==============================================================================
+ AudioMeter.h
+ ==============================================================================
+ 入力・出力のレベルメーターとスペクトラムの元データ（1 つのタップぶん）。
+
+ • オーディオスレッド（push）はブロックごとに
+     チャンネルごとの peak（findMinAndMax）と二乗和（SIMD）→ レベルの FIFO へ 1 件
+     チャンネルを混ぜて 1/2 に間引いたモノラル → サンプルの FIFO へ
+   だけを行う。確保・ロック・FFT は無い。FIFO が一杯なら捨てる（表示が欠けるだけ）
+ • FIFO は juce::AbstractFifo（書き手はオーディオスレッド 1 本、読み手はメッセージスレッド 1 本）
+ • 読み手（collect）は届いた分をまとめて読み、サンプルは直近 spectrumSize 点の履歴に足す
+   FFT（computeSpectrum）・バリスティクス・描画はメッセージスレッドで（LevelMeterComponent）
+ • 表示が止まっている間は notifyWhenAudible で待ち受ける。見える大きさ（audibleLevel）の
+   ブロックが来たらオーディオスレッドは AsyncUpdater を叩くだけで、メッセージスレッドが起きる
+   （ポーリングしない。待ち受け中の静かなブロックは誰も読まないので FIFO にも積まない）
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+class AudioMeter : private juce::AsyncUpdater
+{
+public:
+    static constexpr int maxChannels = 2;
+    static constexpr int spectrumOrder = 10;                  // 1024 点
+    static constexpr int spectrumSize = 1 << spectrumOrder;
+    static constexpr int numSpectrumBins = spectrumSize / 2;
+    static constexpr int decimation = 2;                      // 表示用なので 2 点平均で間引くだけ
+    static constexpr float audibleLevel = 0.001f;             // -60 dBFS（メーターの左端）。これより小さい音では起こさない
+
+    // 前回の collect から届いたブロックのまとめ
+    struct Levels
+    {
+        std::array<float, maxChannels> peak {};       // 絶対値の最大
+        std::array<float, maxChannels> meanSquare {}; // 二乗平均（RMS の 2 乗）
+        int numChannels = 0;
+        int numSamples = 0;          // 0 = 新しいブロックは無い
+        int numSpectrumSamples = 0;  // 履歴に足した間引き後のサンプル数
+    };
+
+    AudioMeter();
+    ~AudioMeter() override;
+
+    // デバイスを開いたとき（コールバックが止まっている間に呼ばれる）
+    void prepare (double sampleRate);
+
+    // オーディオスレッド: info の範囲を測って FIFO へ
+    void push (const juce::AudioSourceChannelInfo& info);
+
+    // 以下はメッセージスレッド専用（読み手は 1 つ）
+    Levels collect();
+
+    // 直近 spectrumSize 点（Hann）の振幅を dBFS で numSpectrumBins 個。正弦波の振幅 1 が 0 dB
+    void computeSpectrum (float* magnitudesDb, float floorDb);
+
+    double getSampleRate() const { return sampleRate.load(); }
+    double getSpectrumSampleRate() const { return getSampleRate() / decimation; }
+
+    // 次に audibleLevel 以上のブロックが届いたら一度だけ onAudible を呼ぶ（メッセージスレッドで）
+    void notifyWhenAudible (std::function<void()> onAudible);
+    void cancelNotification();
+
+private:
+    void handleAsyncUpdate() override;
+
+    struct BlockLevels
+    {
+        std::array<float, maxChannels> peak {}, sumOfSquares {};
+        int numChannels = 0;
+        int numSamples = 0;
+    };
+
+    static constexpr int levelFifoSize = 256;     // ブロック数（UI が 1 秒止まっても溢れない）
+    static constexpr int sampleFifoSize = 16384;  // 間引き後のサンプル数
+
+    std::atomic<double> sampleRate { 44100.0 };
+
+    juce::AbstractFifo levelFifo { levelFifoSize };
+    std::array<BlockLevels, levelFifoSize> levelBlocks;
+
+    juce::AbstractFifo sampleFifo { sampleFifoSize };
+    std::vector<float> samples;
+
+    // 待ち受け中か（メッセージスレッドが立て、音が来たらオーディオスレッドが下ろす）
+    std::atomic<bool> waitingForAudio { false };
+    std::function<void()> audibleCallback; // メッセージスレッドだけが触る
+
+    // オーディオスレッドだけが触る: 間引きの 2 点のうち前のブロックに残った 1 点
+    float pendingSample = 0.0f;
+    bool hasPendingSample = false;
+
+    // メッセージスレッドだけが触る: 間引き後の直近 spectrumSize 点（リング）と FFT の作業領域
+    std::vector<float> history;
+    int historyPosition = 0;
+    juce::dsp::FFT fft { spectrumOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) spectrumSize, juce::dsp::WindowingFunction<float>::hann, false };
+    std::vector<float> fftData;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioMeter)
+};
@@ -0,0 +1,139 @@
+/*
+ ==============================================================================
+ ChunkedDecoder.cpp
+ ==============================================================================
+ */
+#include "ChunkedDecoder.h"
+
+bool ChunkedDecoder::supportsExactSeeking (const juce::AudioFormat& format)
+{
+    if (dynamic_cast<const juce::WavAudioFormat*> (&format) != nullptr
+        || dynamic_cast<const juce::AiffAudioFormat*> (&format) != nullptr)
+        return true;
+
+   #if JUCE_USE_FLAC
+    if (dynamic_cast<const juce::FlacAudioFormat*> (&format) != nullptr)
+        return true;
+   #endif
+
+   #if JUCE_USE_OGGVORBIS
+    // ov_pcm_seek はサンプル単位で正確
+    if (dynamic_cast<const juce::OggVorbisAudioFormat*> (&format) != nullptr)
+        return true;
+   #endif
+
+    return false;
+}
+
+bool ChunkedDecoder::decode (juce::AudioFormatManager& formatManager, const juce::File& sourceFile,
+                             juce::AudioFormatReader& reader, float* const* dest, int numChannels,
+                             juce::int64 startSample, juce::int64 length, juce::ThreadPool& pool, const ProgressCallback& onProgress)
+{
+    if (length <= 0)
+        return true;
+
+    const int chunkLength = juce::jmax (minChunkSamples, (int) (reader.sampleRate * chunkSeconds));
+    const int numChunks = (int) ((length + chunkLength - 1) / chunkLength);
+
+    enum ChunkStatus { pending, done, failed };
+
+    // ジョブが呼び出し後に終わっても触るのはこの共有状態と自分のリーダーだけ
+    struct Progress
+    {
+        explicit Progress (int numChunks) : status ((size_t) numChunks) {}
+
+        std::atomic<int> nextChunk { 0 };
+        std::atomic<int> workersLeft { 0 };
+        std::vector<std::atomic<int>> status;
+        juce::WaitableEvent chunkFinished;
+    };
+
+    auto progress = std::make_shared<Progress> (numChunks);
+    const std::vector<float*> channels (dest, dest + numChannels);
+
+    // チャンクを 1 つ取ってデコードする。取れるものが無ければ false
+    auto decodeNextChunk = [progress, channels, startSample, length, chunkLength, numChunks] (juce::AudioFormatReader& source)
+    {
+        const int chunk = progress->nextChunk++;
+        if (chunk >= numChunks)
+            return false;
+
+        const auto start = (juce::int64) chunk * chunkLength;
+        const int num = (int) juce::jmin ((juce::int64) chunkLength, length - start);
+
+        std::vector<float*> chunkChannels (channels);
+        for (auto*& ch : chunkChannels)
+            ch += start;
+
+        const bool ok = source.read (chunkChannels.data(), (int) chunkChannels.size(), startSample + start, num);
+        progress->status[(size_t) chunk] = ok ? done : failed;
+        progress->chunkFinished.signal();
+        return ok;
+    };
+
+    // ── 並列: ワーカーごとに自分のリーダーを持つ（リーダーはスレッドセーフではない） ──
+    auto* format = formatManager.findFormatForFileExtension (sourceFile.getFileExtension());
+
+    if (numChunks > 1 && format != nullptr && format->getFormatName() == reader.getFormatName()
+        && supportsExactSeeking (*format))
+    {
+        const int numWorkers = juce::jmin (pool.getNumThreads(), numChunks);
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            // リーダーは呼び出しスレッドで作る（ジョブが formatManager より長生きしても良いように）
+            std::shared_ptr<juce::AudioFormatReader> workerReader (
+                format->createReaderFor (sourceFile.createInputStream().release(), true));
+            if (workerReader == nullptr)
+                break;
+
+            ++progress->workersLeft;
+            pool.addJob ([progress, decodeNextChunk, workerReader]
+            {
+                while (decodeNextChunk (*workerReader))
+                {
+                }
+
+                --progress->workersLeft;
+                progress->chunkFinished.signal();
+            });
+        }
+    }
+
+    // ── 先頭から揃った範囲を知らせる。ワーカーがいなければ自分で順番に読む ──
+    int prefixChunks = 0;
+    bool ok = true;
+
+    while (prefixChunks < numChunks)
+    {
+        if (progress->workersLeft.load() == 0)
+            decodeNextChunk (reader);
+        else
+            progress->chunkFinished.wait (100);
+
+        const int before = prefixChunks;
+        while (prefixChunks < numChunks && progress->status[(size_t) prefixChunks].load() == done)
+            ++prefixChunks;
+
+        if (prefixChunks < numChunks && progress->status[(size_t) prefixChunks].load() == failed)
+        {
+            ok = false;
+            break;
+        }
+
+        if (prefixChunks != before && onProgress)
+            onProgress (juce::jmin (length, (juce::int64) prefixChunks * chunkLength));
+    }
+
+    if (! ok)
+    {
+        // 残りは取らせない。取られたチャンクが dest を書き終えるまで待つ
+        const int claimed = juce::jmin (numChunks, progress->nextChunk.exchange (numChunks));
+
+        for (int i = 0; i < claimed; ++i)
+            while (progress->status[(size_t) i].load() == pending)
+                progress->chunkFinished.wait (100);
+    }
+
+    return ok;
+}
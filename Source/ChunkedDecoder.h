@@ -0,0 +1,39 @@
+/*
+ ==============================================================================
+ ChunkedDecoder.h
+ ==============================================================================
+ 長い圧縮ファイルの並列デコード。
+
+ • ファイルを固定長のチャンクに分け、スレッドプールのジョブが先頭から順に
+   チャンクを取って自分のリーダーでデコードする（出力バッファの担当範囲は重ならない）
+ • 並列にするのはサンプル単位で正確にシークできる形式だけ
+   （WAV / AIFF / FLAC / Ogg Vorbis）。継ぎ目で 1 サンプルもずれない
+   それ以外（MP3 などフレーム単位のシーク）は 1 本のリーダーで順番に読む
+ • 先頭から連続してデコードが済んだ範囲を呼び出しスレッドへ逐次知らせる
+   → 後ろがデコード中でも先頭だけで再生を始められる
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+class ChunkedDecoder
+{
+public:
+    // 先頭から連続して揃ったサンプル数が増えるたびに呼ばれる（呼び出しスレッドで）
+    using ProgressCallback = std::function<void (juce::int64 decodedPrefix)>;
+
+    // reader が開いている sourceFile の [startSample, startSample + length) を dest（numChannels 本）へデコードする
+    // 数時間の素材でも扱えるよう長さは 64bit（AudioBuffer は int なので生のポインタで受ける）
+    // decodedPrefix は startSample からの長さ。reader は順番読みの場合に使う。戻るまで他から触らないこと
+    static bool decode (juce::AudioFormatManager& formatManager, const juce::File& sourceFile,
+                        juce::AudioFormatReader& reader, float* const* dest, int numChannels,
+                        juce::int64 startSample, juce::int64 length,
+                        juce::ThreadPool& pool, const ProgressCallback& onProgress);
+
+    // チャンクに分けて並列に読める（シークがサンプル単位で正確な）形式か
+    static bool supportsExactSeeking (const juce::AudioFormat& format);
+
+private:
+    static constexpr double chunkSeconds = 4.0;
+    static constexpr int minChunkSamples = 65536;
+};
@@ -0,0 +1,464 @@
+/*
+ ==============================================================================
+ DecodedSampleCache.cpp
+ ==============================================================================
+ File layout (little endian)
+ ---------------------------
+   [0, 4096)            ヘッダー: magic, version, numChannels, numSamples,
+                        sampleRate, channelStride, format（残りはゼロ埋め）
+   4096 + c * stride    チャンネル c の float32 / int16 × numSamples（ページ境界から）
+
+ version 2 までのファイルは旧来の補間で変換したものなので作り直す。
+ ==============================================================================
+ */
+#include "DecodedSampleCache.h"
+#include "SampleRenderKernel.h"
+#include "PolyphaseResampler.h"
+#include "ChunkedDecoder.h"
+
+namespace
+{
+    constexpr int cacheMagic = 0x43504d53; // "SMPC"
+    constexpr int cacheVersion = 3;
+    constexpr juce::int64 pageSize = 4096;
+    constexpr juce::int64 headerSize = pageSize;
+    const char* const cacheExtension = ".pcm";
+
+    juce::int64 roundUpToPage (juce::int64 bytes)
+    {
+        return (bytes + pageSize - 1) / pageSize * pageSize;
+    }
+
+    // FNV-1a 64bit（暗号学的強度は不要。中身が同じなら同じキーになれば良い）
+    juce::uint64 hashFileContent (const juce::File& file)
+    {
+        juce::uint64 hash = 14695981039346656037ull;
+        juce::FileInputStream in (file);
+        if (! in.openedOk())
+            return 0;
+
+        juce::HeapBlock<juce::uint8> chunk (65536);
+        for (;;)
+        {
+            const int n = in.read (chunk.get(), 65536);
+            if (n <= 0)
+                break;
+
+            for (int i = 0; i < n; ++i)
+            {
+                hash ^= chunk[i];
+                hash *= 1099511628211ull;
+            }
+        }
+
+        return hash;
+    }
+}
+
+std::shared_ptr<DecodedSample> DecodedSample::allocate (int numChannels, juce::int64 numSamples, double sampleRate, Format format)
+{
+    auto sample = std::make_shared<DecodedSample>();
+    sample->numSamples = numSamples;
+    sample->sampleRate = sampleRate;
+    sample->format = format;
+
+    // チャンネルごとに連続（キャッシュファイルと同じ並び）
+    const size_t channelBytes = (size_t) numSamples * sample->getBytesPerSample();
+    sample->ownedBytes = channelBytes * (size_t) numChannels;
+    sample->ownedData.malloc (juce::jmax ((size_t) 1, sample->ownedBytes));
+    if (sample->ownedData == nullptr)
+        return nullptr;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        sample->channels.push_back (sample->ownedData.get() + channelBytes * (size_t) ch);
+
+    return sample;
+}
+
+void DecodedSample::writeSamples (int channel, juce::int64 startSample, const float* source, int num)
+{
+    jassert (mapping == nullptr && startSample >= 0 && startSample + num <= numSamples);
+    auto* dest = const_cast<void*> (channels[(size_t) channel]);
+
+    if (format == Format::int16)
+        SampleRenderKernel::convertFloatToInt16 (source, static_cast<juce::int16*> (dest) + startSample, num);
+    else
+        std::memcpy (static_cast<float*> (dest) + startSample, source, (size_t) num * sizeof (float));
+}
+
+std::shared_ptr<const DecodedSample> DecodedSample::fromBuffer (juce::AudioBuffer<float>&& data, double sampleRate,
+                                                               Format format)
+{
+    auto sample = allocate (data.getNumChannels(), data.getNumSamples(), sampleRate, format);
+    if (sample == nullptr)
+        return nullptr;
+
+    for (int ch = 0; ch < data.getNumChannels(); ++ch)
+        sample->writeSamples (ch, 0, data.getReadPointer (ch), data.getNumSamples());
+
+    sample->publish (sample->numSamples);
+    data.setSize (0, 0);
+    return sample;
+}
+
+void DecodedSample::readSamples (int channel, juce::int64 startSample, int num, float* dest) const
+{
+    jassert (startSample >= 0 && startSample + num <= numSamples);
+
+    if (format == Format::int16)
+        SampleRenderKernel::convertInt16ToFloat (getInt16ReadPointer (channel) + startSample, dest, num);
+    else
+        std::memcpy (dest, getReadPointer (channel) + startSample, (size_t) num * sizeof (float));
+}
+
+DecodedSampleCache::DecodedSampleCache (const juce::File& cacheFolderToUse, juce::int64 sizeLimitBytes)
+    : juce::Thread ("DecodedSampleCache janitor"),
+      cacheFolder (cacheFolderToUse),
+      sizeLimit (sizeLimitBytes)
+{
+    cacheFolder.createDirectory();
+    startThread (juce::Thread::Priority::background);
+}
+
+DecodedSampleCache::~DecodedSampleCache()
+{
+    stopThread (4000);
+    resamplePool.removeAllJobs (true, 4000);
+}
+
+void DecodedSampleCache::setSizeLimit (juce::int64 bytes)
+{
+    sizeLimit = bytes;
+    notify();
+}
+
+juce::String DecodedSampleCache::getKeyFor (const juce::File& sourceFile, double targetSampleRate,
+                                           DecodedSample::Format format)
+{
+    const auto path = sourceFile.getFullPathName();
+    const auto fileSize = sourceFile.getSize();
+    const auto modTime = sourceFile.getLastModificationTime().toMilliseconds();
+
+    juce::uint64 contentHash = 0;
+    {
+        const juce::ScopedLock sl (memoLock);
+        auto it = hashMemo.find (path);
+        if (it != hashMemo.end() && it->second.fileSize == fileSize && it->second.modTime == modTime)
+            contentHash = it->second.contentHash;
+    }
+
+    if (contentHash == 0)
+    {
+        contentHash = hashFileContent (sourceFile);
+        if (contentHash == 0)
+            return {};
+
+        const juce::ScopedLock sl (memoLock);
+        hashMemo[path] = { fileSize, modTime, contentHash };
+    }
+
+    return juce::String::toHexString ((juce::int64) contentHash) + "_" + juce::String (fileSize)
+         + "_" + juce::String (juce::roundToInt (targetSampleRate))
+         + (format == DecodedSample::Format::int16 ? "_i16" : "");
+}
+
+juce::File DecodedSampleCache::getCacheFileFor (const juce::String& key) const
+{
+    return cacheFolder.getChildFile (key + cacheExtension);
+}
+
+bool DecodedSampleCache::contains (const juce::File& sourceFile, double targetSampleRate,
+                                   DecodedSample::Format format)
+{
+    const auto key = getKeyFor (sourceFile, targetSampleRate, format);
+    return key.isNotEmpty() && getCacheFileFor (key).existsAsFile();
+}
+
+std::shared_ptr<const DecodedSample> DecodedSampleCache::open (juce::AudioFormatManager& formatManager,
+                                                               const juce::File& sourceFile, double targetSampleRate,
+                                                               DecodedSample::Format format, const PrefixCallback& onPrefix)
+{
+    const auto key = getKeyFor (sourceFile, targetSampleRate, format);
+    if (key.isEmpty() || targetSampleRate <= 0.0)
+        return nullptr;
+
+    const auto cacheFile = getCacheFileFor (key);
+
+    // ── ヒット: マップするだけ ─────────────────────────────────────────────
+    if (auto mapped = mapCacheFile (cacheFile))
+    {
+        cacheFile.setLastModificationTime (juce::Time::getCurrentTime()); // LRU の目印
+        return mapped;
+    }
+
+    // ── ミス: デコード → レート変換 → 保存 → マップ ─────────────────────
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (sourceFile));
+    if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0)
+        return nullptr;
+
+    const int numChannels = juce::jlimit (1, 2, (int) reader->numChannels);
+    const juce::int64 sourceLength = reader->lengthInSamples;
+
+    const double ratio = reader->sampleRate / targetSampleRate;
+    const bool sameRate = std::abs (ratio - 1.0) < 1.0e-9;
+    const juce::int64 outLength = sameRate ? sourceLength
+                                           : juce::jmax ((juce::int64) 1, (juce::int64) std::floor ((double) sourceLength / ratio));
+
+    // 変換・量子化しながら先頭から埋めていく（揃った分だけ publish）
+    // 返すサンプルは全体を持つ。数時間の素材でメモリが足りなければ諦める
+    auto sample = DecodedSample::allocate (numChannels, outLength, targetSampleRate, format);
+    juce::HeapBlock<float> section (sectionSize);
+    if (sample == nullptr || section == nullptr)
+        return nullptr;
+
+    // デコード先は入力の [windowStart, windowStart + decodeWindowSize) だけを持つ窓
+    // （チャンネルごとに連続。変換に使い終わった先頭は捨て、残りを前へ詰めて続きをデコードする）
+    const auto windowSize = juce::jmin (sourceLength, (juce::int64) decodeWindowSize);
+    juce::HeapBlock<float> windowData ((size_t) numChannels * (size_t) windowSize);
+    if (windowData == nullptr)
+        return nullptr;
+
+    float* window[2] = { windowData.get(), windowData.get() + (numChannels > 1 ? windowSize : 0) };
+    juce::int64 windowStart = 0;  // window[ch][0] の入力位置
+    juce::int64 decodedEnd = 0;   // 入力はここまで窓に揃っている
+    juce::int64 converted = 0;
+    bool prefixSent = false;
+
+    auto convertAvailable = [&] (juce::int64 available)
+    {
+        const auto end = available >= sourceLength ? outLength
+                       : sameRate ? available
+                                  : juce::jmin (outLength, PolyphaseResampler::getNumOutputSamplesAvailable (available, ratio));
+
+        // 一度に変換・量子化する長さは sectionSize まで（作業バッファを素材の長さに比例させない）
+        while (converted < end)
+        {
+            const int num = (int) juce::jmin ((juce::int64) sectionSize, end - converted);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                if (sameRate)
+                {
+                    sample->writeSamples (ch, converted, window[ch] + (converted - windowStart), num);
+                }
+                else
+                {
+                    PolyphaseResampler::processSection (window[ch], windowStart, sourceLength, ratio,
+                                                        converted, section.get(), num, &resamplePool);
+                    sample->writeSamples (ch, converted, section.get(), num);
+                }
+            }
+
+            converted += num;
+        }
+
+        sample->publish (converted);
+
+        // 再生を始められる長さになったら一度だけ先に渡す（全部揃ったものは普通に返す）
+        if (onPrefix && ! prefixSent && converted < outLength && converted >= (juce::int64) (minPrefixSeconds * targetSampleRate))
+        {
+            prefixSent = true;
+            onPrefix (sample);
+        }
+    };
+
+    while (decodedEnd < sourceLength)
+    {
+        // 次の出力が読む入力より前を捨てる（フィルターの幅の分だけ次の窓へ持ち越す）
+        const auto keepFrom = juce::jlimit (windowStart, decodedEnd,
+                                            sameRate ? converted : PolyphaseResampler::getFirstInputSampleNeeded (converted, ratio));
+
+        if (keepFrom > windowStart)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::memmove (window[ch], window[ch] + (keepFrom - windowStart), (size_t) (decodedEnd - keepFrom) * sizeof (float));
+
+            windowStart = keepFrom;
+        }
+
+        const auto decodeStart = decodedEnd;
+        const auto num = juce::jmin (windowStart + windowSize, sourceLength) - decodeStart;
+        jassert (num > 0);
+
+        float* dest[2] = { window[0] + (decodeStart - windowStart), window[1] + (decodeStart - windowStart) };
+
+        if (! ChunkedDecoder::decode (formatManager, sourceFile, *reader, dest, numChannels, decodeStart, num, resamplePool,
+                                      [&] (juce::int64 decodedPrefix)
+                                      {
+                                          decodedEnd = decodeStart + decodedPrefix;
+                                          convertAvailable (decodedEnd);
+                                      }))
+            return nullptr;
+
+        decodedEnd = decodeStart + num;
+    }
+
+    convertAvailable (sourceLength);
+    windowData.free();
+    section.free();
+
+    if (writeCacheFile (cacheFile, *sample))
+    {
+        notify(); // 上限チェック
+
+        if (auto mapped = mapCacheFile (cacheFile))
+            return mapped;
+    }
+
+    // キャッシュに書けなくても（ディスク不足など）メモリ上のコピーで使える
+    return sample;
+}
+
+std::shared_ptr<const DecodedSample> DecodedSampleCache::resample (const DecodedSample& sample, double targetSampleRate)
+{
+    const double ratio = sample.getSampleRate() / targetSampleRate;
+    const int numChannels = sample.getNumChannels();
+    // ファイルを持たないサンプル（キュー区間の切り出し）は AudioBuffer から作ったもの
+    jassert (sample.getNumSamples() <= std::numeric_limits<int>::max());
+    const int sourceLength = (int) sample.getNumSamples();
+    const int outLength = juce::jmax (1, (int) std::floor ((double) sourceLength / ratio));
+
+    // int16 の場合も一度 float に戻して変換し、同じ形式で持ち直す
+    juce::AudioBuffer<float> source (numChannels, sourceLength);
+    for (int ch = 0; ch < numChannels; ++ch)
+        sample.readSamples (ch, 0, sourceLength, source.getWritePointer (ch));
+
+    juce::AudioBuffer<float> converted (numChannels, outLength);
+    for (int ch = 0; ch < numChannels; ++ch)
+        PolyphaseResampler::process (source.getReadPointer (ch), sourceLength, converted.getWritePointer (ch),
+                                     outLength, ratio, &resamplePool);
+
+    return DecodedSample::fromBuffer (std::move (converted), targetSampleRate, sample.getFormat());
+}
+
+std::shared_ptr<DecodedSample> DecodedSampleCache::mapCacheFile (const juce::File& cacheFile)
+{
+    if (! cacheFile.existsAsFile())
+        return nullptr;
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile> (cacheFile, juce::MemoryMappedFile::readOnly);
+    if (mapping->getData() == nullptr || (juce::int64) mapping->getSize() < headerSize)
+        return nullptr;
+
+    juce::MemoryInputStream header (mapping->getData(), (size_t) headerSize, false);
+    if (header.readInt() != cacheMagic)
+        return nullptr;
+
+    if (header.readInt() != cacheVersion)
+        return nullptr;
+
+    const int numChannels = header.readInt();
+    const auto numSamples = header.readInt64();
+    const double sampleRate = header.readDouble();
+    const auto channelStride = header.readInt64();
+    const int formatCode = header.readInt();
+
+    if (formatCode != 0 && formatCode != 1)
+        return nullptr;
+
+    auto sample = std::make_shared<DecodedSample>();
+    sample->format = formatCode == 1 ? DecodedSample::Format::int16 : DecodedSample::Format::float32;
+
+    if (numChannels < 1 || numChannels > 2 || numSamples <= 0
+        || channelStride < numSamples * (juce::int64) sample->getBytesPerSample()
+        || (juce::int64) mapping->getSize() < headerSize + channelStride * numChannels)
+        return nullptr;
+
+    sample->numSamples = numSamples;
+    sample->availableSamples = numSamples;
+    sample->sampleRate = sampleRate;
+
+    auto* base = static_cast<const char*> (mapping->getData());
+    for (int ch = 0; ch < numChannels; ++ch)
+        sample->channels.push_back (base + headerSize + channelStride * ch);
+
+    sample->mapping = std::move (mapping);
+    return sample;
+}
+
+bool DecodedSampleCache::writeCacheFile (const juce::File& cacheFile, const DecodedSample& data)
+{
+    const auto numSamples = (juce::int64) data.getNumSamples();
+    const auto channelBytes = numSamples * (juce::int64) data.getBytesPerSample();
+    const auto channelStride = roundUpToPage (channelBytes);
+
+    // 一時ファイルに書いてから置き換える（途中のファイルをマップしない）
+    juce::TemporaryFile temp (cacheFile);
+
+    {
+        juce::FileOutputStream out (temp.getFile());
+        if (! out.openedOk())
+            return false;
+
+        out.writeInt (cacheMagic);
+        out.writeInt (cacheVersion);
+        out.writeInt (data.getNumChannels());
+        out.writeInt64 (numSamples);
+        out.writeDouble (data.getSampleRate());
+        out.writeInt64 (channelStride);
+        out.writeInt (data.getFormat() == DecodedSample::Format::int16 ? 1 : 0);
+        out.writeRepeatedByte (0, (size_t) (headerSize - out.getPosition()));
+
+        for (int ch = 0; ch < data.getNumChannels(); ++ch)
+        {
+            // リトルエンディアン前提でそのまま書く（読む側もそのままマップする）
+            out.write (data.channels[(size_t) ch], (size_t) channelBytes);
+            out.writeRepeatedByte (0, (size_t) (channelStride - channelBytes));
+        }
+
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+// ── Janitor ──────────────────────────────────────────────────────────────────
+
+void DecodedSampleCache::run()
+{
+    while (! threadShouldExit())
+    {
+        enforceSizeLimit();
+        wait (janitorIntervalMs);
+    }
+}
+
+void DecodedSampleCache::enforceSizeLimit()
+{
+    struct CachedFile
+    {
+        juce::File file;
+        juce::int64 size;
+        juce::int64 lastUsed;
+    };
+
+    std::vector<CachedFile> files;
+    juce::int64 total = 0;
+
+    for (const auto& entry : juce::RangedDirectoryIterator (cacheFolder, false, juce::String ("*") + cacheExtension))
+    {
+        if (threadShouldExit())
+            return;
+
+        files.push_back ({ entry.getFile(), entry.getFileSize(), entry.getModificationTime().toMilliseconds() });
+        total += entry.getFileSize();
+    }
+
+    const auto limit = sizeLimit.load();
+    if (total <= limit)
+        return;
+
+    // 古く使われたものから削除（マップ中で消せないファイルは飛ばす）
+    std::sort (files.begin(), files.end(), [] (const CachedFile& a, const CachedFile& b) { return a.lastUsed < b.lastUsed; });
+
+    for (const auto& f : files)
+    {
+        if (total <= limit || threadShouldExit())
+            break;
+
+        if (f.file.deleteFile())
+            total -= f.size;
+    }
+}
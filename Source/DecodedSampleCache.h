@@ -0,0 +1,157 @@
+/*
+ ==============================================================================
+ DecodedSampleCache.h
+ ==============================================================================
+ デコード済み PCM のディスクキャッシュ（スロットへの即時ロード用）。
+
+ • キー = 元ファイルの内容ハッシュ + 変換先サンプルレート
+ • レート変換はポリフェーズ（帯域制限）リサンプラーをスレッドプールで並列に
+   （リネーム・コピーしてもヒットし、中身が変われば別キー）
+ • 中身はデバイスレートに変換済みの 32bit float（またはコンパクト形式の
+   16bit 整数）、チャンネルごとに連続
+   ヘッダーと各チャンネルの先頭はページ境界 (4096) に揃えてあり、
+   メモリマップしたままオーディオスレッドから読める
+ • ヒット時はマップするだけ（デコード・コピー無し）
+ • ミス時は長いファイルをチャンクに分けて並列にデコードし (ChunkedDecoder)、
+   先頭が揃い次第「再生できる先頭部分」をメモリ上のサンプルとして先に渡す
+   （getAvailableSamples が後ろへ伸びていく。全部揃ったらマップ版に差し替える）
+   デコードは一定長の窓ごとに進め、変換し終えた入力は捨てる（素材全体の float は持たない）
+ • 用済みのファイルはバックグラウンドの janitor がサイズ上限まで削除
+   （最近使ったものを残す。使用時に更新日時を進めて LRU の目印にする）
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+// デコード済みサンプル（マップしたキャッシュファイル、または書けなかった場合のメモリ上のコピー）
+class DecodedSample
+{
+public:
+    // 保存形式。int16 はメモリ・キャッシュ占有が半分（再生時に float へ変換）
+    enum class Format
+    {
+        float32,
+        int16
+    };
+
+    // メモリ上のバッファから作る（キュー区間の切り出しなどキャッシュを通らないもの）
+    // 確保できなければ nullptr
+    static std::shared_ptr<const DecodedSample> fromBuffer (juce::AudioBuffer<float>&& data, double sampleRate,
+                                                            Format format = Format::float32);
+
+    int getNumChannels() const     { return static_cast<int> (channels.size()); }
+    juce::int64 getNumSamples() const { return numSamples; } // 数時間の素材も扱えるよう 64bit
+
+    // 読んで良いサンプル数。デコード途中のサンプルでは先頭からここまで（どのスレッドからでも可）
+    juce::int64 getAvailableSamples() const { return availableSamples.load (std::memory_order_acquire); }
+    bool isComplete() const         { return getAvailableSamples() >= numSamples; }
+
+    double getSampleRate() const   { return sampleRate; }
+    Format getFormat() const       { return format; }
+    size_t getBytesPerSample() const { return format == Format::int16 ? sizeof (juce::int16) : sizeof (float); }
+
+    // 形式ごとの生データ（オーディオスレッドの描画カーネル用）
+    const float* getReadPointer (int channel) const
+    {
+        jassert (format == Format::float32);
+        return static_cast<const float*> (channels[static_cast<size_t> (channel)]);
+    }
+
+    const juce::int16* getInt16ReadPointer (int channel) const
+    {
+        jassert (format == Format::int16);
+        return static_cast<const juce::int16*> (channels[static_cast<size_t> (channel)]);
+    }
+
+    // 形式によらず float で読み出す（サムネイル・解析・保存用）
+    void readSamples (int channel, juce::int64 startSample, int num, float* dest) const;
+
+    // 実際に確保しているメモリ（マップ分は OS が必要に応じて読み込む）
+    size_t getResidentBytes() const { return ownedBytes; }
+    bool isMapped() const { return mapping != nullptr; }
+
+private:
+    friend class DecodedSampleCache;
+
+    // メモリ上に確保（中身は未定義、available = 0）。確保できなければ nullptr
+    static std::shared_ptr<DecodedSample> allocate (int numChannels, juce::int64 numSamples, double sampleRate, Format format);
+    // float を保存形式へ変換して書く（publish するまで読み手からは見えない）
+    void writeSamples (int channel, juce::int64 startSample, const float* source, int num);
+    void publish (juce::int64 numAvailable) { availableSamples.store (numAvailable, std::memory_order_release); }
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    juce::HeapBlock<char> ownedData;
+    size_t ownedBytes = 0;
+    std::vector<const void*> channels;
+    juce::int64 numSamples = 0;
+    std::atomic<juce::int64> availableSamples { 0 };
+    double sampleRate = 0.0;
+    Format format = Format::float32;
+};
+
+class DecodedSampleCache : private juce::Thread
+{
+public:
+    explicit DecodedSampleCache (const juce::File& cacheFolderToUse,
+                                 juce::int64 sizeLimitBytes = 1024ll * 1024 * 1024);
+    ~DecodedSampleCache() override;
+
+    // デコード途中の先頭部分を受け取る（open の呼び出しスレッドで、最大 1 回）
+    using PrefixCallback = std::function<void (std::shared_ptr<const DecodedSample>)>;
+
+    // キャッシュから開く。無ければデコード → targetSampleRate へ変換 → 保存してから開く
+    // 失敗時は nullptr。onPrefix があれば、長いファイルは先頭が揃った時点で途中のサンプルを渡す
+    std::shared_ptr<const DecodedSample> open (juce::AudioFormatManager& formatManager,
+                                               const juce::File& sourceFile, double targetSampleRate,
+                                               DecodedSample::Format format = DecodedSample::Format::float32,
+                                               const PrefixCallback& onPrefix = {});
+
+    // メモリ上のサンプルを targetSampleRate へ変換した複製を作る（ファイルを持たないもの用）
+    std::shared_ptr<const DecodedSample> resample (const DecodedSample& sample, double targetSampleRate);
+
+    // キャッシュにあるか（デコード無しで開けるか）
+    bool contains (const juce::File& sourceFile, double targetSampleRate,
+                   DecodedSample::Format format = DecodedSample::Format::float32);
+
+    void setSizeLimit (juce::int64 bytes);
+    juce::int64 getSizeLimit() const { return sizeLimit.load(); }
+
+    const juce::File& getFolder() const { return cacheFolder; }
+
+private:
+    void run() override; // janitor
+    void enforceSizeLimit();
+
+    juce::String getKeyFor (const juce::File& sourceFile, double targetSampleRate, DecodedSample::Format format);
+    juce::File getCacheFileFor (const juce::String& key) const;
+
+    static std::shared_ptr<DecodedSample> mapCacheFile (const juce::File& cacheFile);
+    static bool writeCacheFile (const juce::File& cacheFile, const DecodedSample& data);
+
+    const juce::File cacheFolder;
+    std::atomic<juce::int64> sizeLimit;
+
+    // 内容ハッシュの計算結果（パス + サイズ + 更新日時が同じなら再計算しない）
+    struct HashMemo
+    {
+        juce::int64 fileSize = 0;
+        juce::int64 modTime = 0;
+        juce::uint64 contentHash = 0;
+    };
+    juce::CriticalSection memoLock;
+    std::unordered_map<juce::String, HashMemo> hashMemo;
+
+    static constexpr int janitorIntervalMs = 60000;
+
+    // 先頭部分を渡す最小の長さ（秒）。これより短いファイルは全部揃ってから渡す
+    static constexpr double minPrefixSeconds = 2.0;
+    // ミス時に一度に変換・量子化する長さ（作業バッファ）
+    static constexpr int sectionSize = 1 << 20;
+    // ミス時にデコードして持っておく入力の長さ（チャンネルあたり）。素材全体は持たない
+    static constexpr int decodeWindowSize = 1 << 22;
+
+    // デコードとレート変換の並列化用（open / resample の呼び出しスレッドも一緒に計算する）
+    juce::ThreadPool resamplePool { juce::jmax (1, juce::SystemStats::getNumCpus() - 1) };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecodedSampleCache)
+};
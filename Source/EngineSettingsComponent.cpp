@@ -0,0 +1,129 @@
+/*
+ ==============================================================================
+ EngineSettingsComponent.cpp
+ ==============================================================================
+ */
+#include "EngineSettingsComponent.h"
+
+namespace
+{
+    const auto panelBackground = juce::Colour::fromString ("FF1E293B"); // Slate 800
+    const auto labelColour = juce::Colour::fromString ("FF94A3B8");     // Slate 400
+
+    // コンボボックスの ID = Codec + 1（0 は「未選択」なので使えない）
+    int idForCodec (LibraryEncoder::Codec codec) { return (int) codec + 1; }
+
+    constexpr int budgetChoicesMB[] = { 128, 256, 512, 1024, 2048 };
+    constexpr size_t bytesPerMB = 1024 * 1024;
+
+    juce::String formatMB (size_t bytes)
+    {
+        return juce::String ((double) bytes / (double) bytesPerMB, 0) + " MB";
+    }
+}
+
+EngineSettingsComponent::EngineSettingsComponent (AudioEngine& engine)
+    : audioEngine (engine)
+{
+    codecLabel.setColour (juce::Label::textColourId, labelColour);
+    addAndMakeVisible (codecLabel);
+
+    // このビルドで書けない形式は出さない（WAV は常に書ける）
+    codecBox.addItem ("WAV (keep original)", idForCodec (LibraryEncoder::Codec::wav));
+    if (LibraryEncoder::createFormat (LibraryEncoder::Codec::flac) != nullptr)
+        codecBox.addItem ("FLAC (lossless)", idForCodec (LibraryEncoder::Codec::flac));
+    if (LibraryEncoder::createFormat (LibraryEncoder::Codec::oggVorbis) != nullptr)
+        codecBox.addItem ("Ogg Vorbis (lossy, replaces the WAV)", idForCodec (LibraryEncoder::Codec::oggVorbis));
+
+    codecBox.setSelectedId (idForCodec (audioEngine.getLibraryCodec()), juce::dontSendNotification);
+    codecBox.onChange = [this]
+    {
+        audioEngine.setLibraryCodec ((LibraryEncoder::Codec) (codecBox.getSelectedId() - 1));
+    };
+    addAndMakeVisible (codecBox);
+
+    budgetLabel.setColour (juce::Label::textColourId, labelColour);
+    addAndMakeVisible (budgetLabel);
+
+    const int currentBudgetMB = (int) (audioEngine.getSampleMemoryBudget() / bytesPerMB);
+    for (auto mb : budgetChoicesMB)
+        budgetBox.addItem (formatMB ((size_t) mb * bytesPerMB), mb);
+    if (budgetBox.indexOfItemId (currentBudgetMB) < 0)
+        budgetBox.addItem (formatMB ((size_t) currentBudgetMB * bytesPerMB), currentBudgetMB); // 手で書き換えた値
+
+    budgetBox.setSelectedId (currentBudgetMB, juce::dontSendNotification);
+    budgetBox.onChange = [this]
+    {
+        audioEngine.setSampleMemoryBudget ((size_t) budgetBox.getSelectedId() * bytesPerMB);
+        updateMemoryUsage();
+    };
+    addAndMakeVisible (budgetBox);
+
+    usageLabel.setColour (juce::Label::textColourId, labelColour);
+    usageLabel.setJustificationType (juce::Justification::centredRight);
+    addAndMakeVisible (usageLabel);
+
+    // 予算が足りないときに選ぶもの。読み込み済みのサンプルはそのまま
+    compactToggle.setToggleState (audioEngine.isCompactSampleStorage(), juce::dontSendNotification);
+    compactToggle.onClick = [this] { audioEngine.setCompactSampleStorage (compactToggle.getToggleState()); };
+    addAndMakeVisible (compactToggle);
+
+    // ロード・追い出しはエンジンの変更通知で届く
+    audioEngine.addChangeListener (this);
+    updateMemoryUsage();
+}
+
+EngineSettingsComponent::~EngineSettingsComponent()
+{
+    audioEngine.removeChangeListener (this);
+}
+
+void EngineSettingsComponent::changeListenerCallback (juce::ChangeBroadcaster*)
+{
+    updateMemoryUsage();
+}
+
+void EngineSettingsComponent::updateMemoryUsage()
+{
+    size_t total = 0, onHeap = 0;
+    int numSamples = 0;
+
+    for (const auto& usage : audioEngine.getMemoryUsage())
+    {
+        total += usage.bytes;
+        if (! usage.mapped)
+            onHeap += usage.bytes;
+        ++numSamples;
+    }
+
+    // マップしたものは OS が必要な分だけ読み込む（ヒープ分が実際に確保している量）
+    usageLabel.setText ("In use: " + formatMB (total) + " (" + formatMB (onHeap) + " on heap, "
+                            + juce::String (numSamples) + " buffers)",
+                        juce::dontSendNotification);
+}
+
+void EngineSettingsComponent::paint (juce::Graphics& g)
+{
+    g.fillAll (panelBackground);
+}
+
+void EngineSettingsComponent::resized()
+{
+    auto area = getLocalBounds().reduced (padding);
+    auto row = area.removeFromTop (rowHeight);
+
+    codecLabel.setBounds (row.removeFromLeft (row.getWidth() * 2 / 5));
+    codecBox.setBounds (row);
+
+    row = area.removeFromTop (rowHeight);
+    budgetLabel.setBounds (row.removeFromLeft (row.getWidth() * 2 / 5));
+    budgetBox.setBounds (row);
+
+    usageLabel.setBounds (area.removeFromTop (rowHeight));
+    compactToggle.setBounds (area.removeFromTop (rowHeight));
+}
+
+int EngineSettingsComponent::getIdealHeight() const
+{
+    return rowHeight * numRows + padding * 2;
+}
@@ -0,0 +1,50 @@
+/*
+ ==============================================================================
+ EngineSettingsComponent.h
+ ==============================================================================
+ オーディオ設定パネルの下に並べる、エンジンの保存設定。
+
+ • ライブラリの保存形式（既定は WAV のまま。FLAC / Ogg Vorbis は選んだときだけ変換する）
+ • サンプルのメモリ予算と、いまの使用量（エンジンの変更通知のたびに更新。ポーリングしない）
+ • サンプルを 16bit で持つか（既定はオフ = float32。オンにするとメモリ半分、次にロードするものから）
+ • 値の保存・復元は AudioEngine（settings.xml）。ここは表示と入力だけ
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "AudioEngine.h"
+
+class EngineSettingsComponent : public juce::Component,
+                                private juce::ChangeListener
+{
+public:
+    explicit EngineSettingsComponent (AudioEngine& engine);
+    ~EngineSettingsComponent() override;
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+
+    // 全部の行を並べたときの高さ
+    int getIdealHeight() const;
+
+private:
+    static constexpr int rowHeight = 28;
+    static constexpr int padding = 8;
+    static constexpr int numRows = 4;
+
+    void changeListenerCallback (juce::ChangeBroadcaster*) override;
+    void updateMemoryUsage();
+
+    AudioEngine& audioEngine;
+
+    juce::Label codecLabel { {}, "Library format" };
+    juce::ComboBox codecBox;
+
+    juce::Label budgetLabel { {}, "Sample memory" };
+    juce::ComboBox budgetBox;   // ID = MB
+    juce::Label usageLabel;
+
+    juce::ToggleButton compactToggle { "Store samples as 16-bit (half the memory)" };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EngineSettingsComponent)
+};
@@ -0,0 +1,40 @@
+/*
+ ==============================================================================
+ EngineState.cpp
+ ==============================================================================
+ */
+#include "EngineState.h"
+
+EngineState::Subscription& EngineState::Subscription::operator= (Subscription&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        unsubscribe = std::exchange (other.unsubscribe, nullptr);
+    }
+
+    return *this;
+}
+
+void EngineState::Subscription::reset()
+{
+    if (auto f = std::exchange (unsubscribe, nullptr))
+        f();
+}
+
+EngineState::~EngineState()
+{
+    cancelPendingUpdate();
+}
+
+void EngineState::handleAsyncUpdate()
+{
+    // 変わったフィールドだけ、それぞれの購読者へ
+    playing.dispatch();
+    recording.dispatch();
+    deckGeneration.dispatch();
+    cueRevision.dispatch();
+    currentBank.dispatch();
+    activeSlot.dispatch();
+    slotsRevision.dispatch();
+}
@@ -0,0 +1,135 @@
+/*
+ ==============================================================================
+ EngineState.h
+ ==============================================================================
+ UI が見るエンジンの状態（型付き・フィールドごとの購読）。
+
+ • エンジンは変わるたびに各フィールドへ publish する。値は atomic で、実際に変わったときだけ
+   バージョンが進む（同じ値の publish は何もしない）。オーディオスレッドからも呼べる
+ • 購読はフィールドごと（メッセージスレッド）。AsyncUpdater で次のメッセージループに配るので、
+   遅れは 1 フレーム以内。配る前に何度変わっても 1 回にまとまり、
+   行って戻っただけ（配った値と同じ）なら配らない
+ • ポーリングも ChangeBroadcaster の「何か変わった」も不要 → 待機中は何も起きない
+ • 値は lock-free な atomic に入る型だけ（bool / int）。中身の大きいもの（スロットの名前・
+   キューの一覧）は「変わった回数」のフィールドを購読し、受け取ったらエンジンから読む
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+class EngineState : private juce::AsyncUpdater
+{
+public:
+    // 購読の解除（破棄・reset で外れる）。購読側のメンバに持つ
+    class Subscription
+    {
+    public:
+        Subscription() = default;
+        explicit Subscription (std::function<void()> unsubscribeFunction) : unsubscribe (std::move (unsubscribeFunction)) {}
+        Subscription (Subscription&& other) noexcept : unsubscribe (std::exchange (other.unsubscribe, nullptr)) {}
+        Subscription& operator= (Subscription&& other) noexcept;
+        ~Subscription() { reset(); }
+
+        void reset();
+
+    private:
+        std::function<void()> unsubscribe;
+
+        JUCE_DECLARE_NON_COPYABLE (Subscription)
+    };
+
+    template <typename T>
+    class Field
+    {
+    public:
+        Field (EngineState& ownerState, T initialValue)
+            : owner (ownerState), value (initialValue), deliveredValue (initialValue)
+        {
+            static_assert (std::atomic<T>::is_always_lock_free, "EngineState::Field needs a lock-free type");
+        }
+
+        T get() const                  { return value.load (std::memory_order_acquire); }
+        juce::uint32 getVersion() const { return version.load (std::memory_order_acquire); }
+
+        // 任意のスレッド。値が変わったときだけバージョンを進めて配送を頼む
+        void publish (T newValue)
+        {
+            if (value.exchange (newValue, std::memory_order_acq_rel) == newValue)
+                return;
+
+            version.fetch_add (1, std::memory_order_release);
+            owner.triggerAsyncUpdate();
+        }
+
+        // メッセージスレッド。今の値では呼ばない（初期表示は購読側が get で）
+        Subscription subscribe (std::function<void (T)> callback)
+        {
+            const int id = nextSubscriberId++;
+            subscribers.emplace_back (id, std::move (callback));
+            return Subscription ([this, id]
+            {
+                subscribers.erase (std::remove_if (subscribers.begin(), subscribers.end(),
+                                                   [id] (const auto& s) { return s.first == id; }),
+                                   subscribers.end());
+            });
+        }
+
+    private:
+        friend class EngineState;
+
+        void dispatch()
+        {
+            const auto currentVersion = getVersion();
+            if (currentVersion == deliveredVersion)
+                return;
+
+            deliveredVersion = currentVersion;
+            const T current = get();
+            if (current == deliveredValue)
+                return; // 配る前に元へ戻った
+
+            deliveredValue = current;
+
+            // コールバックの中で購読が外れてもよいよう、id で引き直しながら呼ぶ
+            std::vector<int> ids;
+            for (const auto& s : subscribers)
+                ids.push_back (s.first);
+
+            for (int id : ids)
+            {
+                auto it = std::find_if (subscribers.begin(), subscribers.end(), [id] (const auto& s) { return s.first == id; });
+                if (it != subscribers.end())
+                    it->second (current);
+            }
+        }
+
+        EngineState& owner;
+        std::atomic<T> value;
+        std::atomic<juce::uint32> version { 0 };
+
+        // 以下はメッセージスレッドだけ
+        juce::uint32 deliveredVersion = 0;
+        T deliveredValue;
+        std::vector<std::pair<int, std::function<void (T)>>> subscribers;
+        int nextSubscriberId = 0;
+
+        JUCE_DECLARE_NON_COPYABLE (Field)
+    };
+
+    EngineState() = default;
+    ~EngineState() override;
+
+    // ── フィールド ───────────────────────────────────────────────────────
+    Field<bool> playing { *this, false };
+    Field<bool> recording { *this, false };
+    Field<int> deckGeneration { *this, 0 };   // デッキの中身が差し替わった
+    Field<int> cueRevision { *this, 0 };      // キューマーカーが変わった（中身は getCueMarkers）
+    Field<int> currentBank { *this, 0 };
+    Field<int> activeSlot { *this, 0 };       // 現在のバンク内（別バンクなら -1）
+    Field<int> slotsRevision { *this, 0 };    // スロットの割り当て・ロード状態・名前が変わった
+
+private:
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EngineState)
+};
@@ -0,0 +1,73 @@
+/*
+ ==============================================================================
+ FrameScheduler.cpp
+ ==============================================================================
+ */
+#include "FrameScheduler.h"
+
+FrameScheduler::FrameScheduler (juce::Component& host)
+    : hostComponent (host)
+{
+}
+
+FrameScheduler::~FrameScheduler()
+{
+    cancelPendingUpdate();
+    attachment.reset();
+}
+
+void FrameScheduler::addClient (Client* client)
+{
+    clients.add (client);
+    requestFrames(); // 最初の状態を描かせる
+}
+
+void FrameScheduler::removeClient (Client* client)
+{
+    clients.remove (client);
+}
+
+void FrameScheduler::requestFrames()
+{
+    idle = false;
+    cancelPendingUpdate();
+
+    if (attachment == nullptr)
+    {
+        lastFrameTimeMs = 0.0;
+        attachment = std::make_unique<juce::VBlankAttachment> (&hostComponent, [this] { onVBlank(); });
+    }
+}
+
+bool FrameScheduler::tick (double timeMs)
+{
+    Frame frame;
+    frame.timeMs = timeMs;
+    frame.deltaMs = lastFrameTimeMs > 0.0 ? frame.timeMs - lastFrameTimeMs : 0.0;
+    lastFrameTimeMs = frame.timeMs;
+
+    // 全員に同じ時刻で配る（途中で外れたクライアントは ListenerList が飛ばす）
+    bool anyAnimating = false;
+    clients.call ([&frame, &anyAnimating] (Client& client) { anyAnimating = client.advanceFrame (frame) || anyAnimating; });
+    return anyAnimating;
+}
+
+void FrameScheduler::onVBlank()
+{
+    if (idle)
+        return;
+
+    if (! tick (juce::Time::getMillisecondCounterHiRes()))
+    {
+        // コールバックの中で自分を壊さないよう、外すのはこの後
+        idle = true;
+        triggerAsyncUpdate();
+    }
+}
+
+void FrameScheduler::handleAsyncUpdate()
+{
+    // 外すまでの間に requestFrames されていれば idle は false のまま
+    if (idle)
+        attachment.reset();
+}
@@ -0,0 +1,64 @@
+/*
+ ==============================================================================
+ FrameScheduler.h
+ ==============================================================================
+ アニメーションするコンポーネントの共通のフレーム刻み（コンポーネントごとのタイマーの代わり）。
+
+ • juce::VBlankAttachment で画面のリフレッシュ 1 回につき 1 回、登録された全クライアントの
+   advanceFrame を同じフレーム時刻で呼ぶ → 再描画がリフレッシュに揃い、取りこぼし・二重描画が無い
+ • クライアントは状態が実際に変わったときだけ repaint する
+   advanceFrame の戻り値は「次のフレームも要るか」（回転中・再生中・慣性スクロール中など）
+ • 全員が false を返したら VBlankAttachment を外す（待機中は一切刻まない）
+   再開は requestFrames — 入力イベントやエンジンの変更通知から呼ぶ
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+class FrameScheduler : private juce::AsyncUpdater
+{
+public:
+    struct Frame
+    {
+        double timeMs = 0.0;   // このフレームの時刻（全クライアント共通）
+        double deltaMs = 0.0;  // 前のフレームから（待機明けの最初のフレームは 0）
+    };
+
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        // 1 フレーム進める。変わったものがあればここで repaint。まだ動いているなら true
+        virtual bool advanceFrame (const Frame& frame) = 0;
+    };
+
+    // host のピア（ウィンドウ）のリフレッシュに合わせて刻む
+    explicit FrameScheduler (juce::Component& host);
+    ~FrameScheduler() override;
+
+    void addClient (Client* client);
+    void removeClient (Client* client);
+
+    // 待機中なら刻みを再開する（何度呼んでもよい）。メッセージスレッド専用
+    void requestFrames();
+
+    bool isRunning() const { return attachment != nullptr; }
+
+    // 1 フレームを手で進める（VBlank の無いヘッドレス環境・ベンチマーク用）
+    // 戻り値は「まだ動いているクライアントがいるか」
+    bool tick (double timeMs);
+
+private:
+    void onVBlank();
+    void handleAsyncUpdate() override;
+
+    juce::Component& hostComponent;
+    std::unique_ptr<juce::VBlankAttachment> attachment;
+    juce::ListenerList<Client> clients;
+
+    double lastFrameTimeMs = 0.0; // 0 = 待機明け
+    bool idle = true;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameScheduler)
+};
@@ -0,0 +1,315 @@
+/*
+ ==============================================================================
+ LevelMeterComponent.cpp
+ ==============================================================================
+ */
+#include "LevelMeterComponent.h"
+
+namespace
+{
+    const auto meterBackground = juce::Colour::fromString ("FF0F172A"); // Slate 900
+    const auto labelColour = juce::Colour::fromString ("FF94A3B8");     // Slate 400
+    const auto clipColour = juce::Colour::fromString ("FFEF4444");      // 赤
+    const auto spectrumColour = juce::Colour::fromString ("FF67E8F9");  // Cyan 300
+
+    // メーターの色分け: 〜 -18 dB 緑 / 〜 -6 dB 琥珀 / それ以上 赤
+    constexpr float zoneEdgesDb[] = { -18.0f, -6.0f, 0.0f };
+    const juce::Colour zoneColours[] = { juce::Colour::fromString ("FF22C55E"),
+                                         juce::Colour::fromString ("FFF59E0B"),
+                                         juce::Colour::fromString ("FFEF4444") };
+
+    constexpr double spectrumMinHz = 40.0;
+}
+
+LevelMeterComponent::LevelMeterComponent (AudioEngine& engine, FrameScheduler& scheduler)
+    : audioEngine (engine),
+      frameScheduler (scheduler),
+      spectrumDb ((size_t) AudioMeter::numSpectrumBins, spectrumFloorDb),
+      frameSpectrumDb ((size_t) AudioMeter::numSpectrumBins, spectrumFloorDb)
+{
+    frameScheduler.addClient (this);
+}
+
+LevelMeterComponent::~LevelMeterComponent()
+{
+    setWaitingForAudio (false);
+    frameScheduler.removeClient (this);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+bool LevelMeterComponent::advanceFrame (const FrameScheduler::Frame& frame)
+{
+    const bool active = updateMeters (frame.deltaMs);
+
+    // 全部落ち切ったらフレームを手放し、見える大きさの音が届くまで待つ
+    // （他のクライアントのためにフレームが回り続けている間に動き出したら、待ち受けは解く）
+    setWaitingForAudio (! active);
+    return active;
+}
+
+void LevelMeterComponent::setWaitingForAudio (bool shouldWait)
+{
+    if (shouldWait == waitingForAudio)
+        return;
+
+    waitingForAudio = shouldWait;
+
+    if (shouldWait)
+    {
+        // どちらのタップでも、音が来たらフレームに戻る（再生の開始は MainComponent が起こす）
+        auto wake = [this]
+        {
+            setWaitingForAudio (false); // もう片方の待ち受けも解く（静かなブロックも読む）
+            frameScheduler.requestFrames();
+        };
+        audioEngine.getInputMeter().notifyWhenAudible (wake);
+        audioEngine.getOutputMeter().notifyWhenAudible (wake);
+    }
+    else
+    {
+        audioEngine.getInputMeter().cancelNotification();
+        audioEngine.getOutputMeter().cancelNotification();
+    }
+}
+
+bool LevelMeterComponent::updateMeters (double deltaMs)
+{
+    auto& inputMeter = audioEngine.getInputMeter();
+    auto& outputMeter = audioEngine.getOutputMeter();
+
+    // 両方とも毎回読む（表示していないほうも FIFO に溜めない）
+    const auto inputLevels = inputMeter.collect();
+    const auto outputLevels = outputMeter.collect();
+
+    const bool inputActive = updateTap (input, inputLevels, inputMeter.getSampleRate(), deltaMs);
+    const bool outputActive = updateTap (output, outputLevels, outputMeter.getSampleRate(), deltaMs);
+
+    // スペクトラムは鳴らしているほう（再生・プレビュー中は出力、それ以外は入力）
+    const bool fromOutput = audioEngine.isPlaying() || audioEngine.isPreviewing();
+    if (fromOutput != spectrumFromOutput)
+    {
+        spectrumFromOutput = fromOutput;
+        std::fill (spectrumDb.begin(), spectrumDb.end(), spectrumFloorDb);
+    }
+
+    auto& spectrumMeter = fromOutput ? outputMeter : inputMeter;
+    spectrumSampleRate = spectrumMeter.getSpectrumSampleRate();
+    const bool spectrumActive = updateSpectrum (spectrumMeter, fromOutput ? outputLevels : inputLevels, deltaMs);
+
+    const bool active = inputActive || outputActive || spectrumActive;
+
+    // 止まる最後のフレームでは、しきい値より下に残ったスペクトラムも消しておく（描いたまま固まらない）
+    if (! active && wasActive)
+        std::fill (spectrumDb.begin(), spectrumDb.end(), spectrumFloorDb);
+
+    if (active || wasActive)
+        repaint();
+
+    wasActive = active;
+    return active;
+}
+
+bool LevelMeterComponent::updateTap (TapDisplay& tap, const AudioMeter::Levels& levels, double sampleRate, double deltaMs)
+{
+    if (levels.numChannels > 0)
+        tap.numChannels = levels.numChannels;
+
+    const float release = peakReleaseDbPerSecond * (float) (deltaMs * 0.001);
+
+    // RMS は平均二乗の指数平均。届いたブロックはその長さぶん、届かない間（デバイス停止）は経過時間ぶん無音として
+    const double smoothedMs = levels.numSamples > 0 ? levels.numSamples * 1000.0 / sampleRate : deltaMs;
+    const float rmsCoefficient = (float) (1.0 - std::exp (-smoothedMs / rmsTimeMs));
+
+    bool visible = false;
+
+    for (int ch = 0; ch < tap.numChannels; ++ch)
+    {
+        auto& channel = tap.channels[(size_t) ch];
+        const float peak = levels.peak[(size_t) ch];
+        const float peakDb = juce::Decibels::gainToDecibels (peak, floorDb);
+
+        // ピーク: 即座に上がり、一定の速さで下がる
+        channel.peakDb = juce::jmax (peakDb, channel.peakDb - release);
+
+        // ホールド: しばらく留まってから、ピークと同じ速さで落ちる
+        if (peakDb >= channel.holdDb)
+        {
+            channel.holdDb = peakDb;
+            channel.holdAgeMs = 0.0;
+        }
+        else if ((channel.holdAgeMs += deltaMs) > peakHoldMs)
+        {
+            channel.holdDb = juce::jmax (channel.peakDb, channel.holdDb - release);
+        }
+
+        channel.meanSquare += (levels.meanSquare[(size_t) ch] - channel.meanSquare) * rmsCoefficient;
+        channel.rmsDb = juce::Decibels::gainToDecibels (std::sqrt (channel.meanSquare), floorDb);
+
+        tap.clipped = tap.clipped || peak >= clipLevel;
+        visible = visible || channel.holdDb > floorDb || channel.rmsDb > floorDb;
+    }
+
+    return visible;
+}
+
+bool LevelMeterComponent::updateSpectrum (AudioMeter& meter, const AudioMeter::Levels& levels, double deltaMs)
+{
+    // FFT は新しいサンプルが来たフレームだけ。表示はピークと同じく即座に上がってゆっくり下がる
+    const bool fresh = levels.numSpectrumSamples > 0;
+    if (fresh)
+        meter.computeSpectrum (frameSpectrumDb.data(), spectrumFloorDb);
+
+    const float release = spectrumReleaseDbPerSecond * (float) (deltaMs * 0.001);
+    bool visible = false;
+
+    for (size_t bin = 0; bin < spectrumDb.size(); ++bin)
+    {
+        const float decayed = juce::jmax (spectrumFloorDb, spectrumDb[bin] - release);
+        spectrumDb[bin] = fresh ? juce::jmax (frameSpectrumDb[bin], decayed) : decayed;
+        visible = visible || spectrumDb[bin] > spectrumActiveDb;
+    }
+
+    return visible;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+void LevelMeterComponent::mouseDown (const juce::MouseEvent&)
+{
+    input.clipped = false;
+    output.clipped = false;
+    repaint();
+}
+
+float LevelMeterComponent::dbToProportion (float db, float bottomDb)
+{
+    return juce::jlimit (0.0f, 1.0f, (db - bottomDb) / -bottomDb);
+}
+
+void LevelMeterComponent::paint (juce::Graphics& g)
+{
+    auto area = getLocalBounds().toFloat();
+
+    g.setColour (Constants::bgPanel);
+    g.fillRoundedRectangle (area, 4.0f);
+
+    area = area.reduced (4.0f);
+    constexpr float gap = 6.0f;
+
+    // 狭いときはメーターだけ
+    const bool showSpectrum = area.getWidth() >= 260.0f;
+    const float tapWidth = showSpectrum ? area.getWidth() * 0.3f : (area.getWidth() - gap) * 0.5f;
+
+    paintTap (g, area.removeFromLeft (tapWidth), "IN", input);
+    area.removeFromLeft (gap);
+    paintTap (g, area.removeFromLeft (tapWidth), "OUT", output);
+
+    if (showSpectrum)
+    {
+        area.removeFromLeft (gap);
+        paintSpectrum (g, area);
+    }
+}
+
+void LevelMeterComponent::paintTap (juce::Graphics& g, juce::Rectangle<float> area, const juce::String& label, const TapDisplay& tap) const
+{
+    g.setColour (labelColour);
+    g.setFont (juce::FontOptions (10.0f).withStyle ("Bold"));
+    g.drawText (label, area.removeFromLeft (26.0f), juce::Justification::centredLeft, false);
+
+    // クリップのランプ（クリックで消すまで点いたまま）
+    const auto lamp = area.removeFromRight (8.0f).withSizeKeepingCentre (8.0f, juce::jmin (area.getHeight(), 14.0f));
+    g.setColour (tap.clipped ? clipColour : clipColour.withAlpha (0.15f));
+    g.fillRoundedRectangle (lamp, 2.0f);
+    area.removeFromRight (3.0f);
+
+    constexpr float barGap = 2.0f;
+    const float barHeight = (area.getHeight() - barGap * (float) (tap.numChannels - 1)) / (float) tap.numChannels;
+
+    for (int ch = 0; ch < tap.numChannels; ++ch)
+    {
+        paintBar (g, area.removeFromTop (barHeight), tap.channels[(size_t) ch]);
+        area.removeFromTop (barGap);
+    }
+}
+
+void LevelMeterComponent::paintBar (juce::Graphics& g, juce::Rectangle<float> bar, const ChannelDisplay& channel) const
+{
+    g.setColour (meterBackground);
+    g.fillRect (bar);
+
+    // 左端から level まで、区間ごとの色で
+    auto fillTo = [&] (float db, float alpha)
+    {
+        const float end = bar.getWidth() * dbToProportion (db, floorDb);
+        float start = 0.0f;
+
+        for (size_t zone = 0; zone < std::size (zoneEdgesDb) && start < end; ++zone)
+        {
+            const float zoneEnd = juce::jmin (end, bar.getWidth() * dbToProportion (zoneEdgesDb[zone], floorDb));
+            g.setColour (zoneColours[zone].withAlpha (alpha));
+            g.fillRect (bar.getX() + start, bar.getY(), zoneEnd - start, bar.getHeight());
+            start = zoneEnd;
+        }
+    };
+
+    fillTo (channel.peakDb, 0.35f); // ピークは薄く外側に
+    fillTo (channel.rmsDb, 1.0f);
+
+    if (channel.holdDb > floorDb)
+    {
+        const float x = bar.getX() + bar.getWidth() * dbToProportion (channel.holdDb, floorDb);
+        g.setColour (juce::Colours::white.withAlpha (0.9f));
+        g.fillRect (x - 1.0f, bar.getY(), 2.0f, bar.getHeight());
+    }
+}
+
+void LevelMeterComponent::paintSpectrum (juce::Graphics& g, juce::Rectangle<float> area) const
+{
+    g.setColour (meterBackground);
+    g.fillRoundedRectangle (area, 3.0f);
+
+    const int numColumns = (int) area.getWidth();
+    if (numColumns < 2)
+        return;
+
+    // 横軸は対数周波数。1 列に入るビンのうち一番強いものを
+    const double nyquist = spectrumSampleRate * 0.5;
+    const double binHz = spectrumSampleRate / AudioMeter::spectrumSize;
+    const double octaves = std::log2 (nyquist / spectrumMinHz);
+    const int lastBin = AudioMeter::numSpectrumBins - 1;
+
+    juce::Path curve;
+
+    for (int x = 0; x < numColumns; ++x)
+    {
+        const double loHz = spectrumMinHz * std::exp2 (octaves * x / numColumns);
+        const double hiHz = spectrumMinHz * std::exp2 (octaves * (x + 1) / numColumns);
+        const int firstBin = juce::jlimit (1, lastBin, (int) (loHz / binHz));
+        const int endBin = juce::jlimit (firstBin, lastBin, (int) (hiHz / binHz));
+
+        float db = spectrumFloorDb;
+        for (int bin = firstBin; bin <= endBin; ++bin)
+            db = juce::jmax (db, spectrumDb[(size_t) bin]);
+
+        const juce::Point<float> point (area.getX() + (float) x,
+                                        area.getBottom() - area.getHeight() * dbToProportion (db, spectrumFloorDb));
+        if (x == 0)
+            curve.startNewSubPath (point);
+        else
+            curve.lineTo (point);
+    }
+
+    auto filled = curve;
+    filled.lineTo (area.getBottomRight());
+    filled.lineTo (area.getBottomLeft());
+    filled.closeSubPath();
+
+    g.setColour (spectrumColour.withAlpha (0.3f));
+    g.fillPath (filled);
+    g.setColour (spectrumColour);
+    g.strokePath (curve, juce::PathStrokeType (1.0f));
+
+    g.setColour (labelColour);
+    g.setFont (juce::FontOptions (10.0f).withStyle ("Bold"));
+    g.drawText (spectrumFromOutput ? "OUT" : "IN", area.reduced (4.0f, 2.0f), juce::Justification::topLeft, false);
+}
@@ -0,0 +1,82 @@
+/*
+ ==============================================================================
+ LevelMeterComponent.h
+ ==============================================================================
+ 入力（マイク）・出力のピーク / RMS メーターと小さなスペクトラム。
+
+ • データは AudioEngine の AudioMeter から FrameScheduler のフレームごとに読む
+   オーディオスレッドは FIFO へ書くだけで、FFT・バリスティクス・描画はここ（メッセージスレッド）
+ • メーター: 横向きのバー。RMS（300 ms）を濃く、その外側にピークを薄く、ピークホールドを線で
+   0 dBFS に届いたらクリップのランプが点き、クリックで消すまで残る
+ • スペクトラム: 再生・プレビュー中は出力、それ以外（録音中・待機中）は入力を対数周波数で
+ • 見えるもの（メーターの左端 -60 dB、スペクトラムは spectrumActiveDb）より上が
+   無くなったらフレームを止める（マイクの暗騒音だけでは刻み続けない）
+   止まっている間は AudioMeter が待ち受け、見える大きさの音が届いたらオーディオ側から起こされる
+   （ポーリングしない）
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "AudioEngine.h"
+#include "FrameScheduler.h"
+
+class LevelMeterComponent : public juce::Component,
+                            private FrameScheduler::Client
+{
+public:
+    LevelMeterComponent (AudioEngine& engine, FrameScheduler& scheduler);
+    ~LevelMeterComponent() override;
+
+    void paint (juce::Graphics& g) override;
+    void mouseDown (const juce::MouseEvent& e) override; // クリップのランプを消す
+
+private:
+    static constexpr float floorDb = -60.0f;             // メーターの左端
+    static constexpr float spectrumFloorDb = -90.0f;
+    static constexpr float spectrumActiveDb = -60.0f;    // これより下のビンだけならフレームを止める（マイクの暗騒音は十分下）
+    static constexpr float peakReleaseDbPerSecond = 20.0f;
+    static constexpr float spectrumReleaseDbPerSecond = 40.0f;
+    static constexpr double peakHoldMs = 1500.0;
+    static constexpr double rmsTimeMs = 300.0;
+    static constexpr float clipLevel = 0.999f;           // これ以上は 0 dBFS に張り付いたとみなす
+
+    struct ChannelDisplay
+    {
+        float peakDb = floorDb, holdDb = floorDb, rmsDb = floorDb;
+        float meanSquare = 0.0f;
+        double holdAgeMs = 0.0;
+    };
+
+    struct TapDisplay
+    {
+        std::array<ChannelDisplay, AudioMeter::maxChannels> channels;
+        int numChannels = AudioMeter::maxChannels;
+        bool clipped = false;
+    };
+
+    bool advanceFrame (const FrameScheduler::Frame& frame) override;
+    void setWaitingForAudio (bool shouldWait);
+
+    // FIFO を読んでメーター・スペクトラムを deltaMs ぶん進める。まだ何か見えていれば true
+    bool updateMeters (double deltaMs);
+    static bool updateTap (TapDisplay& tap, const AudioMeter::Levels& levels, double sampleRate, double deltaMs);
+    bool updateSpectrum (AudioMeter& meter, const AudioMeter::Levels& levels, double deltaMs);
+
+    void paintTap (juce::Graphics& g, juce::Rectangle<float> area, const juce::String& label, const TapDisplay& tap) const;
+    void paintBar (juce::Graphics& g, juce::Rectangle<float> bar, const ChannelDisplay& channel) const;
+    void paintSpectrum (juce::Graphics& g, juce::Rectangle<float> area) const;
+    static float dbToProportion (float db, float bottomDb);
+
+    AudioEngine& audioEngine;
+    FrameScheduler& frameScheduler;
+
+    TapDisplay input, output;
+    std::vector<float> spectrumDb, frameSpectrumDb;  // 表示中 / 今のフレームの FFT
+    double spectrumSampleRate = 22050.0;
+    bool spectrumFromOutput = false;
+
+    bool wasActive = true;    // 落ち切った最後のフレームも描く
+    bool waitingForAudio = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeterComponent)
+};
@@ -0,0 +1,480 @@
+/*
+ ==============================================================================
+ LibraryAnalyzer.cpp
+ ==============================================================================
+ Analysis strategy
+ -----------------
+ 1. ファイルを 64k サンプルずつ読みながら 1 パスで以下を同時に計算する:
+      • ピーク（全チャンネルの最大絶対値）
+      • K 特性フィルタ後の 100ms サブブロックごとの平均二乗
+      • ~11kHz に間引いたモノラル信号（ピッチ・テンポ用）。間引いた信号も溜めず、
+        窓 1 つぶんだけ持つ推定器へその場で流す
+
+ 2. Integrated loudness — ITU-R BS.1770: 400ms ブロック (75% オーバーラップ)
+    に絶対ゲート (-70 LUFS) と相対ゲート (-10 LU) をかける。
+
+ 3. Median pitch — 間引き信号に YIN (CMNDF しきい値 0.15) をかけ、
+    有声フレームの基本周波数の中央値を取る（1 セント刻みのヒストグラムで）。
+
+ 4. Tempo — 対数エネルギーの正の差分（ノベルティ）の自己相関から
+    60〜180 BPM の範囲で最もそれらしいラグを選ぶ。4 秒未満は推定しない。
+    ラグごとの積和を流しながら足し込み、平均を引いた相関は最後に和から求める。
+ ==============================================================================
+ */
+#include "LibraryAnalyzer.h"
+#include "LibraryThumbnailCache.h"
+
+namespace
+{
+    constexpr int readBlockSize = 65536;
+    constexpr double analysisRate = 11025.0; // ピッチ/テンポ用の目標レート
+
+    // ── BS.1770 integrated loudness ────────────────────────────────────────
+    float computeIntegratedLoudness (const std::vector<double>& subBlockPower)
+    {
+        constexpr float silence = -70.0f;
+        if (subBlockPower.size() < 4)
+            return silence;
+
+        auto toLufs = [] (double power) { return -0.691 + 10.0 * std::log10 (juce::jmax (power, 1.0e-12)); };
+
+        // 400ms ゲーティングブロック = 連続する 4 サブブロックの平均
+        std::vector<double> blocks;
+        blocks.reserve (subBlockPower.size() - 3);
+        for (size_t i = 0; i + 3 < subBlockPower.size(); ++i)
+            blocks.push_back ((subBlockPower[i] + subBlockPower[i + 1]
+                               + subBlockPower[i + 2] + subBlockPower[i + 3]) * 0.25);
+
+        double sum = 0.0;
+        int count = 0;
+        for (auto z : blocks)
+            if (toLufs (z) > silence) { sum += z; ++count; }
+
+        if (count == 0)
+            return silence;
+
+        const double relativeGate = toLufs (sum / count) - 10.0;
+
+        sum = 0.0;
+        count = 0;
+        for (auto z : blocks)
+        {
+            const double l = toLufs (z);
+            if (l > silence && l > relativeGate) { sum += z; ++count; }
+        }
+
+        return count > 0 ? (float) toLufs (sum / count) : silence;
+    }
+
+    // ── YIN median pitch ───────────────────────────────────────────────────
+    // 間引き信号を 1 点ずつ受け取り、窓 1 つぶんだけを持って hop ごとに YIN をかける。
+    // 中央値は 1 セント刻みのヒストグラムから取る（ファイルの長さによらずメモリは一定）
+    class PitchTracker
+    {
+    public:
+        explicit PitchTracker (double rateToUse)
+            : rate (rateToUse),
+              tauMin (juce::jmax (2, (int) (rate / 1000.0))),             // 1kHz
+              tauMax (juce::jmin (windowSize - 1, (int) (rate / 60.0))),  // 60Hz
+              frameLength (windowSize + tauMax + 1),
+              diff ((size_t) tauMax + 2, 0.0f),
+              histogram ((size_t) numBins, 0)
+        {
+            frame.reserve ((size_t) frameLength);
+        }
+
+        void push (float sample)
+        {
+            frame.push_back (sample);
+            if ((int) frame.size() < frameLength)
+                return;
+
+            analyseFrame();
+            frame.erase (frame.begin(), frame.begin() + hopSize);
+        }
+
+        float getMedian() const
+        {
+            if (numPitches == 0)
+                return 0.0f;
+
+            // 小さい順に numPitches / 2 番目（nth_element で取っていた位置と同じ）
+            auto remaining = (juce::int64) (numPitches / 2);
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                remaining -= histogram[(size_t) bin];
+                if (remaining < 0)
+                    return binToHz (bin);
+            }
+
+            return binToHz (numBins - 1);
+        }
+
+    private:
+        static constexpr int windowSize = 512;
+        static constexpr int hopSize = 256;
+        static constexpr float yinThreshold = 0.15f;
+        static constexpr float lowestHz = 20.0f;  // 補間で 60Hz / 1kHz を少し越える分も入る範囲
+        static constexpr int numBins = 8000;      // 1 セント刻みで 20Hz〜約 2kHz
+
+        static float binToHz (int bin)
+        {
+            return lowestHz * std::exp2 (((float) bin + 0.5f) / 1200.0f);
+        }
+
+        void analyseFrame()
+        {
+            const float* x = frame.data();
+
+            float sumSquares = 0.0f;
+            for (int j = 0; j < windowSize; ++j)
+                sumSquares += x[j] * x[j];
+
+            if (std::sqrt (sumSquares / windowSize) < gate)
+                return; // 無音フレーム
+
+            // 差分関数 + 累積平均正規化 (CMNDF)
+            float running = 0.0f;
+            diff[0] = 1.0f;
+            for (int tau = 1; tau <= tauMax + 1; ++tau)
+            {
+                float d = 0.0f;
+                for (int j = 0; j < windowSize; ++j)
+                {
+                    const float delta = x[j] - x[j + tau];
+                    d += delta * delta;
+                }
+                running += d;
+                diff[(size_t) tau] = running > 0.0f ? d * (float) tau / running : 1.0f;
+            }
+
+            int tau = tauMin;
+            while (tau <= tauMax && diff[(size_t) tau] >= yinThreshold)
+                ++tau;
+
+            if (tau > tauMax)
+                return; // 無声
+
+            while (tau < tauMax && diff[(size_t) tau + 1] < diff[(size_t) tau])
+                ++tau;
+
+            // 放物線補間でサブサンプル精度
+            const float a = diff[(size_t) tau - 1], b = diff[(size_t) tau], c = diff[(size_t) tau + 1];
+            const float denom = a - 2.0f * b + c;
+            const float refined = (float) tau + (std::abs (denom) > 1.0e-9f ? 0.5f * (a - c) / denom : 0.0f);
+
+            if (refined <= 0.0f)
+                return;
+
+            const float cents = 1200.0f * std::log2 ((float) rate / refined / lowestHz);
+            ++histogram[(size_t) juce::jlimit (0, numBins - 1, (int) std::floor (cents))];
+            ++numPitches;
+        }
+
+        const double rate;
+        const int tauMin, tauMax, frameLength;
+        const float gate = juce::Decibels::decibelsToGain (-40.0f);
+
+        std::vector<float> frame;  // 直近の窓（frameLength 点）
+        std::vector<float> diff;
+        std::vector<juce::uint32> histogram;
+        juce::uint64 numPitches = 0;
+    };
+
+    // ── Autocorrelation tempo ──────────────────────────────────────────────
+    // 対数エネルギーの正の差分（ノベルティ）を hop ごとに作り、直前 lagMax 個との積を
+    // ラグごとに足し込む。平均を引いた自己相関は最後に和から組み立てる
+    // （ノベルティ列全体は持たない）
+    class TempoTracker
+    {
+    public:
+        explicit TempoTracker (double rate)
+            : envelopeRate (rate / hopSize),
+              lagMin (juce::jmax (1, (int) std::round (60.0 * envelopeRate / 180.0))),
+              lagMax (juce::jmax (lagMin, (int) std::round (60.0 * envelopeRate / 60.0))),
+              products ((size_t) lagMax + 1, 0.0),
+              recent ((size_t) lagMax, 0.0f)
+        {
+            first.reserve ((size_t) lagMax);
+        }
+
+        void push (float sample)
+        {
+            hopSquares += sample * sample;
+            if (++hopFill < hopSize)
+                return;
+
+            const float logEnergy = std::log (1.0e-6f + hopSquares / hopSize);
+            addNovelty (numFrames > 0 ? juce::jmax (0.0f, logEnergy - previous) : 0.0f);
+            previous = logEnergy;
+            hopSquares = 0.0f;
+            hopFill = 0;
+        }
+
+        float estimate() const
+        {
+            if (numFrames < (int) (envelopeRate * 4.0))
+                return 0.0f;
+
+            const double n = (double) numFrames;
+            const double mean = sum / n;
+            const double zeroLag = sumSquares - n * mean * mean;
+
+            if (zeroLag <= 0.0)
+                return 0.0f;
+
+            const int maxLag = juce::jmin (numFrames - 1, lagMax);
+
+            double bestScore = 0.0, bestCorrelation = 0.0;
+            int bestLag = 0;
+            double firstSum = 0.0, lastSum = 0.0; // 先頭 / 末尾 lag 個の和
+
+            for (int lag = 1; lag <= maxLag; ++lag)
+            {
+                firstSum += first[(size_t) lag - 1];
+                lastSum += recent[(size_t) ((numFrames - lag) % lagMax)];
+
+                if (lag < lagMin)
+                    continue;
+
+                // Σ (n[i] - mean)(n[i + lag] - mean)
+                const double correlation = products[(size_t) lag]
+                                         - mean * ((sum - lastSum) + (sum - firstSum))
+                                         + (n - lag) * mean * mean;
+
+                // 120 BPM 付近をやや優先（倍/半テンポの取り違え防止）
+                const double bpm = 60.0 * envelopeRate / lag;
+                const double octaves = std::log2 (bpm / 120.0);
+                const double score = correlation * std::exp (-0.5 * octaves * octaves);
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestCorrelation = correlation;
+                    bestLag = lag;
+                }
+            }
+
+            // 周期性が弱ければ「テンポなし」
+            if (bestLag == 0 || bestCorrelation / zeroLag < 0.1)
+                return 0.0f;
+
+            return (float) (60.0 * envelopeRate / bestLag);
+        }
+
+    private:
+        static constexpr int hopSize = 256;
+
+        void addNovelty (float value)
+        {
+            for (int lag = lagMin; lag <= juce::jmin (lagMax, numFrames); ++lag)
+                products[(size_t) lag] += (double) value * recent[(size_t) ((numFrames - lag) % lagMax)];
+
+            recent[(size_t) (numFrames % lagMax)] = value;
+            if (numFrames < lagMax)
+                first.push_back (value);
+
+            sum += value;
+            sumSquares += (double) value * value;
+            ++numFrames;
+        }
+
+        const double envelopeRate;
+        const int lagMin, lagMax;
+
+        std::vector<double> products;  // ラグごとの Σ n[i] n[i + lag]
+        std::vector<float> recent;     // 直近 lagMax 個（リング）
+        std::vector<float> first;      // 先頭 lagMax 個
+        double sum = 0.0, sumSquares = 0.0;
+        int numFrames = 0;
+
+        float hopSquares = 0.0f, previous = 0.0f;
+        int hopFill = 0;
+    };
+}
+
+LibraryAnalyzer::LibraryAnalyzer (const juce::File& peakFolderToUse)
+    : peakFolder (peakFolderToUse),
+      pool (juce::jmax (1, juce::SystemStats::getNumCpus() - 1))
+{
+    formatManager.registerBasicFormats();
+}
+
+LibraryAnalyzer::~LibraryAnalyzer()
+{
+    shuttingDown = true;
+    pool.removeAllJobs (true, 5000);
+}
+
+void LibraryAnalyzer::enqueue (const LibraryEntry& entry)
+{
+    {
+        const juce::ScopedLock sl (lock);
+        if (! queuedPaths.insert (entry.file.getFullPathName()).second)
+            return;
+    }
+
+    pool.addJob ([this, entry]
+    {
+        auto result = entry;
+        std::vector<juce::uint8> peaks;
+        const bool ok = ! shuttingDown && analyseFile (formatManager, result, &shuttingDown, &peaks);
+
+        // 終了で打ち切ったものは捨てる。読めなかったものは失敗として返し、インデックスに残す
+        const bool report = ok || ! shuttingDown;
+
+        // 結果を渡す前に保存しておく（メッセージスレッドで invalidate された時点で読める）
+        if (ok)
+        {
+            LibraryThumbnailCache::savePeaks (peakFolder, result, peaks);
+        }
+        else
+        {
+            result = entry;
+            result.analysisFailed = true;
+        }
+
+        {
+            const juce::ScopedLock sl (lock);
+            queuedPaths.erase (entry.file.getFullPathName());
+
+            if (report)
+                results.push_back (std::move (result));
+        }
+
+        if (report)
+            sendChangeMessage();
+    });
+}
+
+std::vector<LibraryEntry> LibraryAnalyzer::popResults()
+{
+    const juce::ScopedLock sl (lock);
+    std::vector<LibraryEntry> out;
+    out.swap (results);
+    return out;
+}
+
+int LibraryAnalyzer::getNumPending() const
+{
+    const juce::ScopedLock sl (lock);
+    return static_cast<int> (queuedPaths.size());
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+bool LibraryAnalyzer::analyseFile (juce::AudioFormatManager& formatManager, LibraryEntry& entry,
+                                   const std::atomic<bool>* shouldAbort, std::vector<juce::uint8>* peaks)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (entry.file));
+    if (reader == nullptr || reader->sampleRate <= 0.0)
+        return false;
+
+    const double sr = reader->sampleRate;
+    const juce::int64 totalSamples = reader->lengthInSamples;
+    const int numChannels = juce::jlimit (1, 2, (int) reader->numChannels);
+
+    entry.sampleRate = sr;
+    entry.numChannels = (int) reader->numChannels;
+    entry.durationSeconds = (double) totalSamples / sr;
+
+    // K 特性: ハイシェルフ (+4dB @1.68kHz) → ハイパス (38Hz)
+    auto shelfCoefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf (sr, 1681.97f, 0.7071f,
+                                                                                  juce::Decibels::decibelsToGain (4.0f));
+    auto highPassCoefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass (sr, 38.13f, 0.5f);
+
+    std::array<juce::dsp::IIR::Filter<float>, 2> shelf, highPass;
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        shelf[(size_t) ch].coefficients = shelfCoefficients;
+        highPass[(size_t) ch].coefficients = highPassCoefficients;
+    }
+
+    const int subBlockLength = juce::jmax (1, (int) std::round (sr * 0.1));
+    std::vector<double> subBlockPower;
+    subBlockPower.reserve ((size_t) (totalSamples / subBlockLength + 1));
+    double subBlockSum = 0.0;
+    int subBlockFill = 0;
+
+    const int decimation = juce::jmax (1, (int) std::floor (sr / analysisRate));
+    const double lowRate = sr / decimation;
+    PitchTracker pitch (lowRate);
+    TempoTracker tempo (lowRate);
+    float decimationSum = 0.0f;
+    int decimationFill = 0;
+
+    // サムネイル用: 全体を numPeaks 区間に分けた各区間の絶対値最大
+    std::vector<float> peakBuckets (peaks != nullptr ? (size_t) LibraryThumbnailCache::numPeaks : 0, 0.0f);
+    const double bucketsPerSample = totalSamples > 0 ? (double) peakBuckets.size() / (double) totalSamples : 0.0;
+
+    float peak = 0.0f;
+    juce::AudioBuffer<float> block (numChannels, readBlockSize);
+
+    for (juce::int64 pos = 0; pos < totalSamples; pos += readBlockSize)
+    {
+        if (shouldAbort != nullptr && shouldAbort->load())
+            return false;
+
+        const int n = (int) juce::jmin ((juce::int64) readBlockSize, totalSamples - pos);
+        reader->read (&block, 0, n, pos, true, true);
+
+        peak = juce::jmax (peak, block.getMagnitude (0, n));
+
+        for (int i = 0; i < n; ++i)
+        {
+            float mono = 0.0f;
+            float magnitude = 0.0f;
+            double power = 0.0;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float s = block.getSample (ch, i);
+                mono += s;
+                magnitude = juce::jmax (magnitude, std::abs (s));
+
+                const float k = highPass[(size_t) ch].processSample (shelf[(size_t) ch].processSample (s));
+                power += (double) k * k;
+            }
+
+            if (! peakBuckets.empty())
+            {
+                auto& bucket = peakBuckets[juce::jmin (peakBuckets.size() - 1, (size_t) ((double) (pos + i) * bucketsPerSample))];
+                bucket = juce::jmax (bucket, magnitude);
+            }
+
+            subBlockSum += power;
+            if (++subBlockFill == subBlockLength)
+            {
+                subBlockPower.push_back (subBlockSum / subBlockLength);
+                subBlockSum = 0.0;
+                subBlockFill = 0;
+            }
+
+            decimationSum += mono / (float) numChannels;
+            if (++decimationFill == decimation)
+            {
+                const float lowSample = decimationSum / (float) decimation;
+                pitch.push (lowSample);
+                tempo.push (lowSample);
+                decimationSum = 0.0f;
+                decimationFill = 0;
+            }
+        }
+    }
+
+    entry.peakDb = juce::Decibels::gainToDecibels (peak, -100.0f);
+    entry.loudnessLufs = computeIntegratedLoudness (subBlockPower);
+    entry.medianPitchHz = pitch.getMedian();
+    entry.tempoBpm = tempo.estimate();
+    entry.analysed = true;
+
+    if (peaks != nullptr)
+    {
+        // ファイル全体のピークで正規化（小さい声のテイクも形が見える）
+        const float scale = peak > 0.0f ? 255.0f / peak : 0.0f;
+        peaks->resize (peakBuckets.size());
+        for (size_t b = 0; b < peakBuckets.size(); ++b)
+            (*peaks)[b] = (juce::uint8) juce::jlimit (0, 255, juce::roundToInt (peakBuckets[b] * scale));
+    }
+
+    return true;
+}
@@ -0,0 +1,51 @@
+/*
+ ==============================================================================
+ LibraryAnalyzer.h
+ ==============================================================================
+ ライブラリファイルをバックグラウンドで解析するマルチスレッドアナライザ。
+
+ • 1 ファイル = 1 ジョブとして ThreadPool（CPU数-1 スレッド）で並列処理
+ • ファイルはブロック単位でストリーム読み込み（全体をメモリに展開しない。
+   ピッチ・テンポも窓 1 つぶんの状態だけで推定する）
+ • 読めなかったファイルも analysisFailed の結果として返す（インデックスに記録して再解析しない）
+ • 完了した結果はキューに溜め、sendChangeMessage() でメッセージスレッドへ
+ • 同じパスで行サムネイル用のピーク列も作り、ワーカーから直接保存する
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "LibraryIndex.h"
+
+class LibraryAnalyzer : public juce::ChangeBroadcaster
+{
+public:
+    // peakFolder: 行サムネイル用ピーク列の保存先（LibraryThumbnailCache と共有）
+    explicit LibraryAnalyzer (const juce::File& peakFolder);
+    ~LibraryAnalyzer() override;
+
+    // 解析を依頼（同じパスが待ち行列にあれば無視）
+    void enqueue (const LibraryEntry& entry);
+
+    // 完了した解析結果を取り出す（メッセージスレッドから）。失敗は analysisFailed = true
+    std::vector<LibraryEntry> popResults();
+
+    int getNumPending() const;
+
+    // 1 ファイルを同期解析して entry の解析フィールドを埋める
+    // peaks を渡すと LibraryThumbnailCache::numPeaks 点の絶対値ピーク (0..255) も返す
+    static bool analyseFile (juce::AudioFormatManager& formatManager, LibraryEntry& entry,
+                             const std::atomic<bool>* shouldAbort = nullptr,
+                             std::vector<juce::uint8>* peaks = nullptr);
+
+private:
+    juce::AudioFormatManager formatManager;
+    const juce::File peakFolder;
+    juce::ThreadPool pool;
+    std::atomic<bool> shuttingDown { false };
+
+    juce::CriticalSection lock;
+    std::vector<LibraryEntry> results;
+    std::unordered_set<juce::String> queuedPaths;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryAnalyzer)
+};
@@ -0,0 +1,146 @@
+/*
+ ==============================================================================
+ LibraryEncoder.cpp
+ ==============================================================================
+ */
+#include "LibraryEncoder.h"
+
+LibraryEncoder::~LibraryEncoder()
+{
+    // 実行中の変換は最後まで（待ち行列のものは捨てる。その WAV は WAV のまま残る）
+    encodePool.removeAllJobs (true, 10000);
+}
+
+void LibraryEncoder::setCodec (Codec newCodec)
+{
+    const juce::ScopedLock sl (lock);
+    codec = newCodec;
+}
+
+LibraryEncoder::Codec LibraryEncoder::getCodec() const
+{
+    const juce::ScopedLock sl (lock);
+    return codec;
+}
+
+void LibraryEncoder::setLossyQuality (int qualityIndex)
+{
+    const juce::ScopedLock sl (lock);
+    lossyQuality = juce::jmax (0, qualityIndex);
+}
+
+int LibraryEncoder::getLossyQuality() const
+{
+    const juce::ScopedLock sl (lock);
+    return lossyQuality;
+}
+
+juce::String LibraryEncoder::getFileExtension (Codec codec)
+{
+    switch (codec)
+    {
+        case Codec::flac:       return ".flac";
+        case Codec::oggVorbis:  return ".ogg";
+        case Codec::wav:        break;
+    }
+
+    return ".wav";
+}
+
+std::unique_ptr<juce::AudioFormat> LibraryEncoder::createFormat (Codec codec)
+{
+    switch (codec)
+    {
+       #if JUCE_USE_FLAC
+        case Codec::flac:       return std::make_unique<juce::FlacAudioFormat>();
+       #endif
+       #if JUCE_USE_OGGVORBIS
+        case Codec::oggVorbis:  return std::make_unique<juce::OggVorbisAudioFormat>();
+       #endif
+        default:                break;
+    }
+
+    return std::make_unique<juce::WavAudioFormat>();
+}
+
+bool LibraryEncoder::encodeInBackground (const juce::File& wavFile)
+{
+    Codec codecToUse;
+    int quality;
+
+    {
+        const juce::ScopedLock sl (lock);
+        codecToUse = codec;
+        quality = lossyQuality;
+    }
+
+    if (codecToUse == Codec::wav || ! wavFile.existsAsFile())
+        return false;
+
+    const auto dest = wavFile.withFileExtension (getFileExtension (codecToUse));
+    ++numPending;
+
+    encodePool.addJob ([this, wavFile, dest, codecToUse, quality]
+    {
+        const bool ok = encodeFile (wavFile, dest, codecToUse, quality);
+
+        {
+            const juce::ScopedLock sl (lock);
+            finished.push_back ({ wavFile, ok ? dest : juce::File() });
+        }
+
+        --numPending;
+        sendChangeMessage();
+    });
+
+    return true;
+}
+
+std::vector<LibraryEncoder::Finished> LibraryEncoder::collectFinished()
+{
+    std::vector<Finished> result;
+
+    const juce::ScopedLock sl (lock);
+    result.swap (finished);
+    return result;
+}
+
+bool LibraryEncoder::encodeFile (const juce::File& source, const juce::File& dest, Codec codec, int lossyQuality)
+{
+    juce::AudioFormatManager readers; // 呼び出しスレッドごと（ベンチマークからも呼ぶ）
+    readers.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (readers.createReaderFor (source));
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+        return false;
+
+    auto format = createFormat (codec);
+    const int numChannels = juce::jlimit (1, 2, (int) reader->numChannels);
+    const int bitsPerSample = reader->bitsPerSample > 16 ? 24 : 16; // FLAC は 16 / 24bit
+    const int qualityIndex = codec == Codec::oggVorbis ? juce::jmin (lossyQuality, format->getQualityOptions().size() - 1)
+                           : codec == Codec::flac      ? flacCompressionIndex
+                                                       : 0;
+
+    // 一時ファイルに書いてから置き換える（スキャナ・ロードに書きかけを見せない）
+    juce::TemporaryFile temp (dest);
+
+    {
+        auto out = std::make_unique<juce::FileOutputStream> (temp.getFile());
+        if (! out->openedOk())
+            return false;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer (
+            format->createWriterFor (out.get(), reader->sampleRate, (unsigned int) numChannels,
+                                     bitsPerSample, {}, juce::jmax (0, qualityIndex)));
+        if (writer == nullptr)
+            return false;
+
+        out.release(); // 以降は writer が持つ
+
+        // ブロックごとに読みながら書く（全体をメモリに展開しない）
+        if (! writer->writeFromAudioReader (*reader, 0, reader->lengthInSamples))
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,71 @@
+/*
+ ==============================================================================
+ LibraryEncoder.h
+ ==============================================================================
+ ライブラリに保存した録音の圧縮（バックグラウンド）。
+
+ • 録音の保存は従来どおりまず 16bit WAV（停止してから戻るまでが短く、すぐ解析できる）
+ • 既定のコーデックは WAV（変換しない）。ユーザーが選んだときだけ専用スレッドで
+   FLAC（可逆）/ Ogg Vorbis（非可逆）へ変換し、完了したら元の WAV と置き換える
+   （一時ファイル経由なので書きかけは見えない。Ogg では元の WAV は残らない）
+   JUCE に Opus のエンコーダは無いので、非可逆は Ogg Vorbis の品質指定で代用
+ • 完了は sendChangeMessage → collectFinished で受け取る
+   （デッキ・スロットの参照の付け替えと WAV の削除はメッセージスレッドで）
+ • 圧縮してもスロットのロードはデコード済みキャッシュを通るので、
+   デコードするのは初回だけ（速度は ScratchMyVoiceBench codec で計測）
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+class LibraryEncoder : public juce::ChangeBroadcaster
+{
+public:
+    enum class Codec
+    {
+        wav,        // 変換しない
+        flac,       // 可逆。16bit WAV の 5〜6 割程度
+        oggVorbis   // 非可逆。品質は setLossyQuality
+    };
+
+    struct Finished
+    {
+        juce::File source;   // 変換前の WAV
+        juce::File encoded;  // 変換後（失敗したら空。WAV はそのまま残る）
+    };
+
+    LibraryEncoder() = default;
+    ~LibraryEncoder() override;
+
+    void setCodec (Codec newCodec);
+    Codec getCodec() const;
+
+    // Ogg Vorbis の品質（OggVorbisAudioFormat の品質の添字。0 = 64kbps 〜 10 = 500kbps）
+    void setLossyQuality (int qualityIndex);
+    int getLossyQuality() const;
+
+    // wavFile を今のコーデックで裏で変換する（WAV のままなら何もせず false）
+    bool encodeInBackground (const juce::File& wavFile);
+    int getNumPending() const { return numPending.load(); }
+
+    // 完了したものを受け取る（sendChangeMessage を受けたら呼ぶ）
+    std::vector<Finished> collectFinished();
+
+    // 同期変換（ベンチマーク用にも公開）。dest は一時ファイル経由で置き換える
+    static bool encodeFile (const juce::File& source, const juce::File& dest, Codec codec, int lossyQuality);
+    static std::unique_ptr<juce::AudioFormat> createFormat (Codec codec);
+    static juce::String getFileExtension (Codec codec);
+
+private:
+    static constexpr int flacCompressionIndex = 5; // デコード速度は圧縮レベルにほぼ依存しない
+
+    mutable juce::CriticalSection lock;
+    Codec codec = Codec::wav;
+    int lossyQuality = 6;
+    std::vector<Finished> finished;
+    std::atomic<int> numPending { 0 };
+
+    juce::ThreadPool encodePool { 1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryEncoder)
+};
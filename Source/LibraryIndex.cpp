@@ -0,0 +1,256 @@
+/*
+ ==============================================================================
+ LibraryIndex.cpp
+ ==============================================================================
+ */
+#include "LibraryIndex.h"
+
+namespace
+{
+    // バイナリ形式: マジック + バージョン + エントリ数 + 各エントリ
+    constexpr int indexMagic = 0x49564d53; // "SMVI"
+    constexpr int indexVersion = 1;
+
+    // パス文字列の後ろの固定長部分: int64 x2 + 解析状態 1 バイト + double x2 + int + float x4
+    constexpr juce::int64 fixedEntryBytes = 8 + 8 + 1 + 8 + 8 + 4 + 4 * 4;
+
+    // 解析状態（v1 の bool と同じ 0 / 1 に「読めなかった」を足したもの）
+    enum : char { stateNotAnalysed = 0, stateAnalysed = 1, stateFailed = 2 };
+
+    // 1 エントリを読む。途中で切れていれば false（読んだ分は捨てる）
+    bool readEntry (juce::InputStream& in, LibraryEntry& entry)
+    {
+        if (in.isExhausted())
+            return false;
+
+        const auto path = in.readString();
+        if (! juce::File::isAbsolutePath (path) || in.getNumBytesRemaining() < fixedEntryBytes)
+            return false;
+
+        entry.file = juce::File (path);
+        entry.fileSize = in.readInt64();
+        entry.modTime = in.readInt64();
+        const auto state = in.readByte();
+        entry.analysed = state == stateAnalysed;
+        entry.analysisFailed = state == stateFailed;
+        entry.durationSeconds = in.readDouble();
+        entry.sampleRate = in.readDouble();
+        entry.numChannels = in.readInt();
+        entry.peakDb = in.readFloat();
+        entry.loudnessLufs = in.readFloat();
+        entry.medianPitchHz = in.readFloat();
+        entry.tempoBpm = in.readFloat();
+        return true;
+    }
+}
+
+LibraryIndex::LibraryIndex (const juce::File& indexFileToUse)
+    : indexFile (indexFileToUse)
+{
+}
+
+void LibraryIndex::clear()
+{
+    pages.clear();
+    freeIds.clear();
+    nextUnusedId = 0;
+    numLive = 0;
+    lookup.clear();
+    dirty = false;
+}
+
+bool LibraryIndex::load()
+{
+    clear();
+
+    juce::FileInputStream in (indexFile);
+    if (! in.openedOk())
+        return false;
+
+    if (in.readInt() != indexMagic || in.readInt() != indexVersion)
+        return false;
+
+    const int numEntries = in.readInt();
+    if (numEntries < 0)
+        return false;
+
+    lookup.reserve (static_cast<size_t> (numEntries));
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        // 読み切れたことを確かめてから ID を割り当てる
+        LibraryEntry entry;
+        if (! readEntry (in, entry) || lookup.count (entry.file.getFullPathName()) != 0)
+        {
+            // 途中で切れた・壊れたインデックスは丸ごと捨て、スキャナの全走査で作り直す
+            clear();
+            return false;
+        }
+
+        const auto id = allocateId();
+        getMutableEntry (id) = std::move (entry);
+        lookup[getEntry (id).file.getFullPathName()] = id;
+    }
+
+    return true;
+}
+
+bool LibraryIndex::save()
+{
+    // 一時ファイルに書いてから置き換える（途中で落ちても壊れない）
+    juce::TemporaryFile temp (indexFile);
+
+    {
+        juce::FileOutputStream out (temp.getFile());
+        if (! out.openedOk())
+            return false;
+
+        out.writeInt (indexMagic);
+        out.writeInt (indexVersion);
+        out.writeInt (numLive);
+
+        forEachEntry ([&out] (EntryId, const LibraryEntry& entry)
+        {
+            out.writeString (entry.file.getFullPathName());
+            out.writeInt64 (entry.fileSize);
+            out.writeInt64 (entry.modTime);
+            out.writeByte (entry.analysed ? stateAnalysed : entry.analysisFailed ? stateFailed : stateNotAnalysed);
+            out.writeDouble (entry.durationSeconds);
+            out.writeDouble (entry.sampleRate);
+            out.writeInt (entry.numChannels);
+            out.writeFloat (entry.peakDb);
+            out.writeFloat (entry.loudnessLufs);
+            out.writeFloat (entry.medianPitchHz);
+            out.writeFloat (entry.tempoBpm);
+        });
+
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        return false;
+
+    dirty = false;
+    return true;
+}
+
+LibraryIndex::EntryId LibraryIndex::allocateId()
+{
+    EntryId id;
+
+    if (! freeIds.empty())
+    {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+    else
+    {
+        id = nextUnusedId++;
+        if ((id >> pageBits) >= pages.size())
+            pages.push_back (std::make_unique<Page>());
+    }
+
+    pages[id >> pageBits]->live[id & pageMask] = true;
+    ++numLive;
+    return id;
+}
+
+LibraryIndex::EntryId LibraryIndex::getId (const juce::File& file) const
+{
+    auto it = lookup.find (file.getFullPathName());
+    return it != lookup.end() ? it->second : invalidId;
+}
+
+const LibraryEntry* LibraryIndex::find (const juce::File& file) const
+{
+    const auto id = getId (file);
+    return id != invalidId ? &getEntry (id) : nullptr;
+}
+
+bool LibraryIndex::addOrUpdate (const juce::File& file, juce::int64 fileSize, juce::int64 modTime)
+{
+    const auto key = file.getFullPathName();
+    auto it = lookup.find (key);
+
+    if (it != lookup.end())
+    {
+        auto& entry = getMutableEntry (it->second);
+        if (entry.fileSize == fileSize && entry.modTime == modTime)
+            return ! entry.analysed && ! entry.analysisFailed;
+
+        // 中身が変わった → 解析結果を破棄
+        entry = LibraryEntry();
+        entry.file = file;
+        entry.fileSize = fileSize;
+        entry.modTime = modTime;
+        dirty = true;
+        return true;
+    }
+
+    const auto id = allocateId();
+    auto& entry = getMutableEntry (id);
+    entry.file = file;
+    entry.fileSize = fileSize;
+    entry.modTime = modTime;
+
+    lookup[key] = id;
+    dirty = true;
+    return true;
+}
+
+bool LibraryIndex::remove (const juce::File& file)
+{
+    auto it = lookup.find (file.getFullPathName());
+    if (it == lookup.end())
+        return false;
+
+    // スロットを空けて ID を再利用リストへ — O(1)、他の ID は動かない
+    const auto id = it->second;
+    lookup.erase (it);
+
+    getMutableEntry (id) = LibraryEntry();
+    pages[id >> pageBits]->live[id & pageMask] = false;
+    freeIds.push_back (id);
+    --numLive;
+    dirty = true;
+    return true;
+}
+
+bool LibraryIndex::rename (const juce::File& oldFile, const juce::File& newFile)
+{
+    if (oldFile == newFile || find (oldFile) == nullptr)
+        return false;
+
+    // 移動先に古いエントリがあれば先に消す
+    remove (newFile);
+
+    auto it = lookup.find (oldFile.getFullPathName());
+    const auto id = it->second;
+    lookup.erase (it);
+
+    getMutableEntry (id).file = newFile;
+    lookup[newFile.getFullPathName()] = id;
+    dirty = true;
+    return true;
+}
+
+bool LibraryIndex::applyAnalysis (const LibraryEntry& analysed)
+{
+    auto it = lookup.find (analysed.file.getFullPathName());
+    if (it == lookup.end())
+        return false;
+
+    auto& entry = getMutableEntry (it->second);
+
+    // 解析中にファイルが書き換わっていたら捨てる（次のスキャンで再解析）
+    if (! entry.hasSameStamp (analysed))
+        return false;
+
+    // 読めなかったものも記録する（同じスタンプの間はスキャンのたびにデコードし直さない）
+    entry = analysed;
+    entry.analysed = ! analysed.analysisFailed;
+    dirty = true;
+    return true;
+}
@@ -0,0 +1,102 @@
+/*
+ ==============================================================================
+ LibraryIndex.h
+ ==============================================================================
+ ライブラリ内の各ファイルの解析結果（長さ・ラウドネス・ピッチ・テンポ）を
+ 保持する永続インデックス。
+
+ • ファイルサイズ + 更新日時のスタンプが変わったエントリだけ再解析
+ • パス → エントリ位置のハッシュマップで検索・更新・削除は O(1)
+ • メッセージスレッド専用（解析結果は LibraryAnalyzer から受け取る）
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+struct LibraryEntry
+{
+    juce::File file;
+    juce::int64 fileSize = 0;
+    juce::int64 modTime = 0;          // ms since epoch
+
+    // ── 解析結果 ───────────────────────────────────────────────────────────
+    bool analysed = false;
+    bool analysisFailed = false;      // 読めなかった（スタンプが変わるまで再解析しない）
+    double durationSeconds = 0.0;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    float peakDb = -100.0f;
+    float loudnessLufs = -70.0f;      // BS.1770 integrated loudness
+    float medianPitchHz = 0.0f;       // 0 = 無声
+    float tempoBpm = 0.0f;            // 0 = 推定不可
+
+    bool hasSameStamp (const LibraryEntry& other) const
+    {
+        return fileSize == other.fileSize && modTime == other.modTime;
+    }
+};
+
+class LibraryIndex
+{
+public:
+    // エントリID。削除されるまで変わらない（表示リストはIDだけを持つ）
+    using EntryId = juce::uint32;
+    static constexpr EntryId invalidId = 0xffffffffu;
+
+    explicit LibraryIndex (const juce::File& indexFileToUse);
+
+    // 読めない・途中で切れたファイルなら空のまま false（次の走査で全ファイルが追加される）
+    bool load();
+    bool save();
+    bool isDirty() const { return dirty; }
+
+    int size() const { return numLive; }
+    EntryId getId (const juce::File& file) const;
+    const LibraryEntry& getEntry (EntryId id) const { return pages[id >> pageBits]->entries[id & pageMask]; }
+    const LibraryEntry* find (const juce::File& file) const;
+
+    // 生きているエントリを ID 順に列挙: callback (EntryId, const LibraryEntry&)
+    template <typename Callback>
+    void forEachEntry (Callback&& callback) const
+    {
+        for (size_t p = 0; p < pages.size(); ++p)
+            for (EntryId slot = 0; slot < pageSize; ++slot)
+                if (pages[p]->live[slot])
+                    callback (static_cast<EntryId> ((p << pageBits) | slot), pages[p]->entries[slot]);
+    }
+
+    // スタンプが変わっていれば解析結果をリセットして true を返す（要再解析）
+    bool addOrUpdate (const juce::File& file, juce::int64 fileSize, juce::int64 modTime);
+    bool remove (const juce::File& file);
+    // リネーム（ID・解析結果はそのまま引き継ぐ）
+    bool rename (const juce::File& oldFile, const juce::File& newFile);
+
+    // スタンプが一致する場合のみ解析結果を反映（analysisFailed の結果は「読めなかった」として記録）
+    bool applyAnalysis (const LibraryEntry& analysed);
+
+private:
+    // 固定長ページ。追加で既存エントリが移動しないので ID と参照が安定する
+    static constexpr EntryId pageBits = 10;
+    static constexpr EntryId pageSize = 1u << pageBits;
+    static constexpr EntryId pageMask = pageSize - 1;
+
+    struct Page
+    {
+        std::array<LibraryEntry, pageSize> entries;
+        std::array<bool, pageSize> live {};
+    };
+
+    LibraryEntry& getMutableEntry (EntryId id) { return pages[id >> pageBits]->entries[id & pageMask]; }
+    EntryId allocateId();
+    void clear();
+
+    juce::File indexFile;
+    std::vector<std::unique_ptr<Page>> pages;
+    std::vector<EntryId> freeIds;
+    EntryId nextUnusedId = 0;
+    int numLive = 0;
+    std::unordered_map<juce::String, EntryId> lookup; // フルパス → ID
+    bool dirty = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryIndex)
+};
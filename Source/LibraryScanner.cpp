@@ -0,0 +1,151 @@
+/*
+ ==============================================================================
+ LibraryScanner.cpp
+ ==============================================================================
+ */
+#include "LibraryScanner.h"
+
+LibraryScanner::LibraryScanner (const juce::File& folderToWatch, const juce::String& wildcardPattern)
+    : juce::Thread ("LibraryScanner"),
+      folder (folderToWatch),
+      wildcard (wildcardPattern)
+{
+}
+
+LibraryScanner::~LibraryScanner()
+{
+    stopThread (4000);
+}
+
+void LibraryScanner::start (const LibraryIndex& knownEntries)
+{
+    jassert (! isThreadRunning());
+
+    snapshot.clear();
+    snapshot.reserve (static_cast<size_t> (knownEntries.size()));
+    knownEntries.forEachEntry ([this] (LibraryIndex::EntryId, const LibraryEntry& entry)
+    {
+        snapshot[entry.file.getFullPathName()] = { entry.fileSize, entry.modTime };
+    });
+
+    scanRequested = true;
+    startThread (juce::Thread::Priority::low);
+}
+
+void LibraryScanner::requestScan()
+{
+    scanRequested = true;
+    notify();
+}
+
+bool LibraryScanner::popDelta (Delta& out)
+{
+    const juce::ScopedLock sl (lock);
+
+    if (pendingDelta.isEmpty())
+        return false;
+
+    out = std::move (pendingDelta);
+    pendingDelta = Delta();
+    return true;
+}
+
+void LibraryScanner::run()
+{
+    while (! threadShouldExit())
+    {
+        // フォルダの mtime が変わった / 要求があった / 定期走査の時刻 → 全走査
+        const auto folderModTime = folder.getLastModificationTime().toMilliseconds();
+        const auto now = juce::Time::getMillisecondCounter();
+
+        if (scanRequested.exchange (false)
+            || folderModTime != lastFolderModTime
+            || now - lastFullScanTime >= fullScanIntervalMs)
+        {
+            lastFolderModTime = folderModTime;
+            lastFullScanTime = now;
+            scan();
+        }
+
+        wait (pollIntervalMs);
+    }
+}
+
+void LibraryScanner::scan()
+{
+    Delta delta;
+    std::unordered_set<juce::String> seen;
+    seen.reserve (snapshot.size());
+
+    for (const auto& entry : juce::RangedDirectoryIterator (folder, false, wildcard))
+    {
+        if (threadShouldExit())
+            return;
+
+        const auto file = entry.getFile();
+        const auto path = file.getFullPathName();
+        const Stamp stamp { entry.getFileSize(), entry.getModificationTime().toMilliseconds() };
+        seen.insert (path);
+
+        auto it = snapshot.find (path);
+        if (it != snapshot.end() && it->second.fileSize == stamp.fileSize && it->second.modTime == stamp.modTime)
+            continue;
+
+        snapshot[path] = stamp;
+
+        LibraryEntry changed;
+        changed.file = file;
+        changed.fileSize = stamp.fileSize;
+        changed.modTime = stamp.modTime;
+        delta.addedOrChanged.push_back (std::move (changed));
+    }
+
+    for (auto it = snapshot.begin(); it != snapshot.end();)
+    {
+        if (seen.count (it->first) == 0)
+        {
+            delta.removed.push_back (juce::File (it->first));
+            it = snapshot.erase (it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (delta.isEmpty())
+        return;
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        // 未取得の差分とマージ（同じファイルは新しい状態で上書き）
+        // 初回スキャンでは数万件になるので、ファイル単位の突き合わせはハッシュで線形に
+        auto& added = pendingDelta.addedOrChanged;
+        auto& removed = pendingDelta.removed;
+
+        if (pendingDelta.isEmpty())
+        {
+            pendingDelta = std::move (delta);
+        }
+        else
+        {
+            std::unordered_set<juce::String> touched;
+            touched.reserve (delta.addedOrChanged.size() + delta.removed.size());
+            for (const auto& e : delta.addedOrChanged)  touched.insert (e.file.getFullPathName());
+            for (const auto& f : delta.removed)         touched.insert (f.getFullPathName());
+
+            added.erase (std::remove_if (added.begin(), added.end(),
+                                         [&] (const LibraryEntry& p) { return touched.count (p.file.getFullPathName()) > 0; }),
+                         added.end());
+            removed.erase (std::remove_if (removed.begin(), removed.end(),
+                                           [&] (const juce::File& f) { return touched.count (f.getFullPathName()) > 0; }),
+                           removed.end());
+
+            std::move (delta.addedOrChanged.begin(), delta.addedOrChanged.end(), std::back_inserter (added));
+            std::move (delta.removed.begin(), delta.removed.end(), std::back_inserter (removed));
+        }
+    }
+
+    sendChangeMessage();
+}
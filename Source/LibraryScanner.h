@@ -0,0 +1,68 @@
+/*
+ ==============================================================================
+ LibraryScanner.h
+ ==============================================================================
+ ライブラリフォルダの変更をバックグラウンドで検出するスキャナ。
+
+ • フォルダ自体の更新日時をポーリングし、変化したときだけ全走査
+   （追加/削除/リネームでフォルダの mtime が変わる）
+ • 上書き保存など mtime が変わらない変更は定期的な全走査で拾う
+ • 前回スナップショットとの差分（追加・変更・削除）だけを通知する
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "LibraryIndex.h"
+
+class LibraryScanner : public juce::ChangeBroadcaster,
+                       private juce::Thread
+{
+public:
+    struct Delta
+    {
+        std::vector<LibraryEntry> addedOrChanged; // file + サイズ + mtime のみ
+        std::vector<juce::File> removed;
+
+        bool isEmpty() const { return addedOrChanged.empty() && removed.empty(); }
+    };
+
+    LibraryScanner (const juce::File& folderToWatch, const juce::String& wildcardPattern);
+    ~LibraryScanner() override;
+
+    // インデックスの内容を初期スナップショットにして監視開始
+    void start (const LibraryIndex& knownEntries);
+
+    // 次のポーリングを待たずに走査
+    void requestScan();
+
+    // 溜まった差分を取り出す（メッセージスレッドから）
+    bool popDelta (Delta& out);
+
+private:
+    void run() override;
+    void scan();
+
+    struct Stamp
+    {
+        juce::int64 fileSize = 0;
+        juce::int64 modTime = 0;
+    };
+
+    const juce::File folder;
+    const juce::String wildcard;
+
+    // スキャナスレッド専用
+    std::unordered_map<juce::String, Stamp> snapshot;
+    juce::int64 lastFolderModTime = -1;
+    juce::uint32 lastFullScanTime = 0;
+
+    std::atomic<bool> scanRequested { true };
+
+    juce::CriticalSection lock;
+    Delta pendingDelta;
+
+    static constexpr int pollIntervalMs = 2000;
+    static constexpr juce::uint32 fullScanIntervalMs = 60000;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryScanner)
+};
@@ -0,0 +1,241 @@
+/*
+ ==============================================================================
+ LibrarySearchIndex.cpp
+ ==============================================================================
+ */
+#include "LibrarySearchIndex.h"
+
+namespace
+{
+    constexpr juce::uint64 boundary = ' ';
+    constexpr juce::uint64 prefixMarker = 0x1fffff; // 有効な文字コードの外
+
+    // 3文字 (各21ビット) を1つのキーに詰める
+    inline juce::uint64 packTrigram (juce::uint64 a, juce::uint64 b, juce::uint64 c)
+    {
+        return (a << 42) | (b << 21) | c;
+    }
+}
+
+juce::StringArray LibrarySearchIndex::splitWords (const juce::String& text)
+{
+    juce::StringArray words;
+    juce::String current;
+
+    for (auto p = text.getCharPointer(); ! p.isEmpty(); ++p)
+    {
+        const auto c = *p;
+
+        if (juce::CharacterFunctions::isLetterOrDigit (c))
+        {
+            current += juce::CharacterFunctions::toLowerCase (c);
+        }
+        else if (current.isNotEmpty())
+        {
+            words.add (current);
+            current.clear();
+        }
+    }
+
+    if (current.isNotEmpty())
+        words.add (current);
+
+    return words;
+}
+
+void LibrarySearchIndex::addWordTrigrams (const juce::String& word, bool isPrefix, std::vector<Trigram>& out)
+{
+    if (word.isEmpty())
+        return;
+
+    // 単語の先頭1文字だけでも引けるように専用キーを持つ（1文字入力用）
+    out.push_back (packTrigram (boundary, (juce::uint64) word[0], prefixMarker));
+
+    std::vector<juce::uint64> chars;
+    chars.reserve ((size_t) word.length() + 2);
+    chars.push_back (boundary);
+    for (auto p = word.getCharPointer(); ! p.isEmpty(); ++p)
+        chars.push_back ((juce::uint64) *p);
+    if (! isPrefix)
+        chars.push_back (boundary);
+
+    for (size_t i = 0; i + 2 < chars.size(); ++i)
+        out.push_back (packTrigram (chars[i], chars[i + 1], chars[i + 2]));
+}
+
+void LibrarySearchIndex::sortAndDedup (std::vector<Trigram>& trigrams)
+{
+    std::sort (trigrams.begin(), trigrams.end());
+    trigrams.erase (std::unique (trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+juce::String LibrarySearchIndex::makeSearchText (const LibraryEntry& entry)
+{
+    juce::String text = entry.file.getFileName();
+
+    if (! entry.analysed)
+        return text;
+
+    // 解析タグ（フィルタと同じ境界値）
+    text << (entry.durationSeconds < 2.0 ? " short" : " long");
+
+    if (entry.medianPitchHz > 0.0f)
+        text << (entry.medianPitchHz < 165.0f ? " low" : " high");
+
+    if (entry.tempoBpm > 0.0f)
+        text << " tempo " << juce::roundToInt (entry.tempoBpm) << "bpm";
+
+    return text;
+}
+
+void LibrarySearchIndex::update (LibraryIndex::EntryId id, const LibraryEntry& entry)
+{
+    remove (id);
+
+    if (id >= records.size())
+        records.resize ((size_t) id + 1);
+
+    std::vector<Trigram> trigrams;
+    for (const auto& word : splitWords (makeSearchText (entry)))
+        addWordTrigrams (word, false, trigrams);
+
+    sortAndDedup (trigrams);
+
+    auto& record = records[id];
+    for (auto t : trigrams)
+        postings[t].push_back ({ id, record.generation });
+
+    record.numPostings = (juce::uint32) trigrams.size();
+    numPostings += trigrams.size();
+}
+
+void LibrarySearchIndex::remove (LibraryIndex::EntryId id)
+{
+    if (id >= records.size() || records[id].numPostings == 0)
+        return;
+
+    // 世代を進めるだけで既存の転置リスト要素は無効になる
+    auto& record = records[id];
+    ++record.generation;
+    numStalePostings += record.numPostings;
+    record.numPostings = 0;
+
+    compactIfNeeded();
+}
+
+void LibrarySearchIndex::compactIfNeeded()
+{
+    if (numStalePostings < 4096 || numStalePostings * 2 < numPostings)
+        return;
+
+    for (auto it = postings.begin(); it != postings.end();)
+    {
+        auto& list = it->second;
+        list.erase (std::remove_if (list.begin(), list.end(),
+                                    [this] (const Posting& p) { return records[p.id].generation != p.generation; }),
+                    list.end());
+
+        if (list.empty())
+            it = postings.erase (it);
+        else
+            ++it;
+    }
+
+    numPostings -= numStalePostings;
+    numStalePostings = 0;
+}
+
+void LibrarySearchIndex::clear()
+{
+    records.clear();
+    postings.clear();
+    numPostings = 0;
+    numStalePostings = 0;
+}
+
+std::vector<LibrarySearchIndex::Match> LibrarySearchIndex::search (const juce::String& query) const
+{
+    std::vector<Match> results;
+
+    const auto words = splitWords (query);
+    if (words.isEmpty() || words.size() > 255)
+        return results;
+
+    // 末尾が区切り文字でなければ最後の単語は入力途中として前方一致で扱う
+    const auto lastChar = query.getLastCharacter();
+    const bool lastIsPrefix = juce::CharacterFunctions::isLetterOrDigit (lastChar);
+
+    if (hitCounts.size() < records.size())
+    {
+        hitCounts.resize (records.size(), 0);
+        scoreSums.resize (records.size(), 0.0f);
+        wordsMatched.resize (records.size(), 0);
+    }
+
+    candidates.clear();
+    std::vector<Trigram> wordTrigrams;
+
+    for (int w = 0; w < words.size(); ++w)
+    {
+        const bool isPrefix = lastIsPrefix && w == words.size() - 1;
+
+        wordTrigrams.clear();
+        if (words[w].length() == 1 && isPrefix)
+            wordTrigrams.push_back (packTrigram (boundary, (juce::uint64) words[w][0], prefixMarker));
+        else
+            addWordTrigrams (words[w], isPrefix, wordTrigrams);
+
+        // 先頭1文字キーは1文字入力以外では採点に使わない（一致率が甘くなる）
+        if (wordTrigrams.size() > 1)
+            wordTrigrams.erase (wordTrigrams.begin());
+
+        sortAndDedup (wordTrigrams);
+
+        // 転置リストを走査してエントリごとの一致数を数える
+        wordHits.clear();
+        for (auto t : wordTrigrams)
+        {
+            auto it = postings.find (t);
+            if (it == postings.end())
+                continue;
+
+            for (const auto& p : it->second)
+                if (records[p.id].generation == p.generation && hitCounts[p.id]++ == 0)
+                    wordHits.push_back (p.id);
+        }
+
+        const float numTrigrams = (float) wordTrigrams.size();
+
+        for (auto id : wordHits)
+        {
+            const float score = (float) hitCounts[id] / numTrigrams;
+            hitCounts[id] = 0;
+
+            // 前の単語をすべて満たしているものだけ残す（AND 検索）
+            if (score < minScore || wordsMatched[id] != w)
+                continue;
+
+            if (w == 0)
+                candidates.push_back (id);
+
+            scoreSums[id] += score;
+            wordsMatched[id] = (juce::uint8) (w + 1);
+        }
+    }
+
+    for (auto id : candidates)
+    {
+        if (wordsMatched[id] == words.size())
+            results.push_back ({ id, scoreSums[id] / (float) words.size() });
+
+        scoreSums[id] = 0.0f;
+        wordsMatched[id] = 0;
+    }
+
+    std::sort (results.begin(), results.end(), [] (const Match& a, const Match& b)
+    {
+        return a.score != b.score ? a.score > b.score : a.id < b.id;
+    });
+
+    return results;
+}
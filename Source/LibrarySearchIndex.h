@@ -0,0 +1,82 @@
+/*
+ ==============================================================================
+ LibrarySearchIndex.h
+ ==============================================================================
+ ライブラリのあいまい検索用トライグラム索引。
+
+ • ファイル名と解析タグ (short/long, low/high, "120bpm" など) を単語に分け、
+   単語ごとに前後へ区切りを付けたトライグラムを転置リストに登録
+ • 検索は問い合わせのトライグラムの一致率でスコア付け（タイプミスを許容）
+   区切り付きトライグラムがあるので単語の先頭一致が自然に上位に来る
+ • 追加・更新・削除はエントリ単位で差分更新（全体の作り直しはしない）
+   転置リストの要素は世代番号付きで、削除は世代を進めるだけの O(1)。
+   古い要素が半分を超えたらまとめて掃除する
+ • カウンタ配列を使い回すので検索中の確保は結果配列だけ
+ • LibraryIndex と同じくメッセージスレッド専用
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "LibraryIndex.h"
+
+class LibrarySearchIndex
+{
+public:
+    struct Match
+    {
+        LibraryIndex::EntryId id;
+        float score; // 0..1（全トライグラム一致で 1）
+    };
+
+    LibrarySearchIndex() = default;
+
+    // エントリの名前・タグから索引を作り直す（追加・リネーム・解析完了時）
+    void update (LibraryIndex::EntryId id, const LibraryEntry& entry);
+    void remove (LibraryIndex::EntryId id);
+    void clear();
+
+    // スコア順（同点は ID 順）。空白区切りの各単語をすべて満たすものだけ返す
+    std::vector<Match> search (const juce::String& query) const;
+
+    // 検索対象の文字列（ファイル名 + タグ）
+    static juce::String makeSearchText (const LibraryEntry& entry);
+
+private:
+    using Trigram = juce::uint64;
+
+    // 英数字以外で区切り、小文字化した単語列
+    static juce::StringArray splitWords (const juce::String& text);
+    // " word " の各トライグラム + 先頭1文字のキーを追加。
+    // 入力途中の単語 (isPrefix) は末尾の区切りを付けない
+    static void addWordTrigrams (const juce::String& word, bool isPrefix, std::vector<Trigram>& out);
+    static void sortAndDedup (std::vector<Trigram>& trigrams);
+
+    struct Posting
+    {
+        LibraryIndex::EntryId id;
+        juce::uint32 generation; // records の世代と違えば削除済み
+    };
+
+    struct Record
+    {
+        juce::uint32 generation = 0;
+        juce::uint32 numPostings = 0; // 0 = 未登録
+    };
+
+    void compactIfNeeded();
+
+    std::vector<Record> records;                                // EntryId → 登録状態
+    std::unordered_map<Trigram, std::vector<Posting>> postings;
+    size_t numPostings = 0, numStalePostings = 0;
+
+    // 検索用の作業領域（EntryId ごとの一致数）。const な search から使い回す
+    mutable std::vector<juce::uint16> hitCounts;
+    mutable std::vector<float> scoreSums;
+    mutable std::vector<juce::uint8> wordsMatched;
+    mutable std::vector<LibraryIndex::EntryId> wordHits, candidates;
+
+    // 一致率がこれ未満の候補は捨てる（1文字のタイプミス程度は通す）
+    static constexpr float minScore = 0.5f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibrarySearchIndex)
+};
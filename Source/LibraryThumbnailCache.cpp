@@ -0,0 +1,268 @@
+/*
+ ==============================================================================
+ LibraryThumbnailCache.cpp
+ ==============================================================================
+ */
+#include "LibraryThumbnailCache.h"
+#include "Constants.h"
+
+namespace
+{
+    // ピークファイル: マジック + スタンプ + 点数 + ピーク列
+    constexpr int peakMagic = 0x4b504d53; // "SMPK"
+}
+
+LibraryThumbnailCache::LibraryThumbnailCache (const juce::File& peakFolderToUse, int thumbnailWidth, int thumbnailHeight)
+    : juce::Thread ("LibraryThumbnails"),
+      peakFolder (peakFolderToUse),
+      width (thumbnailWidth),
+      height (thumbnailHeight)
+{
+    startThread (juce::Thread::Priority::low);
+}
+
+LibraryThumbnailCache::~LibraryThumbnailCache()
+{
+    stopThread (2000);
+}
+
+// ── ピーク列の保存・読み込み ─────────────────────────────────────────────────
+
+juce::File LibraryThumbnailCache::getPeakFileFor (const juce::File& folder, const juce::File& audioFile)
+{
+    // パスのハッシュをファイル名に（同名ファイルが別フォルダにあっても衝突しない）
+    const auto hash = juce::String::toHexString ((juce::int64) audioFile.getFullPathName().hashCode64());
+    return folder.getChildFile (hash + ".peaks");
+}
+
+bool LibraryThumbnailCache::savePeaks (const juce::File& folder, const LibraryEntry& entry, const std::vector<juce::uint8>& peaks)
+{
+    if (! folder.createDirectory())
+        return false;
+
+    juce::TemporaryFile temp (getPeakFileFor (folder, entry.file));
+
+    {
+        juce::FileOutputStream out (temp.getFile());
+        if (! out.openedOk())
+            return false;
+
+        out.writeInt (peakMagic);
+        out.writeInt64 (entry.fileSize);
+        out.writeInt64 (entry.modTime);
+        out.writeInt ((int) peaks.size());
+        out.write (peaks.data(), peaks.size());
+
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+bool LibraryThumbnailCache::loadPeaks (const juce::File& folder, const LibraryEntry& entry, std::vector<juce::uint8>& peaks)
+{
+    juce::FileInputStream in (getPeakFileFor (folder, entry.file));
+    if (! in.openedOk())
+        return false;
+
+    if (in.readInt() != peakMagic
+        || in.readInt64() != entry.fileSize
+        || in.readInt64() != entry.modTime)
+        return false;
+
+    const int count = in.readInt();
+    if (count <= 0 || count > 65536)
+        return false;
+
+    peaks.resize ((size_t) count);
+    return in.read (peaks.data(), count) == count;
+}
+
+// ── キャッシュ（メッセージスレッド） ─────────────────────────────────────────
+
+juce::String LibraryThumbnailCache::makeKey (const LibraryEntry& entry)
+{
+    return entry.file.getFullPathName() + "|" + juce::String (entry.fileSize) + "|" + juce::String (entry.modTime);
+}
+
+juce::Image LibraryThumbnailCache::getThumbnail (const LibraryEntry& entry)
+{
+    // 未解析ならピークも無い
+    if (! entry.analysed)
+        return {};
+
+    const auto key = makeKey (entry);
+
+    auto it = cache.find (key);
+    if (it != cache.end())
+    {
+        lru.splice (lru.begin(), lru, it->second.lruPosition);
+        return it->second.image;
+    }
+
+    if (missing.count (key) > 0 || ! pending.insert (key).second)
+        return {};
+
+    {
+        const juce::ScopedLock sl (lock);
+        requests.push_back ({ key, entry });
+
+        // 通り過ぎた行の要求は捨てる（捨てた分は次に表示されたとき再依頼）
+        while (requests.size() > maxQueuedRequests)
+        {
+            // pending は次の collectRendered で外す
+            rendered.push_back ({ requests.front().key, juce::Image(), false });
+            requests.pop_front();
+        }
+    }
+
+    notify();
+    return {};
+}
+
+bool LibraryThumbnailCache::collectRendered (std::vector<juce::File>& missingPeaks)
+{
+    std::vector<Rendered> done;
+    {
+        const juce::ScopedLock sl (lock);
+        done.swap (rendered);
+    }
+
+    bool anyNew = false;
+
+    for (auto& r : done)
+    {
+        const bool wasPending = pending.erase (r.key) > 0;
+
+        if (r.image.isValid())
+        {
+            insertIntoCache (r.key, r.image);
+            missing.erase (r.key);
+            anyNew = true;
+        }
+        else if (r.peaksMissing && wasPending)
+        {
+            // ピークが読めなかった。invalidate されるまで再依頼しない
+            missing.insert (r.key);
+            missingPeaks.push_back (juce::File (r.key.upToFirstOccurrenceOf ("|", false, false)));
+        }
+    }
+
+    return anyNew;
+}
+
+void LibraryThumbnailCache::insertIntoCache (const juce::String& key, const juce::Image& image)
+{
+    auto it = cache.find (key);
+    if (it != cache.end())
+    {
+        it->second.image = image;
+        lru.splice (lru.begin(), lru, it->second.lruPosition);
+        return;
+    }
+
+    lru.push_front (key);
+    cache[key] = { image, lru.begin() };
+
+    while (cache.size() > maxCachedImages)
+    {
+        cache.erase (lru.back());
+        lru.pop_back();
+    }
+}
+
+void LibraryThumbnailCache::invalidate (const LibraryEntry& entry)
+{
+    const auto key = makeKey (entry);
+    missing.erase (key);
+    pending.erase (key);
+
+    auto it = cache.find (key);
+    if (it != cache.end())
+    {
+        lru.erase (it->second.lruPosition);
+        cache.erase (it);
+    }
+}
+
+void LibraryThumbnailCache::forget (const LibraryEntry& entry)
+{
+    invalidate (entry);
+    getPeakFileFor (peakFolder, entry.file).deleteFile();
+}
+
+void LibraryThumbnailCache::moved (const LibraryEntry& oldEntry, const juce::File& newFile)
+{
+    invalidate (oldEntry);
+    getPeakFileFor (peakFolder, oldEntry.file).moveFileTo (getPeakFileFor (peakFolder, newFile));
+}
+
+// ── 描画スレッド ─────────────────────────────────────────────────────────────
+
+void LibraryThumbnailCache::run()
+{
+    std::vector<juce::uint8> peaks;
+
+    while (! threadShouldExit())
+    {
+        Request request;
+        bool hasRequest = false;
+
+        {
+            // 新しい要求（今見えている行）から処理
+            const juce::ScopedLock sl (lock);
+            if (! requests.empty())
+            {
+                request = std::move (requests.back());
+                requests.pop_back();
+                hasRequest = true;
+            }
+        }
+
+        if (! hasRequest)
+        {
+            wait (-1);
+            continue;
+        }
+
+        const bool loaded = loadPeaks (peakFolder, request.entry, peaks);
+        auto image = loaded ? render (peaks) : juce::Image();
+
+        {
+            const juce::ScopedLock sl (lock);
+            rendered.push_back ({ request.key, image, ! loaded });
+        }
+
+        sendChangeMessage();
+    }
+}
+
+juce::Image LibraryThumbnailCache::render (const std::vector<juce::uint8>& peaks) const
+{
+    // メッセージスレッド外で描くのでネイティブ画像ではなくソフトウェア画像
+    juce::Image image (juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+    juce::Graphics g (image);
+
+    const float mid = (float) height * 0.5f;
+    const float numPeaksF = (float) peaks.size();
+
+    g.setColour (Constants::accentColor.withAlpha (0.85f));
+
+    // 1 ピクセル列 = 対応する範囲のピーク最大値（上下対称のバー）
+    for (int x = 0; x < width; ++x)
+    {
+        const auto start = (size_t) ((float) x * numPeaksF / (float) width);
+        const auto end = juce::jmax (start + 1, (size_t) ((float) (x + 1) * numPeaksF / (float) width));
+
+        juce::uint8 value = 0;
+        for (size_t i = start; i < end && i < peaks.size(); ++i)
+            value = juce::jmax (value, peaks[i]);
+
+        const float halfHeight = juce::jmax (0.5f, mid * (float) value / 255.0f);
+        g.fillRect ((float) x, mid - halfHeight, 1.0f, halfHeight * 2.0f);
+    }
+
+    return image;
+}
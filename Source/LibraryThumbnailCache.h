@@ -0,0 +1,95 @@
+/*
+ ==============================================================================
+ LibraryThumbnailCache.h
+ ==============================================================================
+ ライブラリ行のミニ波形サムネイル。
+
+ • 波形の元データは解析時に作る 256 点のピーク列（1 バイト/点）で、
+   ライブラリ横の LibraryPeaks/ フォルダに保存する（音声のデコード不要）
+ • 画像化は専用スレッドで行い、ソフトウェア Image としてメッセージスレッドへ渡す
+ • 完成した画像は「パス + サイズ + 更新日時」をキーにした LRU に保持し、
+   行の描画は drawImageAt で貼るだけ
+ • 要求は新しいものから処理し、溜まり過ぎたら古い要求を捨てる
+   （高速スクロールで通り過ぎた行のために働かない）
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "LibraryIndex.h"
+
+class LibraryThumbnailCache : public juce::ChangeBroadcaster,
+                              private juce::Thread
+{
+public:
+    static constexpr int numPeaks = 256;
+
+    LibraryThumbnailCache (const juce::File& peakFolderToUse, int thumbnailWidth, int thumbnailHeight);
+    ~LibraryThumbnailCache() override;
+
+    // キャッシュにあれば返す。無ければ描画を依頼して無効な Image を返す
+    // （完成したら sendChangeMessage される）。メッセージスレッド専用
+    juce::Image getThumbnail (const LibraryEntry& entry);
+
+    // 描画済みの画像を LRU へ取り込む（sendChangeMessage を受けたら呼ぶ）
+    // 新しい画像があれば true。解析済みなのにピーク列が無かったファイル
+    // （ピーク保存前のインデックス）は missingPeaks に入る → 再解析で作り直す
+    bool collectRendered (std::vector<juce::File>& missingPeaks);
+
+    // 解析が完了した / ファイルが消えた エントリの画像と失敗記録を捨てる
+    void invalidate (const LibraryEntry& entry);
+    // ピークファイルも削除（ライブラリから消えたとき）
+    void forget (const LibraryEntry& entry);
+    // リネームに合わせてピークファイルを移す（スタンプは変わらないので再解析不要）
+    void moved (const LibraryEntry& oldEntry, const juce::File& newFile);
+
+    int getWidth() const  { return width; }
+    int getHeight() const { return height; }
+
+    // ── ピーク列の保存・読み込み（解析スレッドからも呼ぶ） ──────────────
+    static juce::File getPeakFileFor (const juce::File& peakFolder, const juce::File& audioFile);
+    static bool savePeaks (const juce::File& peakFolder, const LibraryEntry& entry, const std::vector<juce::uint8>& peaks);
+    // スタンプ（サイズ・更新日時）が一致するときだけ成功
+    static bool loadPeaks (const juce::File& peakFolder, const LibraryEntry& entry, std::vector<juce::uint8>& peaks);
+
+private:
+    struct Request
+    {
+        juce::String key;
+        LibraryEntry entry;
+    };
+
+    struct Rendered
+    {
+        juce::String key;
+        juce::Image image;
+        bool peaksMissing; // ピークファイルが無い / スタンプ不一致（要求を捨てただけなら false）
+    };
+
+    void run() override;
+    juce::Image render (const std::vector<juce::uint8>& peaks) const;
+    void insertIntoCache (const juce::String& key, const juce::Image& image);
+    static juce::String makeKey (const LibraryEntry& entry);
+
+    const juce::File peakFolder;
+    const int width, height;
+
+    // ── メッセージスレッド専用: LRU ────────────────────────────────────
+    struct CacheItem
+    {
+        juce::Image image;
+        std::list<juce::String>::iterator lruPosition;
+    };
+    std::unordered_map<juce::String, CacheItem> cache;
+    std::list<juce::String> lru;                 // 先頭 = 最近使った
+    std::unordered_set<juce::String> pending;    // 描画依頼中
+    std::unordered_set<juce::String> missing;    // ピーク無し（解析待ち）
+    static constexpr size_t maxCachedImages = 512;
+    static constexpr size_t maxQueuedRequests = 64;
+
+    // ── スレッド間 ────────────────────────────────────────────────────
+    juce::CriticalSection lock;
+    std::deque<Request> requests;
+    std::vector<Rendered> rendered;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryThumbnailCache)
+};
@@ -17,16 +17,16 @@ MainComponent::MainComponent()
     : audioEngine() // メンバー初期化
 {
     // UIコンポーネントの初期化と追加
-    turntable = std::make_unique<TurntableComponent>(audioEngine);
+    turntable = std::make_unique<TurntableComponent>(audioEngine, frameScheduler);
     addAndMakeVisible(turntable.get());
 
-    waveform = std::make_unique<WaveformComponent>(audioEngine);
+    waveform = std::make_unique<WaveformComponent>(audioEngine, frameScheduler);
     addAndMakeVisible(waveform.get());
 
     crossfader = std::make_unique<CrossfaderComponent>(audioEngine);
     addAndMakeVisible(crossfader.get());
 
-    sampleList = std::make_unique<SampleListComponent>(audioEngine);
+    sampleList = std::make_unique<SampleListComponent>(audioEngine, audioEngine.getLibraryFolder());
     addAndMakeVisible(sampleList.get());
 
     sampleSlots = std::make_unique<SampleSlotComponent>(audioEngine);
@@ -47,12 +47,15 @@ MainComponent::MainComponent()
     });
     addAndMakeVisible(sampleSlots.get());
 
+    levelMeter = std::make_unique<LevelMeterComponent>(audioEngine, frameScheduler);
+    addAndMakeVisible(levelMeter.get());
+
     // ボタン設定
     addAndMakeVisible(playStopButton);
     playStopButton.onClick = [this] {
         if (audioEngine.isPlaying()) audioEngine.stop();
         else audioEngine.play();
-        updateButtonColors();
+        // ボタンの表示は state.playing の購読で変わる
     };
 
     addAndMakeVisible(libraryToggleButton);
@@ -72,8 +75,11 @@ MainComponent::MainComponent()
                 deviceManager,
                 0, 2, 0, 2, true, true, true, false);
             addAndMakeVisible(audioSelector.get());
+            engineSettings = std::make_unique<EngineSettingsComponent>(audioEngine);
+            addAndMakeVisible(engineSettings.get());
         } else {
             audioSelector = nullptr;
+            engineSettings = nullptr;
         }
         updateButtonColors();
         resized();
@@ -87,19 +93,25 @@ MainComponent::MainComponent()
             // 録音データをファイルに保存してライブラリを更新
             auto savedFile = audioEngine.saveRecordingToFile();
             if (savedFile.existsAsFile()) {
-                sampleList->refreshLibrary();
+                sampleList->addFile(savedFile);
             }
         } else {
             audioEngine.startRecording();
         }
-        updateButtonColors();
+        // ボタンの表示は state.recording の購読で変わる
     };
 
     // ボタン色の初期設定
     updateButtonColors();
 
-    // 状態更新用タイマー (100ms間隔)
-    startTimer(100);
+    // 再生・録音の開始/停止 → ボタンを合わせ、止まっていたアニメーションを起こす
+    // （ポーリングしない。遷移したときだけ、次のメッセージループで届く）
+    auto onTransportChanged = [this](bool) {
+        updateButtonColors();
+        frameScheduler.requestFrames();
+    };
+    stateSubscriptions.push_back(audioEngine.getState().playing.subscribe(onTransportChanged));
+    stateSubscriptions.push_back(audioEngine.getState().recording.subscribe(onTransportChanged));
 
     // Issue #16: Use full screen by default; layout adapts in resized()
     setSize(824, 768);
@@ -134,7 +146,7 @@ juce::File MainComponent::getAudioSettingsFile() const
 
 MainComponent::~MainComponent()
 {
-    stopTimer();
+    stateSubscriptions.clear();
     
     // オーディオデバイス設定の保存
     auto settingsFile = getAudioSettingsFile();
@@ -145,6 +157,7 @@ MainComponent::~MainComponent()
         state->writeTo(settingsFile, {});
 
     audioSelector = nullptr;
+    engineSettings = nullptr;
     shutdownAudio();
 }
 
@@ -155,6 +168,9 @@ void MainComponent::prepareToPlay(int samplesPerBlockExpected, double sampleRate
 
 void MainComponent::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
 {
+    // 0. 入力のメーター（録音前からクリップが見えるように常に）
+    audioEngine.getInputMeter().push(bufferToFill);
+
     // 1. 録音中ならマイク入力をAudioEngineのバッファに保存
     if (audioEngine.isRecording())
     {
@@ -220,7 +236,7 @@ void MainComponent::resized()
 // ─── Issue #16: Mobile-first layout ─────────────────────────────────────────
 //
 // Layout from top to bottom:
-//   1. Header bar (PLAY, REC, Library, Audio buttons)
+//   1. Header bar (PLAY, REC, Library, Audio buttons) + level meter strip
 //   2. Sample slots (horizontal pill buttons)
 //   3. Stage / Turntable (square, aspect-ratio responsive)
 //   4. Waveform
@@ -249,6 +265,10 @@ void MainComponent::layoutMobile(juce::Rectangle<int>& area)
 
 	headerFlex.performLayout(header.reduced(pad));
 
+	// 入出力のメーター（録音前にクリップが見えるようヘッダーのすぐ下）
+	const int meterHeight = juce::jmax(28, height / 28);
+	levelMeter->setBounds(area.removeFromTop(meterHeight).reduced(pad, 2));
+
 	// ── Library overlay (full width panel, below header) ───────────────
 	if (isLibraryOpen)
 	{
@@ -258,11 +278,14 @@ void MainComponent::layoutMobile(juce::Rectangle<int>& area)
 	// ── Audio settings overlay ─────────────────────────────────────────
 	if (isAudioSettingsOpen && audioSelector != nullptr)
 	{
-		audioSelector->setBounds(area.removeFromTop(juce::jmin(height / 3, 250)));
+		auto panel = area.removeFromTop(juce::jmin(height / 3, 250) + engineSettings->getIdealHeight());
+		engineSettings->setBounds(panel.removeFromBottom(engineSettings->getIdealHeight()));
+		audioSelector->setBounds(panel);
 	}
 
 	// ── 2. Sample slots (horizontal bottom-sheet style) ────────────────
-	const int slotHeight = juce::jmax(40, height / 14);
+	// バンク 16 スロットを 2 段で並べるので 2 行分の高さ
+	const int slotHeight = juce::jmax(72, height / 8);
 	auto slotArea = area.removeFromTop(slotHeight);
 	sampleSlots->setBounds(slotArea);
 
@@ -286,6 +309,7 @@ void MainComponent::layoutMobile(juce::Rectangle<int>& area)
 	if (!isAudioSettingsOpen && audioSelector != nullptr)
 	{
 		audioSelector->setBounds(0, 0, 0, 0);
+		engineSettings->setBounds(0, 0, 0, 0);
 	}
 }
 
@@ -312,6 +336,9 @@ void MainComponent::layoutDesktop(juce::Rectangle<int>& area)
 	libraryToggleButton.setBounds(header.removeFromRight(buttonWidth + 20).reduced(buttonPadding));
 	audioSettingsButton.setBounds(header.removeFromRight(buttonWidth + 20).reduced(buttonPadding));
 
+	// ボタンの間に入出力のメーター + スペクトラム
+	levelMeter->setBounds(header.reduced(buttonPadding * 2, buttonPadding));
+
 	// ライブラリ表示/非表示
 	if (isLibraryOpen)
 	{
@@ -325,11 +352,14 @@ void MainComponent::layoutDesktop(juce::Rectangle<int>& area)
 	// オーディオ設定パネル表示/非表示
 	if (isAudioSettingsOpen && audioSelector != nullptr)
 	{
-		audioSelector->setBounds(area.removeFromRight(audioSettingsWidth));
+		auto panel = area.removeFromRight(audioSettingsWidth);
+		engineSettings->setBounds(panel.removeFromBottom(engineSettings->getIdealHeight()));
+		audioSelector->setBounds(panel);
 	}
 	else if (audioSelector != nullptr)
 	{
 		audioSelector->setBounds(0, 0, 0, 0);
+		engineSettings->setBounds(0, 0, 0, 0);
 	}
 
 	// 残りのエリアを分割
@@ -351,17 +381,13 @@ void MainComponent::layoutDesktop(juce::Rectangle<int>& area)
 	turntable->setBounds(area);
 }
 
-// ─── Button/Timer callbacks ─────────────────────────────────────────────────
+// ─── Button callbacks ───────────────────────────────────────────────────────
 
 void MainComponent::buttonClicked(juce::Button* button)
 {
     // リスナー実装 (Lambdaを使ったのでここは空でもOKですが、SampleListComponent用などに残しています)
 }
 
-void MainComponent::timerCallback()
-{
-    updateButtonColors();
-}
 
 void MainComponent::updateButtonColors()
 {
@@ -14,8 +14,11 @@
 #include "CrossfaderComponent.h"
 #include "SampleListComponent.h"
 #include "SampleSlotComponent.h"
+#include "LevelMeterComponent.h"
+#include "EngineSettingsComponent.h"
+#include "FrameScheduler.h"
 
-class MainComponent : public juce::AudioAppComponent, public juce::Button::Listener, public juce::Timer
+class MainComponent : public juce::AudioAppComponent, public juce::Button::Listener
 {
 	public:
 	MainComponent();
@@ -29,18 +32,21 @@ class MainComponent : public juce::AudioAppComponent, public juce::Button::Liste
 	void resized() override;
 
 	void buttonClicked(juce::Button* button) override;
-	void timerCallback() override;
 
 	private:
 	// Core Engine
 	AudioEngine audioEngine;
 
+	// 全アニメーションの共通フレーム（子より先に作り、子より後に壊す）
+	FrameScheduler frameScheduler { *this };
+
 	// Child Components
 	std::unique_ptr<TurntableComponent> turntable;
 	std::unique_ptr<WaveformComponent> waveform;
 	std::unique_ptr<CrossfaderComponent> crossfader;
 	std::unique_ptr<SampleListComponent> sampleList;
 	std::unique_ptr<SampleSlotComponent> sampleSlots;
+	std::unique_ptr<LevelMeterComponent> levelMeter; // 入出力のメーター + スペクトラム
 
 	// Layout Controls
 	juce::TextButton libraryToggleButton { "Library" };
@@ -48,11 +54,15 @@ class MainComponent : public juce::AudioAppComponent, public juce::Button::Liste
 	juce::TextButton audioSettingsButton { "Audio" };
 	juce::TextButton recordButton { "REC" };
 
+	// 再生・録音の状態（変わったときだけ届く）
+	std::vector<EngineState::Subscription> stateSubscriptions;
+
 	bool isLibraryOpen = false;
 	bool isMobileLayout = false;
 
 	// Audio Settings
 	std::unique_ptr<juce::AudioDeviceSelectorComponent> audioSelector;
+	std::unique_ptr<EngineSettingsComponent> engineSettings; // デバイス選択の下（ライブラリの保存形式など）
 	bool isAudioSettingsOpen = false;
 	juce::File getAudioSettingsFile() const;
 
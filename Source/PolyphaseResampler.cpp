@@ -0,0 +1,163 @@
+/*
+ ==============================================================================
+ PolyphaseResampler.cpp
+ ==============================================================================
+ */
+#include "PolyphaseResampler.h"
+
+namespace
+{
+    constexpr double kaiserBeta = 9.0;  // 阻止域 ≈ -90 dB
+    constexpr double rolloff = 0.95;    // 遷移帯の分だけカットオフをナイキストより下げる
+
+    // 第1種変形ベッセル関数 I0（級数展開）
+    double besselI0 (double x)
+    {
+        double sum = 1.0, term = 1.0;
+        const double halfX = x * 0.5;
+
+        for (int k = 1; k < 50; ++k)
+        {
+            term *= (halfX / k) * (halfX / k);
+            sum += term;
+            if (term < sum * 1.0e-12)
+                break;
+        }
+
+        return sum;
+    }
+}
+
+const std::vector<float>& PolyphaseResampler::getKernelTable()
+{
+    // 片側（x >= 0）のみ。x はゼロ交差単位、テーブルの添字 = x * phasesPerZeroCrossing
+    static const std::vector<float> table = []
+    {
+        const int size = numZeroCrossings * phasesPerZeroCrossing + 2;
+        std::vector<float> t ((size_t) size, 0.0f);
+        const double i0Beta = besselI0 (kaiserBeta);
+
+        for (int i = 0; i < size - 1; ++i)
+        {
+            const double x = (double) i / phasesPerZeroCrossing;
+            const double r = x / numZeroCrossings;
+            if (r > 1.0)
+                break;
+
+            const double sinc = x == 0.0 ? 1.0 : std::sin (juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+            const double window = besselI0 (kaiserBeta * std::sqrt (1.0 - r * r)) / i0Beta;
+            t[(size_t) i] = (float) (sinc * window);
+        }
+
+        return t; // 最後の要素は 0（補間で端を越えて読むため）
+    }();
+
+    return table;
+}
+
+double PolyphaseResampler::getHalfWidth (double ratio)
+{
+    // カットオフ（入力のナイキスト比）で広がるフィルターの片側の幅（入力サンプル単位）
+    return numZeroCrossings / (juce::jmin (1.0, 1.0 / ratio) * rolloff);
+}
+
+juce::int64 PolyphaseResampler::getNumOutputSamplesAvailable (juce::int64 numInputSamples, double ratio)
+{
+    // 出力 n は入力の floor (n * ratio + halfWidth) まで読む
+    const double lastUsable = (double) numInputSamples - 1.0 - getHalfWidth (ratio);
+    return lastUsable < 0.0 ? 0 : (juce::int64) std::floor (lastUsable / ratio) + 1;
+}
+
+juce::int64 PolyphaseResampler::getFirstInputSampleNeeded (juce::int64 firstOutputSample, double ratio)
+{
+    // 出力 n は入力の ceil (n * ratio - halfWidth) から読む（n が増えると後ろへ進む）
+    return juce::jmax ((juce::int64) 0, (juce::int64) std::ceil ((double) firstOutputSample * ratio - getHalfWidth (ratio)));
+}
+
+void PolyphaseResampler::processRange (const float* input, juce::int64 inputOffset, juce::int64 inputLength, double ratio,
+                                       juce::int64 firstOutputSample, float* output, juce::int64 start, juce::int64 end)
+{
+    const auto& table = getKernelTable();
+    const int tableLimit = (int) table.size() - 1;
+
+    // カットオフ（入力のナイキスト比）。ダウンサンプルでは出力のナイキストまで下げる
+    const double scale = juce::jmin (1.0, 1.0 / ratio) * rolloff;
+    const double halfWidth = getHalfWidth (ratio);
+    const double phaseStep = scale * phasesPerZeroCrossing;
+
+    for (auto i = start; i < end; ++i)
+    {
+        const double t = (double) (firstOutputSample + i) * ratio;
+        const auto first = juce::jmax ((juce::int64) 0, (juce::int64) std::ceil (t - halfWidth));
+        const auto last = juce::jmin (inputLength - 1, (juce::int64) std::floor (t + halfWidth));
+        jassert (first >= inputOffset || first > last); // 手元に無い入力は読まない
+
+        double sum = 0.0;
+
+        for (auto k = first; k <= last; ++k)
+        {
+            const double phase = std::abs (t - k) * phaseStep;
+            const int index = (int) phase;
+            if (index >= tableLimit)
+                continue;
+
+            const float frac = (float) (phase - index);
+            const float h = table[(size_t) index] + frac * (table[(size_t) index + 1] - table[(size_t) index]);
+            sum += (double) (input[k - inputOffset] * h);
+        }
+
+        output[i] = (float) (sum * scale);
+    }
+}
+
+void PolyphaseResampler::process (const float* input, juce::int64 inputLength, float* output, juce::int64 outputLength,
+                                  double ratio, juce::ThreadPool* pool)
+{
+    processSection (input, 0, inputLength, ratio, 0, output, outputLength, pool);
+}
+
+void PolyphaseResampler::processSection (const float* input, juce::int64 inputOffset, juce::int64 inputLength, double ratio,
+                                         juce::int64 firstOutputSample, float* output, juce::int64 outputLength,
+                                         juce::ThreadPool* pool)
+{
+    if (outputLength <= 0)
+        return;
+
+    jassert (ratio > 0.0);
+    const auto numChunks = (outputLength + chunkSize - 1) / chunkSize;
+
+    // ジョブが呼び出し後に始まってもチャンクが残っていなければ何も触らない
+    // （共有状態だけを shared_ptr で生かしておく）
+    struct Progress
+    {
+        std::atomic<juce::int64> nextChunk { 0 };
+        std::atomic<juce::int64> chunksDone { 0 };
+        juce::WaitableEvent allDone;
+    };
+
+    auto progress = std::make_shared<Progress>();
+
+    auto work = [progress, input, inputOffset, inputLength, ratio, firstOutputSample, output, outputLength, numChunks]
+    {
+        for (;;)
+        {
+            const auto chunk = progress->nextChunk++;
+            if (chunk >= numChunks)
+                return;
+
+            const auto start = chunk * chunkSize;
+            processRange (input, inputOffset, inputLength, ratio, firstOutputSample, output, start,
+                          juce::jmin (outputLength, start + chunkSize));
+
+            if (++progress->chunksDone == numChunks)
+                progress->allDone.signal();
+        }
+    };
+
+    if (pool != nullptr)
+        for (int i = 0; i < (int) juce::jmin ((juce::int64) pool->getNumThreads(), numChunks - 1); ++i)
+            pool->addJob (work);
+
+    work();
+    progress->allDone.wait();
+}
@@ -0,0 +1,49 @@
+/*
+ ==============================================================================
+ PolyphaseResampler.h
+ ==============================================================================
+ ロード時に一度だけ使う高品質なサンプルレート変換（帯域制限補間）。
+
+ • Kaiser 窓付き sinc をゼロ交差あたり 256 位相でテーブル化した
+   ポリフェーズフィルター（位相間は線形補間）。任意の比率に対応
+ • ダウンサンプル時はカットオフを出力側のナイキストまで下げてエイリアスを防ぐ
+ • 出力をチャンクに分けてスレッドプールで並列に計算する
+   （呼び出しスレッドも一緒に働くので、プールが埋まっていても止まらない）
+ • オーディオスレッドでは使わない（再生は SampleRenderKernel の線形補間）
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+class PolyphaseResampler
+{
+public:
+    // ratio = 入力レート / 出力レート。output に outputLength サンプル書く
+    // 入力の範囲外はゼロとして扱う。pool が null なら呼び出しスレッドだけで計算
+    static void process (const float* input, juce::int64 inputLength, float* output, juce::int64 outputLength,
+                         double ratio, juce::ThreadPool* pool = nullptr);
+
+    // 出力の [firstOutputSample, firstOutputSample + numOutputSamples) だけを output に書く
+    // （入力が先頭から少しずつ揃う場合の逐次変換用）
+    // input[0] は入力の inputOffset 番目。手元に持つのは入力の一部でよいが、この範囲の出力が読む
+    // [getFirstInputSampleNeeded, 最後の出力 + 幅] を含むこと。inputLength は入力全体の長さ
+    static void processSection (const float* input, juce::int64 inputOffset, juce::int64 inputLength, double ratio,
+                                juce::int64 firstOutputSample, float* output, juce::int64 numOutputSamples,
+                                juce::ThreadPool* pool = nullptr);
+
+    // 入力の先頭 numInputSamples だけで正しく計算できる出力の数
+    static juce::int64 getNumOutputSamplesAvailable (juce::int64 numInputSamples, double ratio);
+
+    // 出力 firstOutputSample 以降の計算が読む入力の先頭（これより前は捨ててよい）
+    static juce::int64 getFirstInputSampleNeeded (juce::int64 firstOutputSample, double ratio);
+
+private:
+    static constexpr int numZeroCrossings = 24;
+    static constexpr int phasesPerZeroCrossing = 256;
+    static constexpr int chunkSize = 16384;
+
+    static double getHalfWidth (double ratio);
+    static void processRange (const float* input, juce::int64 inputOffset, juce::int64 inputLength, double ratio,
+                              juce::int64 firstOutputSample, float* output, juce::int64 start, juce::int64 end);
+    static const std::vector<float>& getKernelTable();
+};
@@ -0,0 +1,91 @@
+/*
+ ==============================================================================
+ SampleBanks.cpp
+ ==============================================================================
+ */
+#include "SampleBanks.h"
+
+SampleBanks::SampleBanks (int numBanksToUse, int slotsPerBankToUse)
+    : numBanks (juce::jmax (1, numBanksToUse)),
+      slotsPerBank (juce::jmax (1, slotsPerBankToUse))
+{
+    const auto numSlots = (size_t) getNumSlots();
+    states.assign (numSlots, State::empty);
+    lengths.assign (numSlots, 0);
+    files.resize (numSlots);
+    names.resize (numSlots);
+    samples.resize (numSlots);
+}
+
+void SampleBanks::assignFile (int index, const juce::File& file)
+{
+    const auto i = (size_t) index;
+    states[i] = State::unloaded;
+    lengths[i] = 0;
+    files[i] = file;
+    names[i] = file.getFileNameWithoutExtension();
+    samples[i].reset();
+}
+
+void SampleBanks::assignSample (int index, std::shared_ptr<const DecodedSample> sample, const juce::String& name)
+{
+    const auto i = (size_t) index;
+    states[i] = State::loaded;
+    lengths[i] = sample->getNumSamples();
+    files[i] = juce::File();
+    names[i] = name;
+    samples[i] = std::move (sample);
+}
+
+void SampleBanks::markLoading (int index)
+{
+    jassert (states[(size_t) index] != State::empty);
+    states[(size_t) index] = State::loading;
+}
+
+void SampleBanks::setLoaded (int index, std::shared_ptr<const DecodedSample> sample)
+{
+    const auto i = (size_t) index;
+    states[i] = sample != nullptr ? State::loaded : State::failed;
+    lengths[i] = sample != nullptr ? sample->getNumSamples() : 0;
+    samples[i] = std::move (sample);
+}
+
+void SampleBanks::unload (int index)
+{
+    const auto i = (size_t) index;
+
+    // ファイルの無いスロットは作り直せない。ロード中のものは完了を待つ
+    if (files[i] == juce::File() || states[i] != State::loaded)
+        return;
+
+    states[i] = State::unloaded;
+    samples[i].reset();
+}
+
+std::vector<int> SampleBanks::findLoading (const juce::File& file) const
+{
+    std::vector<int> result;
+
+    for (size_t i = 0; i < states.size(); ++i)
+        if (states[i] == State::loading && files[i] == file)
+            result.push_back ((int) i);
+
+    return result;
+}
+
+std::vector<int> SampleBanks::replaceFile (const juce::File& from, const juce::File& to)
+{
+    std::vector<int> result;
+
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        if (files[i] == from)
+        {
+            files[i] = to;
+            result.push_back ((int) i);
+        }
+    }
+
+    return result;
+}
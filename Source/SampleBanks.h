@@ -0,0 +1,80 @@
+/*
+ ==============================================================================
+ SampleBanks.h
+ ==============================================================================
+ サンプルスロットのバンク（既定 8 バンク × 16 スロット）のメタデータ。
+
+ • スロットは通し番号 (bank * slotsPerBank + slot) で扱い、
+   状態・長さ・ファイル・名前・サンプルをそれぞれ別の配列に持つ (SoA)
+   → 状態だけを走査する処理（読み込み待ちの検索など）は小さな配列を舐めるだけ
+ • サンプルデータは遅延ロード。ファイルを割り当てただけのスロットは unloaded で、
+   バンクが表示されたときに SampleCache のバックグラウンドロードへ回す
+ • 離れたバンクのデータは手放す（SampleCache の予算内なら再表示時にすぐ戻る）
+   ファイルを持たないスロット（キュー区間の切り出し）は作り直せないので手放さない
+ • メッセージスレッド専用。オーディオスレッドはデッキのサンプルしか見ないので、
+   バンクの切り替えはオーディオスレッドに何の仕事も発生させない
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "DecodedSampleCache.h"
+
+class SampleBanks
+{
+public:
+    enum class State : juce::uint8
+    {
+        empty,      // 何も割り当てていない
+        unloaded,   // ファイルは割り当て済み、データは未ロード
+        loading,    // バックグラウンドでロード中
+        loaded,
+        failed      // ファイルが読めなかった
+    };
+
+    SampleBanks (int numBanks, int slotsPerBank);
+
+    int getNumBanks() const      { return numBanks; }
+    int getSlotsPerBank() const  { return slotsPerBank; }
+    int getNumSlots() const      { return numBanks * slotsPerBank; }
+    int indexOf (int bank, int slot) const { return bank * slotsPerBank + slot; }
+    int bankOf (int index) const { return index / slotsPerBank; }
+    bool isValidIndex (int index) const { return index >= 0 && index < getNumSlots(); }
+
+    // ── 割り当て ────────────────────────────────────────────────────────
+    // ファイルを割り当てる（データはまだ読まない）
+    void assignFile (int index, const juce::File& file);
+    // メモリ上のサンプルを直接割り当てる（ファイル無し。手放さない）
+    void assignSample (int index, std::shared_ptr<const DecodedSample> sample, const juce::String& name);
+
+    // ── ロード状態 ──────────────────────────────────────────────────────
+    void markLoading (int index);
+    // ロード完了（sample が null なら failed）
+    void setLoaded (int index, std::shared_ptr<const DecodedSample> sample);
+    // ファイル由来のデータを手放して unloaded に戻す
+    void unload (int index);
+
+    // file の完了を待っているスロット
+    std::vector<int> findLoading (const juce::File& file) const;
+
+    // ファイルが置き換わった（録音の圧縮など）スロットの参照を付け替え、該当スロットを返す
+    // データ・状態はそのまま（中身は同じ音）
+    std::vector<int> replaceFile (const juce::File& from, const juce::File& to);
+
+    // ── 参照 ────────────────────────────────────────────────────────────
+    State getState (int index) const                 { return states[(size_t) index]; }
+    juce::int64 getNumSamples (int index) const      { return lengths[(size_t) index]; }
+    const juce::File& getFile (int index) const      { return files[(size_t) index]; }
+    const juce::String& getName (int index) const    { return names[(size_t) index]; }
+    const std::shared_ptr<const DecodedSample>& getSample (int index) const { return samples[(size_t) index]; }
+
+private:
+    const int numBanks, slotsPerBank;
+
+    std::vector<State> states;
+    std::vector<juce::int64> lengths;
+    std::vector<juce::File> files;
+    std::vector<juce::String> names;
+    std::vector<std::shared_ptr<const DecodedSample>> samples;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleBanks)
+};
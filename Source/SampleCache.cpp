@@ -0,0 +1,307 @@
+/*
+ ==============================================================================
+ SampleCache.cpp
+ ==============================================================================
+ */
+#include "SampleCache.h"
+
+SampleCache::SampleCache (DecodedSampleCache& diskCacheToUse, size_t memoryBudgetBytes)
+    : diskCache (diskCacheToUse),
+      memoryBudget (memoryBudgetBytes)
+{
+    prefetchFormatManager.registerBasicFormats();
+    loadFormatManager.registerBasicFormats();
+}
+
+SampleCache::~SampleCache()
+{
+    loadPool.removeAllJobs (true, 4000);
+    prefetchPool.removeAllJobs (true, 4000);
+}
+
+juce::String SampleCache::makeKey (const juce::File& file, double sampleRate, DecodedSample::Format format)
+{
+    return file.getFullPathName() + "@" + juce::String (juce::roundToInt (sampleRate))
+         + (format == DecodedSample::Format::int16 ? "/i16" : "");
+}
+
+size_t SampleCache::measure (const DecodedSample& sample)
+{
+    if (! sample.isMapped())
+        return sample.getResidentBytes();
+
+    return (size_t) sample.getNumChannels() * (size_t) sample.getNumSamples() * sample.getBytesPerSample();
+}
+
+std::shared_ptr<const DecodedSample> SampleCache::findLoaded (const juce::File& file, double sampleRate) const
+{
+    const juce::ScopedLock sl (lock);
+    auto it = items.find (makeKey (file, sampleRate, storageFormat));
+    return it != items.end() ? it->second.sample : nullptr;
+}
+
+std::shared_ptr<const DecodedSample> SampleCache::insert (const juce::File& file, double sampleRate,
+                                                          std::shared_ptr<const DecodedSample> sample)
+{
+    const juce::ScopedLock sl (lock);
+    const auto key = makeKey (file, sampleRate, sample->getFormat());
+
+    // プリフェッチと同時に読み込んだ場合は先に入った方を使う
+    auto it = items.find (key);
+    if (it != items.end())
+    {
+        it->second.lastUsed = ++useCounter;
+        return it->second.sample;
+    }
+
+    Item item;
+    item.file = file;
+    item.sampleRate = sampleRate;
+    item.bytes = measure (*sample);
+    item.sample = std::move (sample);
+    item.lastUsed = ++useCounter;
+
+    totalBytes += item.bytes;
+    auto result = item.sample; // 呼び出し側が持つので追い出し対象にならない
+    items.emplace (key, std::move (item));
+
+    evictIdleOverBudget();
+    return result;
+}
+
+void SampleCache::evictIdleOverBudget()
+{
+    while (totalBytes > memoryBudget)
+    {
+        // キャッシュだけが持っている（use_count == 1）中で最も古いもの
+        auto oldest = items.end();
+        for (auto it = items.begin(); it != items.end(); ++it)
+            if (it->second.sample.use_count() == 1
+                && (oldest == items.end() || it->second.lastUsed < oldest->second.lastUsed))
+                oldest = it;
+
+        if (oldest == items.end())
+            return; // 全部使用中 — 予算超過のまま（使用中のものは解放できない）
+
+        totalBytes -= oldest->second.bytes;
+        items.erase (oldest);
+    }
+}
+
+void SampleCache::prefetch (const juce::File& file, double sampleRate)
+{
+    juce::String key;
+    juce::uint32 job = 0;
+
+    {
+        const juce::ScopedLock sl (lock);
+        key = makeKey (file, sampleRate, storageFormat);
+
+        if (items.count (key) > 0 || pending.count (key) > 0)
+            return;
+
+        job = ++jobCounter;
+        pending[key] = { file, sampleRate, storageFormat, job };
+    }
+
+    prefetchPool.addJob ([this, key, job] { runPending (key, job, prefetchFormatManager); });
+}
+
+void SampleCache::cancelPrefetches()
+{
+    // 実行中のジョブは最後まで走らせる（途中のキャッシュファイルを残さない）
+    prefetchPool.removeAllJobs (false, 0);
+
+    // 始まっていないプリフェッチだけを忘れる（ロードが合流したものは残す）
+    // 取り除く前にスレッドが拾ったジョブは、表に自分が無いので何もせずに終わる
+    const juce::ScopedLock sl (lock);
+
+    for (auto it = pending.begin(); it != pending.end();)
+    {
+        if (! it->second.started && ! it->second.deliver)
+            it = pending.erase (it);
+        else
+            ++it;
+    }
+}
+
+void SampleCache::requestLoad (const juce::File& file, double sampleRate, bool wantPrefix)
+{
+    juce::String key;
+    juce::uint32 job = 0;
+    bool alreadyLoaded = false;
+
+    {
+        const juce::ScopedLock sl (lock);
+        key = makeKey (file, sampleRate, storageFormat);
+
+        auto it = items.find (key);
+        auto inFlight = pending.find (key);
+
+        if (it != items.end())
+        {
+            it->second.lastUsed = ++useCounter;
+            loaded.push_back ({ file, sampleRate, it->second.sample, true });
+            alreadyLoaded = true;
+        }
+        else if (inFlight != pending.end())
+        {
+            auto& p = inFlight->second;
+            const bool loadQueued = p.deliver;
+            p.deliver = true;
+            p.wantPrefix = p.wantPrefix || wantPrefix;
+
+            // デコード中のプリフェッチに合流（完了時に届く）。同じものをロード待ちなら何もしない
+            if (p.started || loadQueued)
+                return;
+
+            // 待ち行列のプリフェッチは追い越してロードのスレッドで読む（そのジョブは何もせずに終わる）
+            job = p.job = ++jobCounter;
+        }
+        else
+        {
+            job = ++jobCounter;
+            pending[key] = { file, sampleRate, storageFormat, job, false, true, wantPrefix };
+        }
+    }
+
+    if (alreadyLoaded)
+    {
+        sendChangeMessage();
+        return;
+    }
+
+    loadPool.addJob ([this, key, job] { runPending (key, job, loadFormatManager); });
+}
+
+void SampleCache::requestResample (std::shared_ptr<const DecodedSample> source, double sampleRate)
+{
+    jassert (source != nullptr);
+
+    // 変換自体はディスクキャッシュの変換プールで並列に走る
+    loadPool.addJob ([this, source, sampleRate]
+    {
+        auto converted = diskCache.resample (*source, sampleRate); // 確保できなければ null
+
+        {
+            const juce::ScopedLock sl (lock);
+            loaded.push_back ({ juce::File(), sampleRate, std::move (converted), true, source });
+        }
+
+        sendChangeMessage();
+    });
+}
+
+void SampleCache::runPending (const juce::String& key, juce::uint32 job, juce::AudioFormatManager& formatManagerToUse)
+{
+    Pending request;
+
+    {
+        const juce::ScopedLock sl (lock);
+        auto it = pending.find (key);
+        if (it == pending.end() || it->second.job != job)
+            return; // キャンセルされた、または別のジョブが読んでいる
+
+        it->second.started = true;
+        request = it->second;
+    }
+
+    // 途中の先頭部分はキャッシュに入れない（メモリ上の一時的なもの）
+    // 届けるかどうかはその時点で決める（デコード中に合流したロードにも届く）
+    auto onPrefix = [this, key, request] (std::shared_ptr<const DecodedSample> prefix)
+    {
+        {
+            const juce::ScopedLock sl (lock);
+            auto it = pending.find (key);
+            if (it == pending.end() || ! it->second.wantPrefix)
+                return;
+
+            loaded.push_back ({ request.file, request.sampleRate, std::move (prefix), false });
+        }
+
+        sendChangeMessage();
+    };
+
+    auto sample = diskCache.open (formatManagerToUse, request.file, request.sampleRate, request.format, onPrefix);
+
+    if (sample != nullptr)
+        sample = insert (request.file, request.sampleRate, std::move (sample));
+
+    {
+        const juce::ScopedLock sl (lock);
+        auto it = pending.find (key);
+        const bool deliver = it != pending.end() && it->second.deliver;
+
+        if (it != pending.end())
+            pending.erase (it);
+
+        if (! deliver)
+            return;
+
+        loaded.push_back ({ request.file, request.sampleRate, std::move (sample), true });
+    }
+
+    sendChangeMessage();
+}
+
+std::vector<SampleCache::Loaded> SampleCache::collectLoaded()
+{
+    std::vector<Loaded> result;
+
+    const juce::ScopedLock sl (lock);
+    result.swap (loaded);
+    return result;
+}
+
+void SampleCache::setStorageFormat (DecodedSample::Format format)
+{
+    const juce::ScopedLock sl (lock);
+    storageFormat = format;
+}
+
+DecodedSample::Format SampleCache::getStorageFormat() const
+{
+    const juce::ScopedLock sl (lock);
+    return storageFormat;
+}
+
+void SampleCache::setMemoryBudget (size_t bytes)
+{
+    const juce::ScopedLock sl (lock);
+    memoryBudget = bytes;
+    evictIdleOverBudget();
+}
+
+size_t SampleCache::getMemoryBudget() const
+{
+    const juce::ScopedLock sl (lock);
+    return memoryBudget;
+}
+
+size_t SampleCache::getTotalBytes() const
+{
+    const juce::ScopedLock sl (lock);
+    return totalBytes;
+}
+
+std::vector<SampleCache::Usage> SampleCache::getUsage() const
+{
+    std::vector<std::pair<juce::uint32, Usage>> sorted;
+
+    {
+        const juce::ScopedLock sl (lock);
+        sorted.reserve (items.size());
+
+        for (const auto& [key, item] : items)
+            sorted.push_back ({ item.lastUsed, { item.file, item.bytes, item.sample->isMapped(), item.sample.use_count() > 1 } });
+    }
+
+    std::sort (sorted.begin(), sorted.end(), [] (const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::vector<Usage> usage;
+    usage.reserve (sorted.size());
+    for (auto& s : sorted)
+        usage.push_back (std::move (s.second));
+
+    return usage;
+}
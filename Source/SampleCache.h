@@ -0,0 +1,128 @@
+/*
+ ==============================================================================
+ SampleCache.h
+ ==============================================================================
+ ロード済みサンプルの一元管理（メモリ予算つき LRU）。
+
+ • スロット・デッキ・プリフェッチはすべてここからサンプルを受け取る
+   同じファイルを複数スロットに載せてもデータは1つ
+ • 使用中 = キャッシュ以外にも shared_ptr の持ち主がいる（参照カウント）
+   使用中のものは追い出さない。予算を超えたら使われていないものを古い順に解放
+ • プリフェッチは専用スレッドでディスクキャッシュを温め、メモリにも載せる
+   （次に選ばれそうなライブラリの行など）
+ • スロット用のロードは別スレッドで行い、キャンセルされない
+   完了したら sendChangeMessage → collectLoaded で受け取る（同期デコード無し）
+   頼めば長いファイルはデコード途中の先頭部分も先に届く (complete = false)
+ • ファイルを持たないサンプル（キュー区間の切り出し）のレート変換も同じスレッドで行い、
+   同じように届ける（キャッシュには入れない）
+ • 読み込み中のものはプリフェッチ・ロードをまとめて 1 つの表で持つ（同じキーを二重にデコードしない）
+   実行中のプリフェッチにロードが来たら合流して、その結果を届ける
+ • サンプルごとのメモリ使用量を報告できる
+   マップしたサンプルはファイルサイズ分を計上（ページキャッシュに載る上限）
+ • 保存形式を int16 にするとサンプルあたりのメモリが半分
+   （切り替え後に読み込むものから適用。読み込み済みのものはそのまま使える）
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "DecodedSampleCache.h"
+
+class SampleCache : public juce::ChangeBroadcaster
+{
+public:
+    struct Usage
+    {
+        juce::File file;
+        size_t bytes = 0;
+        bool mapped = false;  // ディスクキャッシュをマップ（false = ヒープ上）
+        bool inUse = false;   // スロット・デッキが参照中
+    };
+
+    struct Loaded
+    {
+        juce::File file;
+        double sampleRate = 0.0;
+        std::shared_ptr<const DecodedSample> sample; // 読めなかった場合は null
+        bool complete = true; // false = デコード途中の先頭部分（後で complete のものが届く）
+        std::shared_ptr<const DecodedSample> source; // requestResample の元（ファイルからのロードは null）
+    };
+
+    SampleCache (DecodedSampleCache& diskCacheToUse, size_t memoryBudgetBytes = 256u * 1024 * 1024);
+    ~SampleCache() override;
+
+    // メモリにあれば返す（デコードしない）
+    std::shared_ptr<const DecodedSample> findLoaded (const juce::File& file, double sampleRate) const;
+
+    // バックグラウンドで読み込んでおく（すでにあれば何もしない）
+    void prefetch (const juce::File& file, double sampleRate);
+    void cancelPrefetches();
+
+    // バックグラウンドでロードして結果を届ける（cancelPrefetches の影響を受けない）
+    // wantPrefix なら、デコードに時間のかかるものは再生できる先頭部分を先に届ける
+    void requestLoad (const juce::File& file, double sampleRate, bool wantPrefix = false);
+    // ファイルを持たないサンプルをバックグラウンドで sampleRate に変換して届ける（file は空、source = 元）
+    void requestResample (std::shared_ptr<const DecodedSample> source, double sampleRate);
+    // 届いた結果を受け取る（sendChangeMessage を受けたら呼ぶ）。受け取るまではキャッシュから追い出されない
+    std::vector<Loaded> collectLoaded();
+
+    // これから読み込むサンプルの保存形式（既定は float32）
+    void setStorageFormat (DecodedSample::Format format);
+    DecodedSample::Format getStorageFormat() const;
+
+    // 使われていないサンプルをメモリに残す上限（既定 256 MB。使用中のものは超えても解放しない）
+    void setMemoryBudget (size_t bytes);
+    size_t getMemoryBudget() const;
+    size_t getTotalBytes() const;
+    std::vector<Usage> getUsage() const; // 最近使った順
+
+private:
+    struct Item
+    {
+        juce::File file;
+        double sampleRate = 0.0;
+        std::shared_ptr<const DecodedSample> sample;
+        size_t bytes = 0;
+        juce::uint32 lastUsed = 0;
+    };
+
+    // 読み込み中のキー（プリフェッチ・ロード共通）
+    struct Pending
+    {
+        juce::File file;
+        double sampleRate = 0.0;
+        DecodedSample::Format format = DecodedSample::Format::float32;
+        juce::uint32 job = 0;     // このキーを読むジョブ。番号が違うジョブは自分の番が来ても何もしない
+        bool started = false;     // ジョブがデコードを始めた（キャンセル・追い越しできない）
+        bool deliver = false;     // requestLoad の結果として collectLoaded へ届ける
+        bool wantPrefix = false;
+    };
+
+    static juce::String makeKey (const juce::File& file, double sampleRate, DecodedSample::Format format);
+    static size_t measure (const DecodedSample& sample);
+
+    // pending[key] のジョブ本体（プリフェッチ・ロードのスレッドから）
+    void runPending (const juce::String& key, juce::uint32 job, juce::AudioFormatManager& formatManagerToUse);
+
+    std::shared_ptr<const DecodedSample> insert (const juce::File& file, double sampleRate,
+                                                 std::shared_ptr<const DecodedSample> sample);
+    void evictIdleOverBudget(); // lock を保持して呼ぶ
+
+    DecodedSampleCache& diskCache;
+    juce::AudioFormatManager prefetchFormatManager;  // プリフェッチスレッド用
+    juce::AudioFormatManager loadFormatManager;      // ロードスレッド用
+
+    mutable juce::CriticalSection lock;
+    std::unordered_map<juce::String, Item> items;
+    std::unordered_map<juce::String, Pending> pending;
+    juce::uint32 jobCounter = 0;
+    std::vector<Loaded> loaded;
+    size_t memoryBudget;
+    size_t totalBytes = 0;
+    DecodedSample::Format storageFormat = DecodedSample::Format::float32;
+    juce::uint32 useCounter = 0;
+
+    juce::ThreadPool prefetchPool { 1 };
+    juce::ThreadPool loadPool { 1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleCache)
+};
@@ -6,20 +6,97 @@
 #include "SampleListComponent.h"
 #include "Constants.h"
 
-SampleListComponent::SampleListComponent(AudioEngine& engine)
-    : audioEngine(engine)
+namespace
+{
+    constexpr int headerHeight = 30;
+    constexpr int controlsHeight = 26;
+    constexpr int searchHeight = 26;
+    // 1 件の差し込みは後ろの行をずらすので、これより多く変わったら並べ直したほうが速い
+    constexpr size_t maxIncrementalUpdates = 256;
+    // 検索結果のうち、同じ一致度の中を並べ替え順に整えるのは先頭のこの行数だけ
+    // （1〜2 文字の問い合わせはライブラリのほとんどに一致するので、全部を並べると打鍵が詰まる）
+    constexpr size_t maxSortedMatches = 512;
+    const char* const libraryWildcard = "*.wav;*.aiff;*.mp3;*.flac;*.ogg";
+
+    juce::File getPeakFolder(const juce::File& libraryFolder)
+    {
+        return libraryFolder.getSiblingFile("LibraryPeaks");
+    }
+}
+
+SampleListComponent::SampleListComponent(AudioEngine& engine, const juce::File& libraryFolder)
+    : audioEngine(engine),
+      libraryIndex(libraryFolder.getSiblingFile("libraryIndex.dat")),
+      analyzer(getPeakFolder(libraryFolder)),
+      scanner(libraryFolder, libraryWildcard),
+      thumbnails(getPeakFolder(libraryFolder), SampleRowComponent::thumbnailWidth, SampleRowComponent::thumbnailHeight)
 {
     // ListBoxの設定
     listBox.setModel(this);
     listBox.setColour(juce::ListBox::backgroundColourId, Constants::bgDark);
     listBox.setRowHeight(44);
     addAndMakeVisible(listBox);
-    
-    updateFileList();
+
+    // 並べ替え
+    sortBox.addItem("Newest", static_cast<int>(SortMode::Newest));
+    sortBox.addItem("Name", static_cast<int>(SortMode::Name));
+    sortBox.addItem("Duration", static_cast<int>(SortMode::Duration));
+    sortBox.addItem("Loudness", static_cast<int>(SortMode::Loudness));
+    sortBox.addItem("Pitch", static_cast<int>(SortMode::Pitch));
+    sortBox.addItem("Tempo", static_cast<int>(SortMode::Tempo));
+    sortBox.setSelectedId(static_cast<int>(sortMode), juce::dontSendNotification);
+    sortBox.onChange = [this] {
+        sortMode = static_cast<SortMode>(sortBox.getSelectedId());
+        rebuildVisibleList();
+    };
+    addAndMakeVisible(sortBox);
+
+    // 絞り込み
+    filterBox.addItem("All", static_cast<int>(FilterMode::All));
+    filterBox.addItem("Short (< 2 s)", static_cast<int>(FilterMode::Short));
+    filterBox.addItem("Long (>= 2 s)", static_cast<int>(FilterMode::Long));
+    filterBox.addItem("Low voice", static_cast<int>(FilterMode::LowVoice));
+    filterBox.addItem("High voice", static_cast<int>(FilterMode::HighVoice));
+    filterBox.addItem("Has tempo", static_cast<int>(FilterMode::HasTempo));
+    filterBox.setSelectedId(static_cast<int>(filterMode), juce::dontSendNotification);
+    filterBox.onChange = [this] {
+        filterMode = static_cast<FilterMode>(filterBox.getSelectedId());
+        rebuildVisibleList();
+    };
+    addAndMakeVisible(filterBox);
+
+    // 検索（トライグラム索引を引くだけなので打鍵ごとに即時更新）
+    searchBox.setTextToShowWhenEmpty("Search name / tags (low, short, 120bpm...)", juce::Colours::white.withAlpha(0.4f));
+    searchBox.setColour(juce::TextEditor::backgroundColourId, Constants::bgDark);
+    searchBox.setColour(juce::TextEditor::outlineColourId, juce::Colours::white.withAlpha(0.15f));
+    searchBox.onTextChange = [this] { setSearchQuery(searchBox.getText()); };
+    searchBox.onEscapeKey = [this] { searchBox.clear(); setSearchQuery({}); };
+    addAndMakeVisible(searchBox);
+
+    // 前回のインデックスから即座に一覧を表示し、差分はバックグラウンドで検出
+    libraryIndex.load();
+    analyzer.addChangeListener(this);
+    scanner.addChangeListener(this);
+    thumbnails.addChangeListener(this);
+
+    libraryIndex.forEachEntry([this](LibraryIndex::EntryId id, const LibraryEntry& entry) {
+        searchIndex.update(id, entry);
+        if (! entry.analysed && ! entry.analysisFailed)
+            analyzer.enqueue(entry);
+    });
+
+    rebuildVisibleList();
+    scanner.start(libraryIndex);
 }
 
 SampleListComponent::~SampleListComponent()
 {
+    thumbnails.removeChangeListener(this);
+    scanner.removeChangeListener(this);
+    analyzer.removeChangeListener(this);
+
+    if (libraryIndex.isDirty())
+        libraryIndex.save();
 }
 
 void SampleListComponent::paint(juce::Graphics& g)
@@ -28,17 +105,34 @@ void SampleListComponent::paint(juce::Graphics& g)
     
     // ヘッダー
     g.setColour(juce::Colour::fromString("FF1E293B"));
-    g.fillRect(0, 0, getWidth(), 30);
+    g.fillRect(0, 0, getWidth(), headerHeight + searchHeight + controlsHeight);
     
     g.setColour(juce::Colours::white);
     g.setFont(juce::FontOptions(14.0f, juce::Font::bold));
-    g.drawText("Library", 10, 0, getWidth() - 20, 30, juce::Justification::centredLeft);
+    g.drawText("Library", 10, 0, getWidth() - 20, headerHeight, juce::Justification::centredLeft);
+
+    // 解析待ちの件数
+    const int pending = analyzer.getNumPending();
+    if (pending > 0)
+    {
+        g.setColour(juce::Colours::white.withAlpha(0.6f));
+        g.setFont(juce::FontOptions(11.0f));
+        g.drawText("Analysing " + juce::String(pending) + "...", 10, 0, getWidth() - 20, headerHeight,
+                   juce::Justification::centredRight);
+    }
 }
 
 void SampleListComponent::resized()
 {
     auto area = getLocalBounds();
-    area.removeFromTop(30); // ヘッダー分
+    area.removeFromTop(headerHeight); // ヘッダー分
+
+    searchBox.setBounds(area.removeFromTop(searchHeight).reduced(4, 2));
+
+    auto controls = area.removeFromTop(controlsHeight).reduced(4, 2);
+    sortBox.setBounds(controls.removeFromLeft(controls.getWidth() / 2).withTrimmedRight(2));
+    filterBox.setBounds(controls.withTrimmedLeft(2));
+
     listBox.setBounds(area);
 }
 
@@ -64,17 +158,14 @@ juce::Component* SampleListComponent::refreshComponentForRow(int rowNumber, bool
     
     if (rowComponent == nullptr)
     {
-        rowComponent = new SampleRowComponent(
-            [this, rowNumber] { renameFile(rowNumber); },
-            [this, rowNumber] { deleteFile(rowNumber); },
-            [this, rowNumber] { 
-                listBox.selectRow(rowNumber);
-                // selectedRowsChangedが呼ばれるので、そこで処理される
-            }
-        );
+        // 行コンポーネントは再利用されるので行番号はキャプチャしない（setRowIndex で更新）
+        rowComponent = new SampleRowComponent(*this);
     }
     
-    rowComponent->setFileName(sampleFiles[static_cast<size_t>(rowNumber)].getFileNameWithoutExtension());
+    const auto& entry = getRowEntry(rowNumber);
+    rowComponent->setFileName(entry.file.getFileNameWithoutExtension());
+    rowComponent->setDetails(formatDetails(entry));
+    rowComponent->setThumbnail(thumbnails.getThumbnail(entry)); // 無ければ描画依頼だけして後で更新
     rowComponent->setSelected(isRowSelected);
     rowComponent->setRowIndex(rowNumber);
     
@@ -84,50 +175,436 @@ juce::Component* SampleListComponent::refreshComponentForRow(int rowNumber, bool
 void SampleListComponent::selectedRowsChanged(int lastRowSelected)
 {
     selectedRow = lastRowSelected;
+    if (suppressSelectionCallback)
+        return;
+
+    // 選択したファイルはプレビューボイスでストリーミング再生（デッキは触らない）
     if (lastRowSelected >= 0 && lastRowSelected < static_cast<int>(sampleFiles.size()))
+        audioEngine.startPreview(getRowEntry(lastRowSelected).file);
+    else
+        audioEngine.stopPreview();
+
+    // 選択行（スロットに載せられそう）と前後の行を先読み。古い先読みは取り消す
+    audioEngine.getSampleCache().cancelPrefetches();
+    for (int row : { lastRowSelected, lastRowSelected + 1, lastRowSelected - 1 })
+        if (row >= 0 && row < static_cast<int>(sampleFiles.size()))
+            audioEngine.prefetchSample(getRowEntry(row).file);
+}
+
+void SampleListComponent::returnKeyPressed(int lastRowSelected)
+{
+    loadRowToDeck(lastRowSelected);
+}
+
+void SampleListComponent::loadRowToDeck(int row)
+{
+    if (row < 0 || row >= static_cast<int>(sampleFiles.size()))
+        return;
+
+    // ファイルをバッファにロードしてスクラッチ再生可能に
+    audioEngine.stopPreview();
+    audioEngine.loadFileToBuffer(getRowEntry(row).file);
+}
+
+void SampleListComponent::releasePreviewOf(const juce::File& file)
+{
+    if (audioEngine.getPreviewFile() == file)
+        audioEngine.stopPreview();
+}
+
+void SampleListComponent::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    if (source == &scanner)
     {
-        // ファイルをバッファにロードしてスクラッチ再生可能に
-        audioEngine.loadFileToBuffer(sampleFiles[static_cast<size_t>(lastRowSelected)]);
+        applyScanDelta();
+        return;
     }
+
+    if (source == &thumbnails)
+    {
+        // 見えている行だけ作り直される
+        std::vector<juce::File> missingPeaks;
+        if (thumbnails.collectRendered(missingPeaks))
+            listBox.updateContent();
+
+        // ピーク列の無い解析済みエントリ（古いインデックス）は解析し直す
+        for (const auto& file : missingPeaks)
+            if (auto* entry = libraryIndex.find(file))
+                analyzer.enqueue(*entry);
+        return;
+    }
+
+    if (source != &analyzer)
+        return;
+
+    // 並び順・絞り込みが変わるのは結果の届いた行だけなので、その行だけ入れ直す
+    const auto selected = getSelectedId();
+    std::vector<LibraryIndex::EntryId> changedIds;
+
+    for (const auto& result : analyzer.popResults())
+    {
+        if (libraryIndex.applyAnalysis(result))
+        {
+            const auto id = libraryIndex.getId(result.file);
+            if (! result.analysisFailed)
+                thumbnails.invalidate(result); // ピーク列が保存された
+            updateSearchIndex(id); // 解析タグが付く
+            changedIds.push_back(id);
+        }
+    }
+
+    if (! changedIds.empty())
+        updateVisibleEntries(changedIds, selected);
+
+    // 解析が一段落したらインデックスを保存
+    if (analyzer.getNumPending() == 0 && libraryIndex.isDirty())
+        libraryIndex.save();
+
+    repaint(0, 0, getWidth(), headerHeight);
+}
+
+void SampleListComponent::applyScanDelta()
+{
+    LibraryScanner::Delta delta;
+    if (! scanner.popDelta(delta))
+        return;
+
+    auto selected = getSelectedId();
+
+    // 差分だけをインデックスと表示リストへ反映（ローカル操作で反映済みのものは no-op）
+    // 削除を先に: 空いた ID は同じ差分の追加で再利用されることがある
+    for (const auto& file : delta.removed)
+    {
+        const auto id = libraryIndex.getId(file);
+        if (id == selected)
+            selected = LibraryIndex::invalidId;
+
+        eraseVisible(id);
+        if (auto* entry = libraryIndex.find(file))
+            thumbnails.forget(*entry);
+        searchIndex.remove(id);
+        libraryIndex.remove(file);
+    }
+
+    std::vector<LibraryIndex::EntryId> changedIds;
+    changedIds.reserve(delta.addedOrChanged.size());
+
+    for (const auto& changed : delta.addedOrChanged)
+    {
+        // スタンプ (サイズ/更新日時) が変わったものだけ解析キューへ
+        if (libraryIndex.addOrUpdate(changed.file, changed.fileSize, changed.modTime))
+            analyzer.enqueue(*libraryIndex.find(changed.file));
+
+        const auto id = libraryIndex.getId(changed.file);
+        updateSearchIndex(id);
+        changedIds.push_back(id);
+    }
+
+    if (libraryIndex.isDirty() && analyzer.getNumPending() == 0)
+        libraryIndex.save();
+
+    updateVisibleEntries(changedIds, selected);
+}
+
+void SampleListComponent::updateVisibleEntries(const std::vector<LibraryIndex::EntryId>& changedIds,
+                                               LibraryIndex::EntryId selected)
+{
+    if (changedIds.size() > maxIncrementalUpdates)
+    {
+        rebuildVisibleList(selected);
+        return;
+    }
+
+    // 並び順のキーが変わった行が残っていると二分探索が崩れるので、先に全部抜いてから入れ直す
+    for (const auto id : changedIds)
+        eraseVisible(id);
+
+    for (const auto id : changedIds)
+    {
+        if (! placeVisible(id))
+        {
+            rebuildVisibleList(selected);
+            return;
+        }
+    }
+
+    commitVisibleList(selected);
+}
+
+void SampleListComponent::addFile(const juce::File& file)
+{
+    if (! file.existsAsFile())
+        return;
+
+    if (libraryIndex.addOrUpdate(file, file.getSize(), file.getLastModificationTime().toMilliseconds()))
+        analyzer.enqueue(*libraryIndex.find(file));
+
+    const auto id = libraryIndex.getId(file);
+    updateSearchIndex(id);
+
+    const auto selected = getSelectedId();
+    if (placeVisible(id))
+        commitVisibleList(selected);
+    else
+        rebuildVisibleList(selected);
+}
+
+void SampleListComponent::setSearchQuery(const juce::String& query)
+{
+    const auto trimmed = query.trim();
+    if (trimmed == searchQuery)
+        return;
+
+    searchQuery = trimmed;
+    rebuildVisibleList();
+}
+
+void SampleListComponent::updateSearchIndex(LibraryIndex::EntryId id)
+{
+    if (id != LibraryIndex::invalidId)
+        searchIndex.update(id, libraryIndex.getEntry(id));
+}
+
+void SampleListComponent::rebuildVisibleList()
+{
+    // 選択中のエントリを覚えておき、並べ替え後も同じエントリを選択
+    rebuildVisibleList(getSelectedId());
 }
 
-void SampleListComponent::updateFileList()
+void SampleListComponent::rebuildVisibleList(LibraryIndex::EntryId previouslySelected)
 {
+    for (const auto id : sampleFiles)
+        visibleRows[id] = -1;
     sampleFiles.clear();
-    
-    auto libraryFolder = audioEngine.getLibraryFolder();
-    
-    // WAV, AIFF, MP3ファイルを検索
-    for (const auto& entry : juce::RangedDirectoryIterator(libraryFolder, false, "*.wav;*.aiff;*.mp3"))
+
+    if (searchQuery.isNotEmpty())
     {
-        sampleFiles.push_back(entry.getFile());
+        // 検索中は索引の順位（一致度順、同点は ID 順）のまま絞り込む
+        std::vector<float> scores;
+        for (const auto& match : searchIndex.search(searchQuery))
+        {
+            if (passesFilter(libraryIndex.getEntry(match.id), filterMode))
+            {
+                sampleFiles.push_back(match.id);
+                scores.push_back(match.score);
+            }
+        }
+
+        // 同点の組の中を並べ替え順に。見える先頭 maxSortedMatches 行に掛かる部分だけ partial_sort
+        // （それより後ろは一致度順・ID 順のまま）
+        // partial_sort は安定でないので、並べ替えのキーが同じなら ID 順（打鍵ごとに行が入れ替わらない）
+        const auto less = [this](LibraryIndex::EntryId a, LibraryIndex::EntryId b) {
+            const auto& entryA = libraryIndex.getEntry(a);
+            const auto& entryB = libraryIndex.getEntry(b);
+            if (compareEntries(entryA, entryB, sortMode))
+                return true;
+            return ! compareEntries(entryB, entryA, sortMode) && a < b;
+        };
+        const auto sortedEnd = std::min(sampleFiles.size(), maxSortedMatches);
+
+        for (size_t groupBegin = 0; groupBegin < sortedEnd;)
+        {
+            auto groupEnd = groupBegin + 1;
+            while (groupEnd < sampleFiles.size() && scores[groupEnd] == scores[groupBegin])
+                ++groupEnd;
+
+            const auto first = sampleFiles.begin() + static_cast<std::ptrdiff_t>(groupBegin);
+            std::partial_sort(first, sampleFiles.begin() + static_cast<std::ptrdiff_t>(std::min(groupEnd, sortedEnd)),
+                              sampleFiles.begin() + static_cast<std::ptrdiff_t>(groupEnd), less);
+            groupBegin = groupEnd;
+        }
+
+        reindexVisibleRows(0, sampleFiles.size());
+        commitVisibleList(previouslySelected);
+        return;
     }
-    
-    // 日付順にソート（新しいものが上）
-    std::sort(sampleFiles.begin(), sampleFiles.end(),
-        [](const juce::File& a, const juce::File& b) {
-            return a.getLastModificationTime() > b.getLastModificationTime();
-        });
-    
+
+    sampleFiles.reserve(static_cast<size_t>(libraryIndex.size()));
+    libraryIndex.forEachEntry([this](LibraryIndex::EntryId id, const LibraryEntry& entry) {
+        if (passesFilter(entry, filterMode))
+            sampleFiles.push_back(id);
+    });
+
+    std::stable_sort(sampleFiles.begin(), sampleFiles.end(),
+                     [this](LibraryIndex::EntryId a, LibraryIndex::EntryId b) {
+                         return compareEntries(libraryIndex.getEntry(a), libraryIndex.getEntry(b), sortMode);
+                     });
+
+    reindexVisibleRows(0, sampleFiles.size());
+    commitVisibleList(previouslySelected);
+}
+
+bool SampleListComponent::placeVisible(LibraryIndex::EntryId id)
+{
+    if (id == LibraryIndex::invalidId)
+        return true;
+
+    if (! passesFilter(libraryIndex.getEntry(id), filterMode))
+    {
+        eraseVisible(id);
+        return true;
+    }
+
+    // 検索中は一致度で並ぶので、挿入位置を求めず結果を引き直す
+    if (searchQuery.isNotEmpty())
+        return false;
+
+    const auto less = [this](LibraryIndex::EntryId a, LibraryIndex::EntryId b) {
+        return compareEntries(libraryIndex.getEntry(a), libraryIndex.getEntry(b), sortMode);
+    };
+
+    // 新しい行: ソート済みの位置に二分探索で挿入（全体の再ソートはしない）
+    const int currentRow = getVisibleRow(id);
+    if (currentRow < 0)
+    {
+        const auto position = std::upper_bound(sampleFiles.begin(), sampleFiles.end(), id, less);
+        const auto row = static_cast<size_t>(std::distance(sampleFiles.begin(), position));
+        sampleFiles.insert(position, id);
+        reindexVisibleRows(row, sampleFiles.size());
+        return true;
+    }
+
+    // 表示中の行: 自分を除いた並びで位置を探し、その間だけ回して移す
+    const auto from = sampleFiles.begin() + currentRow;
+    auto position = std::upper_bound(sampleFiles.begin(), from, id, less);
+    if (position == from)
+        position = std::upper_bound(from + 1, sampleFiles.end(), id, less);
+
+    if (position < from)
+    {
+        std::rotate(position, from, from + 1);
+        reindexVisibleRows(static_cast<size_t>(std::distance(sampleFiles.begin(), position)),
+                           static_cast<size_t>(std::distance(sampleFiles.begin(), from)) + 1);
+    }
+    else if (position > from + 1)
+    {
+        std::rotate(from, from + 1, position);
+        reindexVisibleRows(static_cast<size_t>(std::distance(sampleFiles.begin(), from)),
+                           static_cast<size_t>(std::distance(sampleFiles.begin(), position)));
+    }
+
+    return true;
+}
+
+void SampleListComponent::eraseVisible(LibraryIndex::EntryId id)
+{
+    const int currentRow = getVisibleRow(id);
+    if (currentRow < 0)
+        return;
+
+    const auto row = static_cast<size_t>(currentRow);
+    visibleRows[id] = -1;
+    sampleFiles.erase(sampleFiles.begin() + static_cast<std::ptrdiff_t>(row));
+    reindexVisibleRows(row, sampleFiles.size());
+}
+
+void SampleListComponent::reindexVisibleRows(size_t begin, size_t end)
+{
+    for (auto row = begin; row < end; ++row)
+    {
+        const auto id = sampleFiles[row];
+        if (id >= visibleRows.size())
+            visibleRows.resize(static_cast<size_t>(id) + 1, -1);
+        visibleRows[id] = static_cast<int>(row);
+    }
+}
+
+int SampleListComponent::getVisibleRow(LibraryIndex::EntryId id) const
+{
+    return id < visibleRows.size() ? visibleRows[id] : -1;
+}
+
+void SampleListComponent::commitVisibleList(LibraryIndex::EntryId selected)
+{
+    // 行数が減って ListBox が選択を外しても、プレビューの切り替えは起こさない
+    const juce::ScopedValueSetter<bool> svs(suppressSelectionCallback, true);
     listBox.updateContent();
+    restoreSelection(selected);
 }
 
-void SampleListComponent::refreshLibrary()
+void SampleListComponent::restoreSelection(LibraryIndex::EntryId selected)
 {
-    updateFileList();
+    // 行が動いても選択エントリを維持（デッキへの再ロードは起こさない）
+    const juce::ScopedValueSetter<bool> svs(suppressSelectionCallback, true);
+    const int row = getVisibleRow(selected);
+
+    if (row >= 0)
+        listBox.selectRow(row, true);
+    else
+        listBox.deselectAllRows();
+
+    listBox.repaint();
 }
 
-juce::File SampleListComponent::getSelectedFile() const
+LibraryIndex::EntryId SampleListComponent::getSelectedId() const
 {
-    // ListBoxの選択状態を直接取得
-    int row = listBox.getSelectedRow();
-    DBG("getSelectedFile called - ListBox selectedRow: " << row << ", sampleFiles count: " << sampleFiles.size());
+    const int row = listBox.getSelectedRow();
     if (row >= 0 && row < static_cast<int>(sampleFiles.size()))
-    {
-        DBG("Returning file: " << sampleFiles[static_cast<size_t>(row)].getFullPathName());
         return sampleFiles[static_cast<size_t>(row)];
+    return LibraryIndex::invalidId;
+}
+
+bool SampleListComponent::compareEntries(const LibraryEntry& a, const LibraryEntry& b, SortMode mode)
+{
+    // インデックスに持っている値だけで比較（stat/デコード無し）
+    switch (mode)
+    {
+        case SortMode::Name:     return a.file.getFileName().compareNatural(b.file.getFileName()) < 0;
+        case SortMode::Duration: return a.durationSeconds < b.durationSeconds;
+        case SortMode::Loudness: return a.loudnessLufs > b.loudnessLufs;
+        case SortMode::Pitch:    return a.medianPitchHz < b.medianPitchHz;
+        case SortMode::Tempo:    return a.tempoBpm < b.tempoBpm;
+        case SortMode::Newest:
+        default:                 return a.modTime > b.modTime; // 新しいものが上
     }
-    return juce::File();
+}
+
+bool SampleListComponent::passesFilter(const LibraryEntry& entry, FilterMode mode)
+{
+    // 未解析のファイルは解析フィルタでは除外しない（結果が届き次第反映）
+    if (mode == FilterMode::All || ! entry.analysed)
+        return true;
+
+    switch (mode)
+    {
+        case FilterMode::Short:     return entry.durationSeconds < 2.0;
+        case FilterMode::Long:      return entry.durationSeconds >= 2.0;
+        case FilterMode::LowVoice:  return entry.medianPitchHz > 0.0f && entry.medianPitchHz < 165.0f;
+        case FilterMode::HighVoice: return entry.medianPitchHz >= 165.0f;
+        case FilterMode::HasTempo:  return entry.tempoBpm > 0.0f;
+        case FilterMode::All:
+        default:                    return true;
+    }
+}
+
+juce::String SampleListComponent::formatDetails(const LibraryEntry& entry)
+{
+    if (entry.analysisFailed)
+        return "unreadable";
+    if (! entry.analysed)
+        return "...";
+
+    juce::String text = juce::String(entry.durationSeconds, 1) + " s  "
+                      + juce::String(juce::roundToInt(entry.loudnessLufs)) + " LUFS";
+
+    if (entry.medianPitchHz > 0.0f)
+        text << "  " << juce::String(juce::roundToInt(entry.medianPitchHz)) << " Hz";
+    if (entry.tempoBpm > 0.0f)
+        text << "  " << juce::String(juce::roundToInt(entry.tempoBpm)) << " BPM";
+
+    return text;
+}
+
+void SampleListComponent::refreshLibrary()
+{
+    scanner.requestScan();
+}
+
+juce::File SampleListComponent::getSelectedFile() const
+{
+    // ListBoxの選択状態を直接取得
+    const auto id = getSelectedId();
+    return id != LibraryIndex::invalidId ? libraryIndex.getEntry(id).file : juce::File();
 }
 
 void SampleListComponent::clearSelection()
@@ -140,7 +617,7 @@ void SampleListComponent::renameFile(int row)
     if (row < 0 || row >= static_cast<int>(sampleFiles.size()))
         return;
     
-    auto file = sampleFiles[static_cast<size_t>(row)];
+    auto file = getRowEntry(row).file;
     auto currentName = file.getFileNameWithoutExtension();
     
     auto* alertWindow = new juce::AlertWindow("Rename", "Enter new name:", juce::MessageBoxIconType::QuestionIcon);
@@ -156,9 +633,28 @@ void SampleListComponent::renameFile(int row)
                 if (newName.isNotEmpty())
                 {
                     auto newFile = file.getParentDirectory().getChildFile(newName + file.getFileExtension());
+                    releasePreviewOf(file);
                     if (file.moveFileTo(newFile))
                     {
-                        updateFileList();
+                        // キューマーカーのキャッシュも一緒に移動
+                        VoiceSegmenter::getCueFileFor(file).moveFileTo(VoiceSegmenter::getCueFileFor(newFile));
+
+                        // インデックスは O(1) でリネーム（ID・解析結果は引き継ぎ）
+                        // 名前順のときは位置が変わるので、その行だけ移す
+                        const auto id = libraryIndex.getId(file);
+                        const auto replaced = libraryIndex.getId(newFile); // 上書きされる側
+                        const auto selected = getSelectedId();
+                        eraseVisible(replaced);
+                        searchIndex.remove(replaced);
+                        if (id != LibraryIndex::invalidId)
+                            thumbnails.moved(libraryIndex.getEntry(id), newFile);
+                        libraryIndex.rename(file, newFile);
+                        updateSearchIndex(id);
+
+                        if (placeVisible(id))
+                            commitVisibleList(selected);
+                        else
+                            rebuildVisibleList(selected);
                     }
                 }
             }
@@ -171,7 +667,7 @@ void SampleListComponent::deleteFile(int row)
     if (row < 0 || row >= static_cast<int>(sampleFiles.size()))
         return;
     
-    auto file = sampleFiles[static_cast<size_t>(row)];
+    auto file = getRowEntry(row).file;
     
     auto options = juce::MessageBoxOptions()
         .withIconType(juce::MessageBoxIconType::WarningIcon)
@@ -184,8 +680,16 @@ void SampleListComponent::deleteFile(int row)
         [this, file](int result) {
             if (result == 1) // Delete button
             {
+                releasePreviewOf(file);
                 file.deleteFile();
-                updateFileList();
+                VoiceSegmenter::getCueFileFor(file).deleteFile();
+                const auto selected = getSelectedId();
+                eraseVisible(libraryIndex.getId(file));
+                commitVisibleList(selected);
+                if (auto* entry = libraryIndex.find(file))
+                    thumbnails.forget(*entry);
+                searchIndex.remove(libraryIndex.getId(file));
+                libraryIndex.remove(file);
             }
         });
 }
\ No newline at end of file
@@ -1,104 +1,211 @@
-/*
- ==============================================================================
- SampleListComponent.h
- ==============================================================================
- */
-#pragma once
-#include <JuceHeader.h>
-#include "AudioEngine.h"
-
-// カスタム行コンポーネント
-class SampleRowComponent : public juce::Component
-{
-public:
-	SampleRowComponent(std::function<void()> onRename, std::function<void()> onDelete,
-	                   std::function<void()> onSelect)
-		: renameCallback(onRename), deleteCallback(onDelete), selectCallback(onSelect)
-	{
-		renameButton.setButtonText(juce::String::fromUTF8("✏️"));
-		renameButton.onClick = [this] { if (renameCallback) renameCallback(); };
-		renameButton.setColour(juce::TextButton::buttonColourId, juce::Colours::transparentBlack);
-		addAndMakeVisible(renameButton);
-		
-		deleteButton.setButtonText(juce::String::fromUTF8("🗑️"));
-		deleteButton.onClick = [this] { if (deleteCallback) deleteCallback(); };
-		deleteButton.setColour(juce::TextButton::buttonColourId, juce::Colours::transparentBlack);
-		addAndMakeVisible(deleteButton);
-	}
-	
-	void setFileName(const juce::String& name) { fileName = name; repaint(); }
-	void setSelected(bool selected) { isSelected = selected; repaint(); }
-	void setRowIndex(int index) { rowIndex = index; repaint(); }
-	
-	void paint(juce::Graphics& g) override
-	{
-		if (isSelected)
-			g.fillAll(juce::Colour::fromString("FF3B82F6"));
-		else if (rowIndex % 2 == 0)
-			g.fillAll(juce::Colour::fromString("FF1E293B"));
-		else
-			g.fillAll(juce::Colour::fromString("FF0F172A"));
-		
-		g.setColour(juce::Colours::white);
-		g.setFont(juce::FontOptions(13.0f));
-		g.drawText(fileName, 8, 0, getWidth() - 90, getHeight(), juce::Justification::centredLeft, true);
-	}
-	
-	void resized() override
-	{
-		auto area = getLocalBounds();
-		deleteButton.setBounds(area.removeFromRight(40).reduced(2));
-		renameButton.setBounds(area.removeFromRight(40).reduced(2));
-	}
-	
-	void mouseDown(const juce::MouseEvent&) override
-	{
-		if (selectCallback) selectCallback();
-	}
-	
-private:
-	juce::TextButton renameButton, deleteButton;
-	juce::String fileName;
-	bool isSelected = false;
-	int rowIndex = 0;
-	std::function<void()> renameCallback;
-	std::function<void()> deleteCallback;
-	std::function<void()> selectCallback;
-};
-
-// Simple List Model
-class SampleListComponent : public juce::Component,
-public juce::ListBoxModel
-{
-	public:
-	SampleListComponent(AudioEngine& engine);
-	~SampleListComponent() override;
-
-	void paint(juce::Graphics& g) override;
-	void resized() override;
-
-	// ListBoxModel
-	int getNumRows() override;
-	void paintListBoxItem(int rowNumber, juce::Graphics& g, int width, int height, bool rowIsSelected) override;
-	void selectedRowsChanged(int lastRowSelected) override;
-	juce::Component* refreshComponentForRow(int rowNumber, bool isRowSelected, juce::Component* existingComponentToUpdate) override;
-
-	// File Management
-	void updateFileList();
-	void refreshLibrary(); // 外部から呼び出し用
-	juce::File getSelectedFile() const; // 選択中のファイルを取得
-	void clearSelection(); // 選択を解除
-
-	private:
-	AudioEngine& audioEngine;
-	juce::ListBox listBox;
-
-	std::vector<juce::File> sampleFiles;
-	int selectedRow = -1;
-
-	// ファイル操作
-	void renameFile(int row);
-	void deleteFile(int row);
-
-	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleListComponent)
-};
+/*
+ ==============================================================================
+ SampleListComponent.h
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "AudioEngine.h"
+#include "LibraryIndex.h"
+#include "LibraryAnalyzer.h"
+#include "LibraryScanner.h"
+#include "LibrarySearchIndex.h"
+#include "LibraryThumbnailCache.h"
+
+// カスタム行コンポーネント
+// ListBox が行を使い回すので、行番号はキャプチャせず setRowIndex() の値で通知する
+class SampleRowComponent : public juce::Component
+{
+public:
+	struct Listener
+	{
+		virtual ~Listener() = default;
+		virtual void rowRenameRequested(int row) = 0;
+		virtual void rowDeleteRequested(int row) = 0;
+		virtual void rowSelectRequested(int row) = 0;
+		virtual void rowLoadRequested(int row) = 0; // ダブルクリック: デッキへロード
+	};
+
+	explicit SampleRowComponent(Listener& rowListener)
+		: listener(rowListener)
+	{
+		renameButton.setButtonText(juce::String::fromUTF8("✏️"));
+		renameButton.onClick = [this] { listener.rowRenameRequested(rowIndex); };
+		renameButton.setColour(juce::TextButton::buttonColourId, juce::Colours::transparentBlack);
+		addAndMakeVisible(renameButton);
+		
+		deleteButton.setButtonText(juce::String::fromUTF8("🗑️"));
+		deleteButton.onClick = [this] { listener.rowDeleteRequested(rowIndex); };
+		deleteButton.setColour(juce::TextButton::buttonColourId, juce::Colours::transparentBlack);
+		addAndMakeVisible(deleteButton);
+	}
+	
+	void setFileName(const juce::String& name) { fileName = name; repaint(); }
+	void setDetails(const juce::String& text) { details = text; repaint(); }
+	void setSelected(bool selected) { isSelected = selected; repaint(); }
+	void setRowIndex(int index) { rowIndex = index; repaint(); }
+	void setThumbnail(const juce::Image& image) { thumbnail = image; repaint(); } // 無効なら非表示
+
+	static constexpr int thumbnailWidth = 96;
+	static constexpr int thumbnailHeight = 28;
+	
+	void paint(juce::Graphics& g) override
+	{
+		if (isSelected)
+			g.fillAll(juce::Colour::fromString("FF3B82F6"));
+		else if (rowIndex % 2 == 0)
+			g.fillAll(juce::Colour::fromString("FF1E293B"));
+		else
+			g.fillAll(juce::Colour::fromString("FF0F172A"));
+		
+		// ミニ波形（描画済みの画像を貼るだけ）
+		int textWidth = getWidth() - 90;
+		if (thumbnail.isValid() && textWidth > thumbnailWidth + 60)
+		{
+			textWidth -= thumbnailWidth + 6;
+			g.setOpacity(1.0f);
+			g.drawImageAt(thumbnail, 8 + textWidth + 4, (getHeight() - thumbnail.getHeight()) / 2);
+		}
+		
+		g.setColour(juce::Colours::white);
+		g.setFont(juce::FontOptions(13.0f));
+		
+		if (details.isEmpty())
+		{
+			g.drawText(fileName, 8, 0, textWidth, getHeight(), juce::Justification::centredLeft, true);
+			return;
+		}
+		
+		// 2行表示: ファイル名 + 解析結果
+		const int half = getHeight() / 2;
+		g.drawText(fileName, 8, 2, textWidth, half - 2, juce::Justification::bottomLeft, true);
+		g.setColour(juce::Colours::white.withAlpha(0.55f));
+		g.setFont(juce::FontOptions(10.5f));
+		g.drawText(details, 8, half + 1, textWidth, half - 3, juce::Justification::topLeft, true);
+	}
+	
+	void resized() override
+	{
+		auto area = getLocalBounds();
+		deleteButton.setBounds(area.removeFromRight(40).reduced(2));
+		renameButton.setBounds(area.removeFromRight(40).reduced(2));
+	}
+	
+	void mouseDown(const juce::MouseEvent&) override
+	{
+		listener.rowSelectRequested(rowIndex);
+	}
+
+	void mouseDoubleClick(const juce::MouseEvent&) override
+	{
+		listener.rowLoadRequested(rowIndex);
+	}
+	
+private:
+	juce::TextButton renameButton, deleteButton;
+	juce::String fileName;
+	juce::String details;
+	juce::Image thumbnail;
+	bool isSelected = false;
+	int rowIndex = 0;
+	Listener& listener;
+};
+
+// Simple List Model
+class SampleListComponent : public juce::Component,
+public juce::ListBoxModel,
+public juce::ChangeListener,
+private SampleRowComponent::Listener
+{
+	public:
+	SampleListComponent(AudioEngine& engine, const juce::File& libraryFolder);
+	~SampleListComponent() override;
+
+	void paint(juce::Graphics& g) override;
+	void resized() override;
+
+	// ListBoxModel
+	int getNumRows() override;
+	void paintListBoxItem(int rowNumber, juce::Graphics& g, int width, int height, bool rowIsSelected) override;
+	void selectedRowsChanged(int lastRowSelected) override;
+	juce::Component* refreshComponentForRow(int rowNumber, bool isRowSelected, juce::Component* existingComponentToUpdate) override;
+	void returnKeyPressed(int lastRowSelected) override; // Enter: デッキへロード
+
+	// ChangeListener (解析結果の受け取り)
+	void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+
+	// 並べ替え・絞り込み（インデックス上の値だけを使うので即時）
+	enum class SortMode { Newest = 1, Name, Duration, Loudness, Pitch, Tempo };
+	enum class FilterMode { All = 1, Short, Long, LowVoice, HighVoice, HasTempo };
+
+	// File Management
+	void refreshLibrary(); // 外部から呼び出し用（バックグラウンド再スキャン）
+	void addFile(const juce::File& file); // 保存直後のファイルを追加（インデックスは O(1)、表示行は二分探索で差し込む）
+	void setSearchQuery(const juce::String& query); // 空文字で検索解除。一致度順（同点を並べ替え順に整えるのは上位の行だけ）
+	juce::File getSelectedFile() const; // 選択中のファイルを取得
+	void clearSelection(); // 選択を解除
+
+	private:
+	AudioEngine& audioEngine;
+	juce::ListBox listBox;
+	juce::ComboBox sortBox;
+	juce::ComboBox filterBox;
+	juce::TextEditor searchBox;
+
+	// 永続インデックスとバックグラウンド解析
+	LibraryIndex libraryIndex;
+	LibraryAnalyzer analyzer;
+	LibraryScanner scanner;
+	LibraryThumbnailCache thumbnails; // 行のミニ波形（別スレッドで画像化 + LRU）
+	LibrarySearchIndex searchIndex; // ファイル名 + 解析タグのトライグラム索引
+	juce::String searchQuery;
+
+	// 表示行 → インデックスのエントリID（1行あたり4バイト、文字列のコピー無し）
+	std::vector<LibraryIndex::EntryId> sampleFiles;
+	// エントリID → 表示行（sampleFiles の逆引き、-1 = 非表示）。ID はページ内の連番で密なので配列で持ち、
+	// 行がずれた範囲だけ書き直す
+	std::vector<int> visibleRows;
+	int selectedRow = -1;
+	bool suppressSelectionCallback = false;
+
+	SortMode sortMode = SortMode::Newest;
+	FilterMode filterMode = FilterMode::All;
+
+	void applyScanDelta();
+	// 変わったエントリだけを表示リストへ反映（多すぎるとき・検索中は作り直す）
+	void updateVisibleEntries(const std::vector<LibraryIndex::EntryId>& changedIds, LibraryIndex::EntryId selected);
+	void rebuildVisibleList();
+	void rebuildVisibleList(LibraryIndex::EntryId selected); // 表示リストを編集した後は編集前の選択を渡す
+	// 表示リストの編集だけを行う（ListBox の更新と選択の復元は commitVisibleList でまとめて 1 回）
+	// placeVisible は並び順の位置へ入れる / 移す。検索中で引き直しが要るときは false
+	bool placeVisible(LibraryIndex::EntryId id);
+	void eraseVisible(LibraryIndex::EntryId id);
+	void reindexVisibleRows(size_t begin, size_t end);
+	int getVisibleRow(LibraryIndex::EntryId id) const;
+	void commitVisibleList(LibraryIndex::EntryId selected);
+	void restoreSelection(LibraryIndex::EntryId selected);
+	LibraryIndex::EntryId getSelectedId() const;
+	void updateSearchIndex(LibraryIndex::EntryId id);
+	static bool compareEntries(const LibraryEntry& a, const LibraryEntry& b, SortMode mode);
+	static bool passesFilter(const LibraryEntry& entry, FilterMode mode);
+	static juce::String formatDetails(const LibraryEntry& entry);
+
+	const LibraryEntry& getRowEntry(int row) const { return libraryIndex.getEntry(sampleFiles[static_cast<size_t>(row)]); }
+
+	// SampleRowComponent::Listener
+	void rowRenameRequested(int row) override { renameFile(row); }
+	void rowDeleteRequested(int row) override { deleteFile(row); }
+	void rowSelectRequested(int row) override { listBox.selectRow(row); } // selectedRowsChangedで処理
+	void rowLoadRequested(int row) override { loadRowToDeck(row); }
+
+	// 選択はプレビューのみ。デッキへのロードは明示的な操作（ダブルクリック / Enter）で
+	void loadRowToDeck(int row);
+	// 開いたままのファイルは移動・削除できない環境があるので先に閉じる
+	void releasePreviewOf(const juce::File& file);
+
+	// ファイル操作
+	void renameFile(int row);
+	void deleteFile(int row);
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleListComponent)
+};
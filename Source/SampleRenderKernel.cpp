@@ -0,0 +1,194 @@
+/*
+ ==============================================================================
+ SampleRenderKernel.cpp
+ ==============================================================================
+ */
+#include "SampleRenderKernel.h"
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define SCRATCHMYVOICE_KERNEL_SSE2 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+ #include <arm_neon.h>
+ #define SCRATCHMYVOICE_KERNEL_NEON 1
+#endif
+
+namespace
+{
+    constexpr float int16Scale = 1.0f / 32768.0f;
+
+    // window[ch][i - windowStart] を読んで補間。ループ（端で折り返し）したらそこで止め、書いた数を返す
+    // （折り返した後の位置は別の範囲を読むので、呼び出し側が次の範囲で続ける）
+    int interpolateRun (const float* const* window, juce::int64 windowStart, juce::int64 windowEnd,
+                        juce::int64 length, Playhead& position, double speed,
+                        float* const* dest, int numDestChannels, int destOffset, int numSamples) noexcept
+    {
+        // ループ中はレジスタに置く（書き戻しは抜けるときだけ）
+        auto index = position.index;
+        auto fraction = position.fraction;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float frac = static_cast<float> (fraction);
+
+            // バッファ範囲内にクランプ（さらに変換済みの範囲内に）
+            const auto i0 = juce::jlimit (windowStart, windowEnd - 1, juce::jlimit ((juce::int64) 0, length - 1, index)) - windowStart;
+            const auto i1 = juce::jlimit (windowStart, windowEnd - 1, juce::jlimit ((juce::int64) 0, length - 1, index + 1)) - windowStart;
+
+            for (int ch = 0; ch < numDestChannels; ++ch)
+            {
+                const float s0 = window[ch][i0];
+                const float s1 = window[ch][i1];
+                dest[ch][destOffset + i] = s0 + frac * (s1 - s0);
+            }
+
+            // Playhead::advance と同じ（端数に足して整数分を繰り上げる）
+            const double sum = fraction + speed;
+            const double carry = std::floor (sum);
+            index += static_cast<juce::int64> (carry);
+            fraction = sum - carry;
+
+            if (index >= length)
+            {
+                position = {};
+                return i + 1;
+            }
+
+            if (index < 0)
+            {
+                position = { length - 1, 0.0 };
+                return i + 1;
+            }
+        }
+
+        position = { index, fraction };
+        return numSamples;
+    }
+}
+
+// ── 形式変換 ─────────────────────────────────────────────────────────────────
+
+void SampleRenderKernel::convertInt16ToFloat (const juce::int16* source, float* dest, int num) noexcept
+{
+    int i = 0;
+
+   #if SCRATCHMYVOICE_KERNEL_SSE2
+    const __m128 scale = _mm_set1_ps (int16Scale);
+
+    for (; i + 8 <= num; i += 8)
+    {
+        // 8 個の int16 を 32bit に符号拡張（上位側へ unpack して算術シフト）
+        const __m128i packed = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (source + i));
+        const __m128i lo = _mm_srai_epi32 (_mm_unpacklo_epi16 (packed, packed), 16);
+        const __m128i hi = _mm_srai_epi32 (_mm_unpackhi_epi16 (packed, packed), 16);
+
+        _mm_storeu_ps (dest + i,     _mm_mul_ps (_mm_cvtepi32_ps (lo), scale));
+        _mm_storeu_ps (dest + i + 4, _mm_mul_ps (_mm_cvtepi32_ps (hi), scale));
+    }
+   #elif SCRATCHMYVOICE_KERNEL_NEON
+    const float32x4_t scale = vdupq_n_f32 (int16Scale);
+
+    for (; i + 8 <= num; i += 8)
+    {
+        const int16x8_t packed = vld1q_s16 (source + i);
+        const int32x4_t lo = vmovl_s16 (vget_low_s16 (packed));
+        const int32x4_t hi = vmovl_s16 (vget_high_s16 (packed));
+
+        vst1q_f32 (dest + i,     vmulq_f32 (vcvtq_f32_s32 (lo), scale));
+        vst1q_f32 (dest + i + 4, vmulq_f32 (vcvtq_f32_s32 (hi), scale));
+    }
+   #endif
+
+    for (; i < num; ++i)
+        dest[i] = static_cast<float> (source[i]) * int16Scale;
+}
+
+void SampleRenderKernel::convertFloatToInt16 (const float* source, juce::int16* dest, int num) noexcept
+{
+    // キャッシュ作成時に一度だけ通る経路なのでスカラーで十分
+    for (int i = 0; i < num; ++i)
+        dest[i] = static_cast<juce::int16> (juce::roundToInt (juce::jlimit (-1.0f, 1.0f, source[i]) * 32767.0f));
+}
+
+// ── 描画 ─────────────────────────────────────────────────────────────────────
+
+void SampleRenderKernel::render (const DecodedSample& sample, juce::int64 length, Playhead& position, double speed,
+                                 float* const* dest, int numDestChannels, int numSamples) noexcept
+{
+    const int numSourceChannels = juce::jmin (maxChannels, sample.getNumChannels());
+    length = juce::jmin (length, sample.getAvailableSamples()); // デコード途中なら揃った先頭だけ
+
+    if (sample.getFormat() == DecodedSample::Format::int16)
+    {
+        const juce::int16* source[maxChannels] = {};
+        for (int ch = 0; ch < numSourceChannels; ++ch)
+            source[ch] = sample.getInt16ReadPointer (ch);
+
+        renderInt16 (source, numSourceChannels, length, position, speed, dest, numDestChannels, numSamples);
+        return;
+    }
+
+    const float* source[maxChannels] = {};
+    for (int ch = 0; ch < numSourceChannels; ++ch)
+        source[ch] = sample.getReadPointer (ch);
+
+    render (source, numSourceChannels, length, position, speed, dest, numDestChannels, numSamples);
+}
+
+void SampleRenderKernel::render (const float* const* source, int numSourceChannels, juce::int64 length, Playhead& position,
+                                 double speed, float* const* dest, int numDestChannels, int numSamples) noexcept
+{
+    if (length <= 0 || numSourceChannels <= 0)
+        return;
+
+    numDestChannels = juce::jmin (numDestChannels, maxChannels);
+
+    // モノラルは全出力チャンネルへ
+    const float* window[maxChannels];
+    for (int ch = 0; ch < numDestChannels; ++ch)
+        window[ch] = source[juce::jmin (ch, numSourceChannels - 1)];
+
+    for (int done = 0; done < numSamples;)
+        done += interpolateRun (window, 0, length, length, position, speed,
+                                dest, numDestChannels, done, numSamples - done);
+}
+
+void SampleRenderKernel::renderInt16 (const juce::int16* const* source, int numSourceChannels, juce::int64 length,
+                                      Playhead& position, double speed, float* const* dest, int numDestChannels,
+                                      int numSamples) noexcept
+{
+    if (length <= 0 || numSourceChannels <= 0)
+        return;
+
+    numDestChannels = juce::jmin (numDestChannels, maxChannels);
+
+    const float* window[maxChannels];
+    for (int ch = 0; ch < numDestChannels; ++ch)
+        window[ch] = scratch[juce::jmin (ch, numSourceChannels - 1)];
+
+    const int numToConvert = juce::jmin (numDestChannels, numSourceChannels);
+    const double absSpeed = std::abs (speed);
+
+    for (int done = 0; done < numSamples;)
+    {
+        // サブブロックが読むソース範囲が windowSize に収まる長さにする
+        // （範囲 = 速度 × (n - 1) + 補間の 1 サンプル + 端数の 1 サンプル）
+        int n = juce::jmin (numSamples - done, maxSubBlock);
+        if (absSpeed * (n - 1) > windowSize - 3)
+            n = juce::jmax (1, static_cast<int> ((windowSize - 3) / absSpeed) + 1);
+
+        // 範囲は index からの相対で求める（大きな位置でも端数を失わない）
+        const double lastOffset = position.fraction + speed * (n - 1);
+        const auto first = position.index + static_cast<juce::int64> (std::floor (juce::jmin (position.fraction, lastOffset)));
+        const auto last = position.index + static_cast<juce::int64> (std::floor (juce::jmax (position.fraction, lastOffset)));
+        const auto windowStart = juce::jlimit ((juce::int64) 0, length - 1, first);
+        const auto windowEnd = juce::jlimit (windowStart + 1, juce::jmin (length, windowStart + windowSize), last + 2);
+
+        for (int ch = 0; ch < numToConvert; ++ch)
+            convertInt16ToFloat (source[ch] + windowStart, scratch[ch], static_cast<int> (windowEnd - windowStart));
+
+        // 途中で折り返したら、次の位置から範囲を取り直す
+        done += interpolateRun (window, windowStart, windowEnd, length, position, speed,
+                                dest, numDestChannels, done, n);
+    }
+}
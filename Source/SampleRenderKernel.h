@@ -0,0 +1,79 @@
+/*
+ ==============================================================================
+ SampleRenderKernel.h
+ ==============================================================================
+ デッキのスクラッチ再生カーネル（線形補間 + ループ）。
+
+ • float32 のサンプルは直接補間する
+ • int16（コンパクト形式）のサンプルは、短いサブブロックごとに
+   そのブロックが読む範囲だけを SIMD (SSE2 / NEON) で float へ変換してから補間
+   → 全体を float に展開しないのでメモリ・キャッシュ占有は半分のまま
+ • 変換用のスクラッチは固定長のメンバー（オーディオスレッドで確保しない）
+ • ループ・端のクランプの挙動は従来の 1 サンプルずつのループと同じ
+ • 再生位置は 64bit のフレーム番号 + [0, 1) の小数部 (Playhead)
+   → 数時間の素材の後半でも補間の精度が先頭と変わらない
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "DecodedSampleCache.h"
+
+// スクラッチの再生位置（整数部 + 小数部）
+// double 1 つで持つと位置が大きいほど小数部の桁が減るので、フレーム番号と端数に分ける
+struct Playhead
+{
+    juce::int64 index = 0;
+    double fraction = 0.0; // [0, 1)
+
+    static Playhead fromPosition (double position) noexcept
+    {
+        const double whole = std::floor (position);
+        return { static_cast<juce::int64> (whole), position - whole };
+    }
+
+    double toPosition() const noexcept { return static_cast<double> (index) + fraction; }
+
+    void advance (double delta) noexcept
+    {
+        // 端数にだけ足して、はみ出た整数分を index へ繰り上げる（精度は位置によらない）
+        const double sum = fraction + delta;
+        const double carry = std::floor (sum);
+        index += static_cast<juce::int64> (carry);
+        fraction = sum - carry;
+    }
+};
+
+class SampleRenderKernel
+{
+public:
+    static constexpr int maxChannels = 2;
+
+    SampleRenderKernel() = default;
+
+    // sample の [0, length) を position から speed ずつ進めて dest へ numSamples 書く（上書き）
+    // モノラルのサンプルは全出力チャンネルへ同じものを書く。position は更新される
+    void render (const DecodedSample& sample, juce::int64 length, Playhead& position, double speed,
+                 float* const* dest, int numDestChannels, int numSamples) noexcept;
+
+    // 録音バッファなど float の生データ用
+    void render (const float* const* source, int numSourceChannels, juce::int64 length, Playhead& position, double speed,
+                 float* const* dest, int numDestChannels, int numSamples) noexcept;
+
+    // ── 形式変換（SIMD） ──────────────────────────────────────────────
+    // int16 → float（× 1/32768）
+    static void convertInt16ToFloat (const juce::int16* source, float* dest, int num) noexcept;
+    // float → int16（±1 でクリップして丸める）
+    static void convertFloatToInt16 (const float* source, juce::int16* dest, int num) noexcept;
+
+private:
+    // 1 回の変換でカバーするソースの長さ（チャンネルあたり）と出力のサブブロック長
+    static constexpr int windowSize = 4096;
+    static constexpr int maxSubBlock = 256;
+
+    void renderInt16 (const juce::int16* const* source, int numSourceChannels, juce::int64 length, Playhead& position,
+                      double speed, float* const* dest, int numDestChannels, int numSamples) noexcept;
+
+    float scratch[maxChannels][windowSize];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleRenderKernel)
+};
@@ -11,13 +11,27 @@
 SampleSlotComponent::SampleSlotComponent(AudioEngine& engine)
     : audioEngine(engine)
 {
-    audioEngine.addChangeListener(this);
+    // ラベル・色が変わるのはこれらが実際に変わったときだけ（再生位置などでは何もしない）
+    auto& state = audioEngine.getState();
+    auto onSlotsChanged = [this](int) { updateSlotLabels(); };
+    stateSubscriptions.push_back(state.currentBank.subscribe(onSlotsChanged));
+    stateSubscriptions.push_back(state.activeSlot.subscribe(onSlotsChanged));
+    stateSubscriptions.push_back(state.slotsRevision.subscribe(onSlotsChanged));
+    stateSubscriptions.push_back(state.cueRevision.subscribe(onSlotsChanged)); // CUES ボタン
     
-    const char* labels[] = { "A", "B", "C", "D" };
+    for (int bank = 0; bank < AudioEngine::NUM_BANKS; ++bank)
+        bankSelector.addItem("BANK " + juce::String(bank + 1), bank + 1);
+    bankSelector.setSelectedId(audioEngine.getCurrentBank() + 1, juce::dontSendNotification);
+    bankSelector.onChange = [this] {
+        // 切り替えは即座（未ロードのスロットは裏でロードされ、揃ったら色が変わる）
+        audioEngine.setCurrentBank(bankSelector.getSelectedId() - 1);
+        updateSlotLabels();
+    };
+    addAndMakeVisible(bankSelector);
     
     for (int i = 0; i < NUM_SLOTS; ++i)
     {
-        slotButtons[static_cast<size_t>(i)].setButtonText(labels[i]);
+        slotButtons[static_cast<size_t>(i)].setButtonText(getSlotLetter(i));
         slotButtons[static_cast<size_t>(i)].onClick = [this, i] {
             // コールバックがあれば選択ファイルをロード（上書き可）
             if (onSlotAssign)
@@ -25,8 +39,8 @@ SampleSlotComponent::SampleSlotComponent(AudioEngine& engine)
                 onSlotAssign(i);
             }
             
-            // スロットがロード済みならアクティブ化
-            if (audioEngine.isSlotLoaded(i))
+            // 割り当て済みならアクティブ化（ロード中ならロード完了時に切り替わる）
+            if (audioEngine.isSlotAssigned(i))
             {
                 audioEngine.setActiveSlot(i);
             }
@@ -34,13 +48,20 @@ SampleSlotComponent::SampleSlotComponent(AudioEngine& engine)
         };
         addAndMakeVisible(slotButtons[static_cast<size_t>(i)]);
     }
+
+    splitButton.setTooltip("Assign detected syllables to the slots of the current bank");
+    splitButton.onClick = [this] {
+        audioEngine.assignSegmentsToSlots();
+        updateSlotLabels();
+    };
+    addAndMakeVisible(splitButton);
     
     updateSlotLabels();
 }
 
 SampleSlotComponent::~SampleSlotComponent()
 {
-    audioEngine.removeChangeListener(this);
+    stateSubscriptions.clear();
 }
 
 void SampleSlotComponent::paint(juce::Graphics& g)
@@ -65,26 +86,45 @@ void SampleSlotComponent::resized()
 
     if (isHorizontal)
     {
-        // ── Horizontal layout for mobile (pill buttons in a row) ────────
+        // ── Horizontal layout for mobile (pill buttons in two rows) ─────
+        // 上段: バンク + 前半のスロット、下段: 後半のスロット + CUES
         // Use FlexBox for even distribution
-        juce::FlexBox flex;
-        flex.flexDirection = juce::FlexBox::Direction::row;
-        flex.justifyContent = juce::FlexBox::JustifyContent::spaceEvenly;
-        flex.alignItems = juce::FlexBox::AlignItems::stretch;
+        constexpr int slotsPerRow = (NUM_SLOTS + 1) / 2;
+        const auto topRow = area.removeFromTop(area.getHeight() / 2);
+        const juce::Rectangle<int> rows[] = { topRow, area };
+        int slot = 0;
+        bool firstRow = true;
 
-        for (int i = 0; i < NUM_SLOTS; ++i)
+        for (const auto& rowArea : rows)
         {
-            flex.items.add(juce::FlexItem(slotButtons[static_cast<size_t>(i)])
-                              .withMinWidth(50)
-                              .withFlex(1.0f));
-        }
+            juce::FlexBox flex;
+            flex.flexDirection = juce::FlexBox::Direction::row;
+            flex.justifyContent = juce::FlexBox::JustifyContent::spaceEvenly;
+            flex.alignItems = juce::FlexBox::AlignItems::stretch;
+
+            if (firstRow)
+                flex.items.add(juce::FlexItem(bankSelector).withMinWidth(70).withFlex(1.5f));
+
+            for (int i = 0; i < slotsPerRow && slot < NUM_SLOTS; ++i, ++slot)
+            {
+                flex.items.add(juce::FlexItem(slotButtons[static_cast<size_t>(slot)])
+                                  .withMinWidth(24)
+                                  .withFlex(1.0f));
+            }
+
+            if (! firstRow)
+                flex.items.add(juce::FlexItem(splitButton).withMinWidth(50).withFlex(1.5f));
 
-        flex.performLayout(area);
+            flex.performLayout(rowArea);
+            firstRow = false;
+        }
     }
     else
     {
         // ── Vertical layout for desktop (column) ────────────────────────
         area.removeFromTop(25); // タイトルスペース
+        bankSelector.setBounds(area.removeFromTop(28).reduced(2));
+        splitButton.setBounds(area.removeFromBottom(32).reduced(2));
         int slotHeight = area.getHeight() / NUM_SLOTS;
 
         for (int i = 0; i < NUM_SLOTS; ++i)
@@ -92,21 +132,20 @@ void SampleSlotComponent::resized()
             slotButtons[static_cast<size_t>(i)].setBounds(area.removeFromTop(slotHeight).reduced(2));
         }
     }
-}
 
-void SampleSlotComponent::changeListenerCallback(juce::ChangeBroadcaster*)
-{
+    // ラベルの長さは向きで変わる（状態の購読はレイアウトの変化では届かない）
     updateSlotLabels();
-    repaint();
 }
 
 void SampleSlotComponent::updateSlotLabels()
 {
-    const char* labels[] = { "A", "B", "C", "D" };
     const auto activeColor = juce::Colour::fromString("FF22C55E"); // 緑
     const auto loadedColor = juce::Colour::fromString("FF3B82F6"); // 青
+    const auto loadingColor = juce::Colour::fromString("FFF59E0B"); // 琥珀（裏でロード中）
     const auto emptyColor = juce::Colour::fromString("FF475569");  // グレー
     
+    bankSelector.setSelectedId(audioEngine.getCurrentBank() + 1, juce::dontSendNotification);
+    
     int activeSlot = audioEngine.getActiveSlot();
     bool isHorizontal = (getWidth() > getHeight() * 1.2f);
     
@@ -118,21 +157,23 @@ void SampleSlotComponent::updateSlotLabels()
         if (isHorizontal)
         {
             // Short label for horizontal (mobile) mode
-            label = juce::String(labels[i]);
-            if (audioEngine.isSlotLoaded(i))
-                label += " " + audioEngine.getSlotFileName(i).upToFirstChar();
+            label = getSlotLetter(i);
         }
         else
         {
             // Full label for vertical (desktop) mode
-            label = juce::String(labels[i]) + ": ";
-            if (audioEngine.isSlotLoaded(i))
+            label = getSlotLetter(i) + ": ";
+            if (audioEngine.isSlotAssigned(i))
                 label += audioEngine.getSlotFileName(i);
             else
                 label += "---";
         }
         
-        if (audioEngine.isSlotLoaded(i))
+        if (audioEngine.isSlotLoading(i))
+        {
+            btn.setColour(juce::TextButton::buttonColourId, loadingColor);
+        }
+        else if (audioEngine.isSlotLoaded(i))
         {
             if (i == activeSlot)
                 btn.setColour(juce::TextButton::buttonColourId, activeColor);
@@ -146,4 +187,10 @@ void SampleSlotComponent::updateSlotLabels()
         
         btn.setButtonText(label);
     }
+
+    // キューマーカーがあるときだけ一括割り当てを有効化
+    const auto numCues = static_cast<int>(audioEngine.getCueMarkers().size());
+    splitButton.setEnabled(numCues > 0);
+    splitButton.setButtonText(numCues > 0 ? "CUES " + juce::String(juce::jmin(numCues, NUM_SLOTS)) + "/" + juce::String(numCues)
+                                          : juce::String("CUES"));
 }
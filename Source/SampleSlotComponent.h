@@ -7,8 +7,7 @@
 #include <JuceHeader.h>
 #include "AudioEngine.h"
 
-class SampleSlotComponent : public juce::Component,
-                            public juce::ChangeListener
+class SampleSlotComponent : public juce::Component
 {
 public:
     SampleSlotComponent(AudioEngine& engine);
@@ -16,7 +15,6 @@ public:
 
     void paint(juce::Graphics& g) override;
     void resized() override;
-    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
     
     // スロット割り当てコールバックを設定
     void setSlotAssignCallback(std::function<void(int)> callback) { onSlotAssign = callback; }
@@ -24,10 +22,14 @@ public:
 private:
     AudioEngine& audioEngine;
     
-    static constexpr int NUM_SLOTS = 4;
+    static constexpr int NUM_SLOTS = AudioEngine::SLOTS_PER_BANK;
+    juce::ComboBox bankSelector; // 表示するバンク（スロットは現在のバンクのもの）
     std::array<juce::TextButton, NUM_SLOTS> slotButtons;
+    juce::TextButton splitButton { "CUES" }; // キュー区間を先頭のスロットから一括割り当て
     std::function<void(int)> onSlotAssign;
+    std::vector<EngineState::Subscription> stateSubscriptions; // バンク・スロット・キューが変わったときだけ
     
+    static juce::String getSlotLetter(int slotIndex) { return juce::String::charToString(static_cast<juce::juce_wchar>('A' + slotIndex)); }
     void updateSlotLabels();
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleSlotComponent)
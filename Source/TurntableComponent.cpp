@@ -7,38 +7,147 @@
  */
 #include "TurntableComponent.h"
 
-TurntableComponent::TurntableComponent(AudioEngine& engine)
-: audioEngine(engine)
+TurntableComponent::TurntableComponent(AudioEngine& engine, FrameScheduler& scheduler)
+: audioEngine(engine), frameScheduler(scheduler)
 {
-	startTimer(16); // ~60fps for smooth animation
+	frameScheduler.addClient(this);
 }
 
 TurntableComponent::~TurntableComponent()
 {
-	stopTimer();
+	frameScheduler.removeClient(this);
 }
 
-void TurntableComponent::paint(juce::Graphics& g)
-{
-	// --- 1. 背景色の変更 ---
-	// 画像からスポイトした濃いネイビー色
-	const auto bgNavy = juce::Colour::fromString("FF1A1C2B");
-	g.fillAll(bgNavy);
+// ─── Layout ──────────────────────────────────────────────────────────────────
 
-	// --- 描画エリアの計算 ---
+TurntableComponent::DiscLayout TurntableComponent::getDiscLayout() const
+{
+	DiscLayout layout;
 	auto area = getLocalBounds().toFloat();
 
 	// Issue #13: Responsive aspect ratio — maintain square disc within available bounds
 	float availableWidth = area.getWidth() - 80.0f;  // margins for arm
 	float availableHeight = area.getHeight() - 80.0f;
-	float diameter = juce::jmin(availableWidth, availableHeight) * 0.85f;
-	diameter = juce::jmax(diameter, 100.0f); // minimum disc size
+	layout.diameter = juce::jmin(availableWidth, availableHeight) * 0.85f;
+	layout.diameter = juce::jmax(layout.diameter, 100.0f); // minimum disc size
 
-	float radius = diameter / 2.0f;
-	auto center = area.getCentre();
+	layout.radius = layout.diameter / 2.0f;
+	layout.center = area.getCentre();
 
 	// レコード盤の正円領域
-	juce::Rectangle<float> discArea(center.x - radius, center.y - radius, diameter, diameter);
+	layout.discArea = juce::Rectangle<float>(layout.center.x - layout.radius, layout.center.y - layout.radius, layout.diameter, layout.diameter);
+	layout.labelDiameter = layout.diameter * 0.4f;
+
+	// ラベル層は影（回転後の (2, 2)）が収まるよう少し大きめの正方形
+	const float labelLayerSize = layout.labelDiameter + 8.0f;
+	layout.labelLayerArea = juce::Rectangle<float>(labelLayerSize, labelLayerSize).withCentre(layout.center);
+	return layout;
+}
+
+// ─── Paint ───────────────────────────────────────────────────────────────────
+// 静止している層（背景・盤・溝 / ラベル / トーンアーム）は画像にキャッシュし、
+// 毎フレームは「背景を貼る → ラベルを回転して貼る → アームを貼る」だけにする。
+// 溝とセンターホールは同心円なので回転しても変わらない → 回すのはラベル層だけ
+
+void TurntableComponent::paint(juce::Graphics& g)
+{
+	// 表示倍率（Retina 等）が変わったら描き直す（ぼやけないよう物理ピクセルで持つ）
+	const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+	if (scale != layerScale)
+	{
+		invalidateLayers();
+		layerScale = scale;
+	}
+
+	const auto layout = getDiscLayout();
+	const auto toLogical = juce::AffineTransform::scale(1.0f / layerScale);
+	const bool armDown = audioEngine.isPlaying() || isDragging;
+	paintedRotation = rotationAngle;
+	paintedArmDown = armDown;
+
+	// キャッシュ無し: キャッシュ導入前と同じく毎フレーム全部を描く（ベンチマークの比較用）
+	if (! layerCacheEnabled)
+	{
+		paintBase(g, layout);
+		{
+			juce::Graphics::ScopedSaveState rotated(g);
+			g.addTransform(juce::AffineTransform::rotation(rotationAngle, layout.center.x, layout.center.y));
+			paintLabel(g, layout);
+		}
+		paintArm(g, layout, armDown);
+		return;
+	}
+
+	if (! baseLayer.isValid())
+		baseLayer = renderLayer(getLocalBounds().toFloat(), false, [&layout](juce::Graphics& lg) { paintBase(lg, layout); });
+
+	if (! labelLayer.isValid())
+		labelLayer = renderLayer(layout.labelLayerArea, true, [&layout](juce::Graphics& lg) { paintLabel(lg, layout); });
+
+	// アーム層は画面全体ではなくアームを囲む範囲だけ（毎フレーム合成する透明画素を減らす）
+	const auto armArea = getArmGeometry(layout, armDown).bounds.getIntersection(getLocalBounds().toFloat());
+	auto& armLayer = armLayers[armDown ? 1 : 0];
+	if (! armLayer.isValid())
+		armLayer = renderLayer(armArea, true, [&layout, armDown](juce::Graphics& lg) { paintArm(lg, layout, armDown); });
+
+	g.drawImageTransformed(baseLayer, toLogical);
+
+	// ラベル層: 層の中心を原点に寄せてから回し、盤の中心へ
+	g.drawImageTransformed(labelLayer, toLogical
+		.translated(-layout.labelLayerArea.getWidth() * 0.5f, -layout.labelLayerArea.getHeight() * 0.5f)
+		.rotated(rotationAngle)
+		.translated(layout.center.x, layout.center.y));
+
+	g.drawImageTransformed(armLayer, toLogical.translated(armArea.getX(), armArea.getY()));
+}
+
+void TurntableComponent::resized()
+{
+	invalidateLayers();
+}
+
+void TurntableComponent::setLayerCacheEnabled(bool shouldCache)
+{
+	if (shouldCache == layerCacheEnabled)
+		return;
+
+	layerCacheEnabled = shouldCache;
+	invalidateLayers();
+	repaint();
+}
+
+void TurntableComponent::invalidateLayers()
+{
+	baseLayer = {};
+	labelLayer = {};
+	armLayers[0] = {};
+	armLayers[1] = {};
+}
+
+juce::Image TurntableComponent::renderLayer(juce::Rectangle<float> area, bool transparent,
+											const std::function<void(juce::Graphics&)>& paintLayer) const
+{
+	// area（コンポーネント座標）を物理ピクセルの画像に描く。描く側はコンポーネント座標のまま
+	const int width = juce::jmax(1, juce::roundToInt(area.getWidth() * layerScale));
+	const int height = juce::jmax(1, juce::roundToInt(area.getHeight() * layerScale));
+	juce::Image image(transparent ? juce::Image::ARGB : juce::Image::RGB, width, height, transparent);
+
+	juce::Graphics lg(image);
+	lg.addTransform(juce::AffineTransform::translation(-area.getX(), -area.getY()).scaled(layerScale));
+	paintLayer(lg);
+	return image;
+}
+
+void TurntableComponent::paintBase(juce::Graphics& g, const DiscLayout& layout)
+{
+	// --- 1. 背景色の変更 ---
+	// 画像からスポイトした濃いネイビー色
+	const auto bgNavy = juce::Colour::fromString("FF1A1C2B");
+	g.fillAll(bgNavy);
+
+	const auto& discArea = layout.discArea;
+	const auto center = layout.center;
+	const float radius = layout.radius;
 
 	// --- 2. レコード盤の描画（リッチバージョン） ---
 
@@ -74,15 +183,16 @@ void TurntableComponent::paint(juce::Graphics& g)
 		g.setColour(juce::Colour::fromString("FF2A2A2A"));
 		g.drawEllipse(center.x - (r + 1.0f), center.y - (r + 1.0f), (r + 1.0f) * 2.0f, (r + 1.0f) * 2.0f, 0.5f);
 	}
+}
 
+void TurntableComponent::paintLabel(juce::Graphics& g, const DiscLayout& layout)
+{
 	// --- 3. ラベルの描画 (紫グラデ + 文字) ---
-	float labelDiameter = diameter * 0.4f;
+	// 回転は貼るときにかけるので、ここでは角度 0 で描く
+	const auto center = layout.center;
+	const float labelDiameter = layout.labelDiameter;
 	juce::Rectangle<float> labelArea(center.x - labelDiameter/2, center.y - labelDiameter/2, labelDiameter, labelDiameter);
 
-	// 回転開始
-	g.saveState();
-	g.addTransform(juce::AffineTransform::rotation(rotationAngle, center.x, center.y));
-
 	// ラベルの影
 	g.setColour(juce::Colours::black.withAlpha(0.3f));
 	g.fillEllipse(labelArea.translated(2.0f, 2.0f));
@@ -119,35 +229,53 @@ void TurntableComponent::paint(juce::Graphics& g)
 	topHalf = topHalf.removeFromTop(topHalf.getHeight() / 2);
 	g.drawText("Scratch", topHalf.translated(0, -labelDiameter * 0.08f), juce::Justification::centredBottom, true);
 	g.drawText("MyVoice", labelArea.reduced(labelDiameter * 0.1f).withTrimmedTop(labelArea.getHeight() * 0.4f).translated(0, labelDiameter * 0.08f), juce::Justification::centredTop, true);
-	
-	g.restoreState();
 
-	// センターホール（メタリック）
-	float holeRadius = juce::jmax(6.0f, diameter * 0.035f);
+	// センターホール（メタリック）— 同心円なのでラベルと一緒に回しても見た目は同じ
+	float holeRadius = juce::jmax(6.0f, layout.diameter * 0.035f);
 	g.setColour(juce::Colour::fromString("FF444444"));
 	g.fillEllipse(center.x - holeRadius, center.y - holeRadius, holeRadius * 2, holeRadius * 2);
 	g.setColour(juce::Colours::black);
 	g.fillEllipse(center.x - holeRadius * 0.5f, center.y - holeRadius * 0.5f, holeRadius, holeRadius);
+}
 
+TurntableComponent::ArmGeometry TurntableComponent::getArmGeometry(const DiscLayout& layout, bool armDown)
+{
+	const auto& discArea = layout.discArea;
+	const float radius = layout.radius;
+
+	ArmGeometry arm;
+	arm.pivotCenter = { discArea.getX() - 30.0f, discArea.getY() - 30.0f };
+	arm.pivotRadius = juce::jmax(15.0f, radius * 0.08f);
+	arm.armWidth = juce::jmax(8.0f, radius * 0.08f);
+	arm.armAngle = armDown ? juce::MathConstants<float>::pi * 0.12f : 0.0f;
+
+	const float armLength = radius * 1.3f;
+	arm.armEnd = { arm.pivotCenter.x + std::cos(arm.armAngle) * armLength,
+				   arm.pivotCenter.y + std::sin(arm.armAngle) * armLength };
+
+	arm.cartLength = juce::jmax(20.0f, radius * 0.2f);
+	arm.cartWidth = arm.armWidth * 1.2f;
+
+	// ピボットとアームの両端を、いちばん太いもの（ピボット / 影付きの線 / 回したカートリッジ）の分だけ広げる
+	// +2 はアンチエイリアスの縁
+	const float cartridgeReach = juce::Point<float>(arm.cartWidth, arm.cartLength).getDistanceFromOrigin() * 0.5f + 3.0f;
+	const float margin = juce::jmax(arm.pivotRadius, arm.armWidth * 0.5f + 3.0f, cartridgeReach) + 2.0f;
+	arm.bounds = juce::Rectangle<float>(arm.pivotCenter, arm.armEnd).expanded(margin);
+	return arm;
+}
 
+void TurntableComponent::paintArm(juce::Graphics& g, const DiscLayout& layout, bool armDown)
+{
 	// --- 4. トーンアームの追加描画（リッチバージョン） ---
+	// 角度は 休止 / 再生中 の 2 通りだけなので、それぞれ 1 枚ずつキャッシュする
+	const auto arm = getArmGeometry(layout, armDown);
+	const float radius = layout.radius;
 
-	juce::Point<float> pivotCenter(discArea.getX() - 30.0f, discArea.getY() - 30.0f);
-	float pivotRadius = juce::jmax(15.0f, radius * 0.08f);
-	float armLength = radius * 1.3f;
-	float armWidth = juce::jmax(8.0f, radius * 0.08f);
-
-	float armAngle;
-	if (audioEngine.isPlaying() || isDragging) {
-		armAngle = juce::MathConstants<float>::pi * 0.12f;
-	} else {
-		armAngle = 0.0f;
-	}
-
-	juce::Point<float> armEnd(
-		pivotCenter.x + std::cos(armAngle) * armLength,
-		pivotCenter.y + std::sin(armAngle) * armLength
-	);
+	const auto pivotCenter = arm.pivotCenter;
+	const auto armEnd = arm.armEnd;
+	const float pivotRadius = arm.pivotRadius;
+	const float armWidth = arm.armWidth;
+	const float armAngle = arm.armAngle;
 
 	// アームの影
 	g.setColour(juce::Colours::black.withAlpha(0.4f));
@@ -164,8 +292,8 @@ void TurntableComponent::paint(juce::Graphics& g)
 	g.drawLine(armLine, armWidth);
 
 	// カートリッジ（リッチ版）
-	float cartLength = juce::jmax(20.0f, radius * 0.2f);
-	float cartWidth = armWidth * 1.2f;
+	const float cartLength = arm.cartLength;
+	const float cartWidth = arm.cartWidth;
 	
 	g.saveState();
 	g.addTransform(juce::AffineTransform::rotation(armAngle + juce::MathConstants<float>::halfPi, armEnd.x, armEnd.y));
@@ -202,10 +330,6 @@ void TurntableComponent::paint(juce::Graphics& g)
 	g.fillEllipse(pivotCenter.x - pivotRadius*0.3f, pivotCenter.y - pivotRadius*0.3f, pivotRadius*0.6f, pivotRadius*0.6f);
 }
 
-void TurntableComponent::resized()
-{
-}
-
 // ─── Mouse interaction (desktop fallback) ────────────────────────────────────
 
 void TurntableComponent::mouseDown(const juce::MouseEvent& e)
@@ -214,6 +338,7 @@ void TurntableComponent::mouseDown(const juce::MouseEvent& e)
 	lastAngle = getAngleFromPoint(e.position);
 	lastTime = juce::Time::getMillisecondCounterHiRes();
 	audioEngine.setScratchSpeed(0.0);
+	frameScheduler.requestFrames(); // アームを下ろす
 }
 
 void TurntableComponent::mouseDrag(const juce::MouseEvent& e)
@@ -243,7 +368,7 @@ void TurntableComponent::mouseDrag(const juce::MouseEvent& e)
 	lastAngle = currentAngle;
 	lastTime = currentTime;
 	
-	repaint();
+	frameScheduler.requestFrames();
 }
 
 void TurntableComponent::mouseUp(const juce::MouseEvent& e)
@@ -253,6 +378,7 @@ void TurntableComponent::mouseUp(const juce::MouseEvent& e)
 		audioEngine.setScratchSpeed(1.0);
 	else
 		audioEngine.setScratchSpeed(0.0);
+	frameScheduler.requestFrames(); // 止まっていればアームを戻す
 }
 
 // ─── Touch interaction (Issue #14) ───────────────────────────────────────────
@@ -275,6 +401,7 @@ void TurntableComponent::touchStarted(const juce::TouchEvent& e)
 		primaryTouch.isSwipeGesture = false;
 		isDragging = true;
 		audioEngine.setScratchSpeed(0.0);
+		frameScheduler.requestFrames();
 	}
 	else if (secondaryTouch.touchIndex < 0 && touches.size() >= 2)
 	{
@@ -410,7 +537,7 @@ void TurntableComponent::touchMoved(const juce::TouchEvent& e)
 		}
 	}
 
-	repaint();
+	frameScheduler.requestFrames();
 }
 
 void TurntableComponent::touchEnded(const juce::TouchEvent& e)
@@ -459,21 +586,24 @@ void TurntableComponent::touchEnded(const juce::TouchEvent& e)
 		else
 			audioEngine.setScratchSpeed(0.0);
 	}
+
+	frameScheduler.requestFrames();
 }
 
-// ─── Timer / Animation ──────────────────────────────────────────────────────
+// ─── Animation ───────────────────────────────────────────────────────────────
+// ドラッグ・タッチは角度を更新して requestFrames するだけ。描くのはここ（1 フレーム 1 回）
 
-void TurntableComponent::timerCallback()
+bool TurntableComponent::advanceFrame(const FrameScheduler::Frame& frame)
 {
-	if (!isDragging && audioEngine.isPlaying())
-	{
-		rotationAngle += 0.05f;
-		repaint();
-	}
-	else if (isDragging)
-	{
+	const bool playing = audioEngine.isPlaying();
+
+	if (!isDragging && playing)
+		rotationAngle += spinRadiansPerSecond * (float)(frame.deltaMs * 0.001);
+
+	if (rotationAngle != paintedRotation || (playing || isDragging) != paintedArmDown)
 		repaint();
-	}
+
+	return playing || isDragging;
 }
 
 void TurntableComponent::setExpanded(bool shouldExpand)
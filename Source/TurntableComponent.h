@@ -6,11 +6,12 @@
 #pragma once
 #include <JuceHeader.h>
 #include "AudioEngine.h"
+#include "FrameScheduler.h"
 
-class TurntableComponent : public juce::Component, public juce::Timer
+class TurntableComponent : public juce::Component, private FrameScheduler::Client
 {
 	public:
-	TurntableComponent(AudioEngine& engine);
+	TurntableComponent(AudioEngine& engine, FrameScheduler& scheduler);
 	~TurntableComponent() override;
 
 	void paint(juce::Graphics& g) override;
@@ -26,13 +27,23 @@ class TurntableComponent : public juce::Component, public juce::Timer
 	void touchMoved(const juce::TouchEvent& e) override;
 	void touchEnded(const juce::TouchEvent& e) override;
 
-	// Timer for Animation Loop (60FPS)
-	void timerCallback() override;
-
 	void setExpanded(bool shouldExpand);
 
+	// 静止レイヤーの画像キャッシュ（既定で有効）。切るとキャッシュ導入前と同じく毎フレーム全部を描く
+	// — ベンチマークで前後の描画時間を比べるため
+	void setLayerCacheEnabled(bool shouldCache);
+
 	private:
 	AudioEngine& audioEngine;
+	FrameScheduler& frameScheduler;
+
+	// Animation — 画面のリフレッシュごとに FrameScheduler から呼ばれる
+	bool advanceFrame(const FrameScheduler::Frame& frame) override;
+	static constexpr float spinRadiansPerSecond = 3.125f; // 旧 16ms タイマーの 0.05 rad / tick
+
+	// 最後に描いた状態（変わったときだけ repaint）
+	float paintedRotation = 0.0f;
+	bool paintedArmDown = false;
 
 	juce::Image recordImage;
 
@@ -66,5 +77,45 @@ class TurntableComponent : public juce::Component, public juce::Timer
 	// Helper
 	float getAngleFromPoint(juce::Point<float> p);
 
+	// ── 描画レイヤーのキャッシュ ──
+	// 静止している部分は画像に描いておき、resized（と表示倍率の変化）でだけ描き直す
+	// 毎フレームは 背景 → 回転したラベル → アーム の 3 枚を貼るだけ
+	struct DiscLayout
+	{
+		juce::Point<float> center;
+		float diameter = 0.0f;
+		float radius = 0.0f;
+		float labelDiameter = 0.0f;
+		juce::Rectangle<float> discArea;
+		juce::Rectangle<float> labelLayerArea; // ラベル層の画像が覆う範囲（回転前）
+	};
+	DiscLayout getDiscLayout() const;
+
+	// トーンアームの形（休止 / 再生中で角度だけ違う）
+	struct ArmGeometry
+	{
+		juce::Point<float> pivotCenter, armEnd;
+		float pivotRadius = 0.0f;
+		float armWidth = 0.0f;
+		float armAngle = 0.0f;
+		float cartLength = 0.0f;
+		float cartWidth = 0.0f;
+		juce::Rectangle<float> bounds; // 影・カートリッジまで含めて描く範囲（アーム層の画像はこの大きさ）
+	};
+	static ArmGeometry getArmGeometry(const DiscLayout& layout, bool armDown);
+
+	void invalidateLayers();
+	juce::Image renderLayer(juce::Rectangle<float> area, bool transparent,
+							const std::function<void(juce::Graphics&)>& paintLayer) const;
+	static void paintBase(juce::Graphics& g, const DiscLayout& layout);
+	static void paintLabel(juce::Graphics& g, const DiscLayout& layout);
+	static void paintArm(juce::Graphics& g, const DiscLayout& layout, bool armDown);
+
+	juce::Image baseLayer;    // 背景 + 盤 + 溝（同心円なので回しても同じ）
+	juce::Image labelLayer;   // ラベル + センターホール（rotationAngle で回して貼る）
+	juce::Image armLayers[2]; // トーンアーム（0: 休止, 1: 再生中・スクラッチ中）。アームを囲む範囲だけ
+	float layerScale = 0.0f;  // レイヤーを描いたときの物理ピクセル倍率
+	bool layerCacheEnabled = true;
+
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TurntableComponent)
 };
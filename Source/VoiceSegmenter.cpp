@@ -0,0 +1,379 @@
+/*
+ ==============================================================================
+ VoiceSegmenter.cpp
+ ==============================================================================
+ Onset detection strategy
+ ------------------------
+ 1. テイクをモノラルにダウンミックスし、hopSize ごとに Hann 窓 + FFT。
+    対数圧縮した振幅スペクトルの正の差分の総和 = スペクトルフラックス。
+
+ 2. フレーム範囲をチャンクに分け、各チャンクを ThreadPool のジョブとして
+    並列計算する。チャンク先頭では 1 フレーム前のスペクトルを再計算する
+    だけなので、結果はシングルスレッド版とビット単位で一致する。
+
+ 3. ピック: 局所平均 × sensitivity を超える局所最大で、かつ無音ゲート
+    (silenceThresholdDb) を超えるフレームをオンセットとする。
+
+ 4. 各セグメントの末尾は次のオンセット手前の最後の有音フレームまで詰める
+    ので、パッドに割り当てたときに無音の尻尾が残らない。
+ ==============================================================================
+ */
+#include "VoiceSegmenter.h"
+
+namespace
+{
+    // 1 ジョブあたりの最小フレーム数（これ未満なら分割しない）
+    constexpr int minFramesPerJob = 512;
+
+    void computeFluxRange (const float* mono, int numSamples, int fftOrder, int hopSize,
+                           int firstFrame, int endFrame, float* fluxOut, float* energyOut)
+    {
+        const int fftSize = 1 << fftOrder;
+        const int numBins = fftSize / 2 + 1;
+
+        juce::dsp::FFT fft (fftOrder);
+        juce::dsp::WindowingFunction<float> window ((size_t) fftSize,
+                                                    juce::dsp::WindowingFunction<float>::hann,
+                                                    false);
+
+        std::vector<float> frame ((size_t) fftSize * 2, 0.0f);
+        std::vector<float> prevMag ((size_t) numBins, 0.0f);
+
+        // チャンク先頭の差分用に 1 フレーム前から計算
+        for (int f = juce::jmax (0, firstFrame - 1); f < endFrame; ++f)
+        {
+            const int start = f * hopSize;
+            const int available = juce::jlimit (0, fftSize, numSamples - start);
+
+            std::fill (frame.begin(), frame.end(), 0.0f);
+            if (available > 0)
+                std::copy (mono + start, mono + start + available, frame.begin());
+
+            float sumSquares = 0.0f;
+            for (int i = 0; i < available; ++i)
+                sumSquares += frame[(size_t) i] * frame[(size_t) i];
+
+            window.multiplyWithWindowingTable (frame.data(), (size_t) fftSize);
+            fft.performFrequencyOnlyForwardTransform (frame.data(), true);
+
+            float flux = 0.0f;
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                // 対数圧縮で小さな子音も拾えるようにする
+                const float mag = std::log1p (100.0f * frame[(size_t) bin]);
+                flux += juce::jmax (0.0f, mag - prevMag[(size_t) bin]);
+                prevMag[(size_t) bin] = mag;
+            }
+
+            if (f >= firstFrame)
+            {
+                fluxOut[f] = flux;
+                energyOut[f] = available > 0 ? std::sqrt (sumSquares / (float) available) : 0.0f;
+            }
+        }
+    }
+}
+
+VoiceSegmenter::VoiceSegmenter()
+    : juce::Thread ("VoiceSegmenter"),
+      pool (juce::jmax (1, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+VoiceSegmenter::~VoiceSegmenter()
+{
+    stopThread (4000);
+}
+
+void VoiceSegmenter::requestAnalysis (juce::AudioBuffer<float>&& audio, int numSamples, double sampleRate,
+                                      const juce::File& sourceFile, int requestId,
+                                      const Settings& settings)
+{
+    auto request = std::make_unique<Request>();
+    request->audio = std::move (audio);
+    request->numSamples = numSamples;
+    request->sampleRate = sampleRate;
+    request->sourceFile = sourceFile;
+    request->requestId = requestId;
+    request->settings = settings;
+
+    {
+        const juce::ScopedLock sl (lock);
+        pendingRequest = std::move (request);
+    }
+
+    busy = true;
+
+    if (! isThreadRunning())
+        startThread (juce::Thread::Priority::low);
+
+    notify();
+}
+
+bool VoiceSegmenter::popResult (Result& out)
+{
+    const juce::ScopedLock sl (lock);
+
+    if (finishedResult == nullptr)
+        return false;
+
+    out = std::move (*finishedResult);
+    finishedResult.reset();
+    return true;
+}
+
+void VoiceSegmenter::run()
+{
+    while (! threadShouldExit())
+    {
+        std::unique_ptr<Request> request;
+        {
+            const juce::ScopedLock sl (lock);
+            request = std::move (pendingRequest);
+        }
+
+        if (request == nullptr)
+        {
+            busy = false;
+            wait (-1);
+            continue;
+        }
+
+        busy = true;
+
+        // 新しい要求が来たら古い解析は途中で捨てる
+        auto shouldAbort = [this]
+        {
+            const juce::ScopedLock sl (lock);
+            return threadShouldExit() || pendingRequest != nullptr;
+        };
+
+        auto segments = analyse (request->audio, request->numSamples, request->sampleRate,
+                                 request->settings, pool, shouldAbort);
+
+        if (shouldAbort())
+            continue;
+
+        auto result = std::make_unique<Result>();
+        result->requestId = request->requestId;
+        result->sourceFile = request->sourceFile;
+        result->sampleRate = request->sampleRate;
+        result->numSamples = request->numSamples;
+        result->segments = std::move (segments);
+
+        {
+            const juce::ScopedLock sl (lock);
+            finishedResult = std::move (result);
+        }
+
+        sendChangeMessage();
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+std::vector<VoiceSegmenter::Segment> VoiceSegmenter::analyse (const juce::AudioBuffer<float>& audio,
+                                                              int numSamples, double sampleRate,
+                                                              const Settings& settings,
+                                                              juce::ThreadPool& pool,
+                                                              const std::function<bool()>& shouldAbort)
+{
+    std::vector<Segment> segments;
+
+    const int fftSize = 1 << settings.fftOrder;
+    const int hopSize = juce::jmax (1, settings.hopSize);
+    numSamples = juce::jmin (numSamples, audio.getNumSamples());
+
+    if (numSamples < fftSize || audio.getNumChannels() == 0 || sampleRate <= 0.0)
+        return segments;
+
+    // ── モノラルにダウンミックス ──────────────────────────────────────────
+    std::vector<float> mono ((size_t) numSamples, 0.0f);
+    const float channelGain = 1.0f / (float) audio.getNumChannels();
+
+    for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+        juce::FloatVectorOperations::addWithMultiply (mono.data(), audio.getReadPointer (ch),
+                                                      channelGain, numSamples);
+
+    // ── スペクトルフラックスを並列計算 ────────────────────────────────────
+    const int numFrames = 1 + (numSamples - fftSize) / hopSize;
+    std::vector<float> flux ((size_t) numFrames, 0.0f);
+    std::vector<float> energy ((size_t) numFrames, 0.0f);
+
+    const int maxJobs = juce::jmax (1, pool.getNumThreads());
+    const int numJobs = juce::jlimit (1, maxJobs, numFrames / minFramesPerJob);
+    const int framesPerJob = (numFrames + numJobs - 1) / numJobs;
+
+    std::atomic<int> jobsRemaining { numJobs };
+    juce::WaitableEvent allDone;
+
+    for (int job = 0; job < numJobs; ++job)
+    {
+        const int first = job * framesPerJob;
+        const int end = juce::jmin (numFrames, first + framesPerJob);
+
+        pool.addJob ([&, first, end]
+        {
+            if (! (shouldAbort && shouldAbort()))
+                computeFluxRange (mono.data(), numSamples, settings.fftOrder, hopSize,
+                                  first, end, flux.data(), energy.data());
+
+            if (--jobsRemaining == 0)
+                allDone.signal();
+        });
+    }
+
+    // ローカル変数を参照しているので、中断時も全ジョブの終了を待つ
+    allDone.wait (-1);
+
+    if (shouldAbort && shouldAbort())
+        return segments;
+
+    // ── ピークピッキング ──────────────────────────────────────────────────
+    const float silenceGain = juce::Decibels::decibelsToGain (settings.silenceThresholdDb);
+    const int averageRadius = juce::jmax (2, (int) (0.05 * sampleRate / hopSize)); // ±50ms
+    const int minGapFrames = juce::jmax (1, (int) (settings.minSegmentSeconds * sampleRate / hopSize));
+
+    // 局所平均はプレフィックス和で O(numFrames)
+    std::vector<double> prefix ((size_t) numFrames + 1, 0.0);
+    for (int f = 0; f < numFrames; ++f)
+        prefix[(size_t) f + 1] = prefix[(size_t) f] + flux[(size_t) f];
+
+    std::vector<int> onsetFrames;
+    int lastOnset = -minGapFrames;
+
+    for (int f = 1; f < numFrames - 1; ++f)
+    {
+        const int lo = juce::jmax (0, f - averageRadius);
+        const int hi = juce::jmin (numFrames, f + averageRadius + 1);
+        const float localMean = (float) ((prefix[(size_t) hi] - prefix[(size_t) lo]) / (hi - lo));
+        const float value = flux[(size_t) f];
+
+        const bool isPeak = value > flux[(size_t) f - 1] && value >= flux[(size_t) f + 1];
+        const bool aboveThreshold = value > localMean * settings.sensitivity;
+        const bool voiced = energy[(size_t) juce::jmin (numFrames - 1, f + 1)] > silenceGain;
+
+        if (isPeak && aboveThreshold && voiced && f - lastOnset >= minGapFrames)
+        {
+            onsetFrames.push_back (f);
+            lastOnset = f;
+        }
+    }
+
+    if (onsetFrames.empty())
+        return segments;
+
+    // フレーム → サンプル位置（子音の頭を切らないようフレーム中心より 1 hop 手前）
+    auto frameToSample = [&] (int f)
+    {
+        return (juce::int64) juce::jlimit (0, numSamples, f * hopSize + fftSize / 2 - hopSize);
+    };
+
+    for (size_t i = 0; i < onsetFrames.size(); ++i)
+    {
+        const int startFrame = onsetFrames[i];
+        const int nextFrame = (i + 1 < onsetFrames.size()) ? onsetFrames[i + 1] : numFrames;
+
+        // 次のオンセットまでの最後の有音フレームで終端
+        int lastVoiced = startFrame;
+        for (int f = startFrame; f < nextFrame; ++f)
+            if (energy[(size_t) f] > silenceGain)
+                lastVoiced = f;
+
+        Segment segment;
+        segment.start = frameToSample (startFrame);
+        segment.end = (i + 1 < onsetFrames.size() && lastVoiced + 1 >= nextFrame)
+                        ? frameToSample (nextFrame)
+                        : juce::jmin ((juce::int64) numSamples,
+                                      (juce::int64) lastVoiced * hopSize + fftSize);
+
+        if (segment.end > segment.start)
+            segments.push_back (segment);
+    }
+
+    // ── フレーズモード: 短い無音を挟むセグメントを結合 ──────────────────────
+    if (settings.granularity == Granularity::Phrase && ! segments.empty())
+    {
+        const auto maxGap = (juce::int64) (settings.phraseGapSeconds * sampleRate);
+        std::vector<Segment> phrases { segments.front() };
+
+        for (size_t i = 1; i < segments.size(); ++i)
+        {
+            if (segments[i].start - phrases.back().end < maxGap)
+                phrases.back().end = segments[i].end;
+            else
+                phrases.push_back (segments[i]);
+        }
+
+        segments = std::move (phrases);
+    }
+
+    return segments;
+}
+
+// ─── Cue cache ──────────────────────────────────────────────────────────────
+
+juce::File VoiceSegmenter::getCueFileFor (const juce::File& audioFile)
+{
+    return audioFile.getSiblingFile (audioFile.getFileName() + ".cues");
+}
+
+bool VoiceSegmenter::saveCues (const juce::File& audioFile, const std::vector<Segment>& segments,
+                               double sampleRate, juce::int64 numSamples)
+{
+    if (! audioFile.existsAsFile())
+        return false;
+
+    juce::XmlElement root ("CUES");
+    root.setAttribute ("version", 1);
+    root.setAttribute ("sampleRate", sampleRate);
+    root.setAttribute ("numSamples", (double) numSamples);
+    // 元ファイルが変わったらキャッシュを無効化するためのスタンプ
+    root.setAttribute ("fileSize", (double) audioFile.getSize());
+    root.setAttribute ("modTime", (double) audioFile.getLastModificationTime().toMilliseconds());
+
+    for (const auto& segment : segments)
+    {
+        auto* child = root.createNewChildElement ("SEGMENT");
+        child->setAttribute ("start", (double) segment.start);
+        child->setAttribute ("end", (double) segment.end);
+    }
+
+    return root.writeTo (getCueFileFor (audioFile), {});
+}
+
+bool VoiceSegmenter::loadCues (const juce::File& audioFile, std::vector<Segment>& segments,
+                               double targetSampleRate)
+{
+    auto cueFile = getCueFileFor (audioFile);
+    if (! cueFile.existsAsFile())
+        return false;
+
+    auto xml = juce::XmlDocument::parse (cueFile);
+    if (xml == nullptr || ! xml->hasTagName ("CUES"))
+        return false;
+
+    const auto fileSize = (juce::int64) xml->getDoubleAttribute ("fileSize", -1.0);
+    const auto modTime = (juce::int64) xml->getDoubleAttribute ("modTime", -1.0);
+
+    if (fileSize != audioFile.getSize()
+        || modTime != audioFile.getLastModificationTime().toMilliseconds())
+        return false;
+
+    // 解析したときのデッキのレート（デバイスが変わっていれば換算）
+    const double savedSampleRate = xml->getDoubleAttribute ("sampleRate", 0.0);
+    const double scale = (targetSampleRate > 0.0 && savedSampleRate > 0.0) ? targetSampleRate / savedSampleRate : 1.0;
+
+    segments.clear();
+
+    for (auto* child : xml->getChildWithTagNameIterator ("SEGMENT"))
+    {
+        Segment segment;
+        segment.start = (juce::int64) std::llround (child->getDoubleAttribute ("start") * scale);
+        segment.end = (juce::int64) std::llround (child->getDoubleAttribute ("end") * scale);
+
+        if (segment.end > segment.start)
+            segments.push_back (segment);
+    }
+
+    return true;
+}
@@ -0,0 +1,100 @@
+/*
+ ==============================================================================
+ VoiceSegmenter.h
+ ==============================================================================
+ 声のテイクを音節／フレーズ単位に分割するオンセット検出。
+
+ • スペクトルフラックス (juce::dsp::FFT) でオンセット候補を検出
+ • 長いテイクはフレーム範囲ごとに ThreadPool へ分散して並列計算
+ • 結果はキューマーカーとしてファイル横のサイドカー (.cues) にキャッシュ
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+class VoiceSegmenter : public juce::ChangeBroadcaster,
+                       private juce::Thread
+{
+public:
+    struct Segment
+    {
+        juce::int64 start = 0; // サンプル位置（含む）
+        juce::int64 end = 0;   // サンプル位置（含まない）
+    };
+
+    enum class Granularity
+    {
+        Syllable, // オンセットごとに分割
+        Phrase    // 短い無音を挟むセグメントを結合
+    };
+
+    struct Settings
+    {
+        int fftOrder = 10;               // 1024 ポイント
+        int hopSize = 256;
+        float sensitivity = 1.5f;        // 局所平均に対するしきい値倍率
+        float silenceThresholdDb = -45.0f;
+        double minSegmentSeconds = 0.08;
+        double phraseGapSeconds = 0.25;
+        Granularity granularity = Granularity::Syllable;
+    };
+
+    struct Result
+    {
+        int requestId = 0;
+        juce::File sourceFile;
+        double sampleRate = 44100.0;
+        juce::int64 numSamples = 0;
+        std::vector<Segment> segments;
+    };
+
+    VoiceSegmenter();
+    ~VoiceSegmenter() override;
+
+    // 解析をキューに積む（メッセージスレッドから）。実行中の古い要求は破棄される。
+    // 完了すると sendChangeMessage() で通知。
+    void requestAnalysis (juce::AudioBuffer<float>&& audio, int numSamples, double sampleRate,
+                          const juce::File& sourceFile, int requestId,
+                          const Settings& settings = {});
+
+    // 完了した結果を取り出す（無ければ false）
+    bool popResult (Result& out);
+
+    bool isBusy() const { return busy.load(); }
+
+    // ── 同期解析（ワーカースレッドから呼ばれる） ─────────────────────────
+    static std::vector<Segment> analyse (const juce::AudioBuffer<float>& audio, int numSamples,
+                                         double sampleRate, const Settings& settings,
+                                         juce::ThreadPool& pool,
+                                         const std::function<bool()>& shouldAbort = {});
+
+    // ── キューマーカーのキャッシュ（ファイルと一緒に保存） ─────────────────
+    static juce::File getCueFileFor (const juce::File& audioFile);
+    static bool saveCues (const juce::File& audioFile, const std::vector<Segment>& segments,
+                          double sampleRate, juce::int64 numSamples);
+    // targetSampleRate を指定すると、保存時のレートと違えば位置を換算する
+    static bool loadCues (const juce::File& audioFile, std::vector<Segment>& segments,
+                          double targetSampleRate = 0.0);
+
+private:
+    void run() override;
+
+    struct Request
+    {
+        juce::AudioBuffer<float> audio;
+        int numSamples = 0;
+        double sampleRate = 44100.0;
+        juce::File sourceFile;
+        int requestId = 0;
+        Settings settings;
+    };
+
+    juce::ThreadPool pool;
+
+    juce::CriticalSection lock;
+    std::unique_ptr<Request> pendingRequest;
+    std::unique_ptr<Result> finishedResult;
+    std::atomic<bool> busy { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VoiceSegmenter)
+};
@@ -7,40 +7,64 @@
 
  Performance strategy
  --------------------
- 1. juce::AudioThumbnail (inside AudioEngine) computes min/max peaks
-    asynchronously in its own thread.  We NEVER touch the raw AudioBuffer
-    from the UI thread — only call thumbnail.getMinAndMaxChannel(), which
-    is O(1) per call (pre-computed peaks).
-
- 2. A juce::Path is cached and only rebuilt when the component's width or
-    the underlying audio content actually changes (detected via thumbnail
-    sample count).  Repaint only blits the cached path — O(width).
-
- 3. During recording the thumbnail grows in a background thread; each
-    timer tick checks if more samples are available and only then rebuilds
-    the path — still O(width), never O(numSamples).
-
- 4. The path rebuild is decoupled from paint() — it happens in the timer
-    callback, so paint() only ever calls strokePath() on a ready-made path.
+ 1. WaveformPeaks (inside AudioEngine) keeps a min/max pyramid that is
+    filled as audio arrives.  Each pixel column reads one bin from the level
+    matching the zoom, so tile rendering is O(visible pixels) at any zoom.
+    Only when zoomed in past the finest level (64 samples) do we read raw
+    samples — at most one tile's worth — and at the deepest zoom the
+    individual samples are drawn as a line.
+
+ 2. Low / mid / high band energies are computed by WaveformPeaks' own
+    background thread (FFT every 256 samples) and stored next to the peaks.
+    Tiles colour each column from them; paint() does no analysis.
+
+ 3. The waveform is cached as fixed-width image tiles anchored to sample
+    positions (WaveformTileCache).  Zoom and scroll only move and scale the
+    tiles; new tiles are rendered only when the zoom crosses a power of two.
+
+ 4. During recording only the newest (partially filled) tile is re-rendered
+    as the peaks grow — older tiles never change.
+
+ 5. paint() blits the handful of tiles covering the visible range, so its
+    cost is independent of take length and zoom level.
+
+ 6. There is no timer.  The shared FrameScheduler ticks advanceFrame once per
+    display refresh, and it only repaints when the playhead, the recorded
+    length or the flick scroll actually moved.
+
+ 7. During playback only the playhead moves, so only the strips under the
+    old and new playhead are invalidated.  paint() limits the tile blit to
+    the clip, so a playback frame fills a few hundred pixels rather than
+    the whole component.
+
+ 8. Every channel is drawn from its own true min/max (no mirroring of the
+    loudest side), either as stacked lanes or overlaid in one lane.  A tile
+    fetches its columns with one batched query per channel.
  ==============================================================================
  */
 #include "WaveformComponent.h"
 
-WaveformComponent::WaveformComponent (AudioEngine& engine)
-    : audioEngine (engine)
+WaveformComponent::WaveformComponent (AudioEngine& engine, FrameScheduler& scheduler)
+    : audioEngine (engine),
+      frameScheduler (scheduler),
+      waveformTiles (engine.getWaveformPeaks(),
+                     [&engine] (int channel, juce::int64 start, int num, float* dest) { return engine.readDeckSamples (channel, start, num, dest); },
+                     juce::Colour::fromString ("FF22C55E")) // 緑
 {
     // Enable multi-touch for pinch-zoom gestures
     setInterceptsMouseClicks (true, true);
 
     // AudioEngineの変更を監視
     audioEngine.addChangeListener (this);
-    startTimer (40); // 25fps
+    audioEngine.getWaveformPeaks().addChangeListener (this); // 帯域の解析の進み
+    frameScheduler.addClient (this);
 }
 
 WaveformComponent::~WaveformComponent()
 {
     audioEngine.removeChangeListener (this);
-    stopTimer();
+    audioEngine.getWaveformPeaks().removeChangeListener (this);
+    frameScheduler.removeClient (this);
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -48,6 +72,12 @@ void WaveformComponent::paint (juce::Graphics& g)
 {
     auto bounds = getLocalBounds().toFloat();
 
+    // 再生位置は advanceFrame が帯を無効化した値をそのまま描く（読み直すとオーディオスレッドが
+    // 進めた分だけ線が帯の外へずれて切れる）。読み直すのは全体を描き直すときだけ
+    paintedSampleCount = audioEngine.getRecordedSamplesCount();
+    paintedPlaybackPosition = hasPlayheadToPaint ? playheadToPaint : audioEngine.getPlaybackPosition();
+    hasPlayheadToPaint = false;
+
     // 背景
     g.setColour (juce::Colour::fromString ("FF1E293B")); // Slate 800
     g.fillRoundedRectangle (bounds, 5.0f);
@@ -60,28 +90,72 @@ void WaveformComponent::paint (juce::Graphics& g)
         return;
     }
 
-    // ── Zoom & scroll clip region (Issue #15) ──────────────────────────
-    float visibleFraction = 1.0f / juce::jmax (zoomLevel, 1.0f);
+    // ── Visible sample range (Issue #15) ───────────────────────────────
+    // scrollOffset = 表示の左端（全体に対する割合）、1 / zoomLevel = 表示幅の割合
+    const auto totalSamples = (double) audioEngine.getRecordedSamplesCount();
+    if (totalSamples <= 0.0)
+        return;
+
+    const double visibleStart = scrollOffset * totalSamples;
+    const double samplesPerPixel = totalSamples / juce::jmax (zoomLevel, 1.0) / juce::jmax (1.0, (double) bounds.getWidth());
+
+    auto sampleToX = [&] (double sample)
+    {
+        return bounds.getX() + (float) ((sample - visibleStart) / samplesPerPixel);
+    };
 
-    // Apply clip for scrolled view
     g.saveState();
     g.reduceClipRegion (bounds.toNearestInt());
 
-    // Scale waveform path for zoom
-    juce::AffineTransform zoomTransform;
-    float scaledWidth = bounds.getWidth() * zoomLevel;
-    float xOffset = -scrollOffset * (scaledWidth - bounds.getWidth());
-    zoomTransform = juce::AffineTransform::scale (zoomLevel).translated (xOffset, 0.0f);
+    // 波形の描画 — 見えている範囲のタイルを貼るだけ（長さ・ズームに依らない）
+    if (audioEngine.getThumbnailGeneration() != cachedThumbnailGeneration)
+    {
+        waveformTiles.clear();
+        cachedThumbnailGeneration = audioEngine.getThumbnailGeneration();
+    }
+
+    // 再生位置だけ動いたフレームは前後の細い帯しか無効化されないので、貼るのもその幅だけ
+    // （高さはタイルの高さなので変えない）
+    const auto waveArea = bounds.reduced (2.0f);
+    const auto clip = g.getClipBounds().toFloat();
+    const auto drawArea = waveArea.withLeft (juce::jmax (waveArea.getX(), clip.getX()))
+                                  .withRight (juce::jmin (waveArea.getRight(), clip.getRight()));
 
-    // 波形の描画 — cached pathをblitするだけ (O(width))
-    g.setColour (juce::Colour::fromString ("FF22C55E")); // 緑
-    g.strokePath (waveformPath, juce::PathStrokeType (1.5f), zoomTransform);
+    if (drawArea.getWidth() > 0.0f)
+        waveformTiles.draw (g, drawArea, visibleStart + (drawArea.getX() - bounds.getX()) * samplesPerPixel,
+                            visibleStart + (drawArea.getRight() - bounds.getX()) * samplesPerPixel);
+
+    // 縦に並べたレーンの境目
+    const int numChannels = audioEngine.getWaveformPeaks().getNumChannels();
+    if (numChannels > 1 && waveformTiles.getChannelLayout() == WaveformTileCache::ChannelLayout::stacked)
+    {
+        g.setColour (juce::Colours::white.withAlpha (0.12f));
+        const float laneHeight = waveArea.getHeight() / (float) numChannels;
+
+        for (int ch = 1; ch < numChannels; ++ch)
+            g.fillRect (waveArea.getX(), waveArea.getY() + laneHeight * (float) ch, waveArea.getWidth(), 1.0f);
+    }
+
+    // キューマーカー（音節/フレーズ境界）
+    const auto& cues = audioEngine.getCueMarkers();
+
+    if (! cues.empty() && totalSamples > 0.0)
+    {
+        g.setColour (juce::Colour::fromString ("FFFACC15").withAlpha (0.8f)); // Amber
+
+        for (const auto& cue : cues)
+        {
+            float cx = sampleToX ((double) cue.start);
+            if (cx >= bounds.getX() && cx <= bounds.getRight())
+                g.fillRect (cx, bounds.getY(), 1.0f, bounds.getHeight());
+        }
+    }
 
     // 再生位置インジケーター
     if (audioEngine.hasRecordedAudio())
     {
-        double pos = audioEngine.getPlaybackPosition();
-        float x = bounds.getX() + static_cast<float> (pos) * bounds.getWidth() * zoomLevel + xOffset;
+        double pos = paintedPlaybackPosition;
+        float x = sampleToX (pos * totalSamples);
 
         // Only draw if visible
         if (x >= bounds.getX() && x <= bounds.getRight())
@@ -94,11 +168,11 @@ void WaveformComponent::paint (juce::Graphics& g)
     g.restoreState();
 
     // ── Zoom level indicator ────────────────────────────────────────────
-    if (zoomLevel > 1.05f)
+    if (zoomLevel > 1.05)
     {
         g.setColour (juce::Colours::white.withAlpha (0.7f));
         g.setFont (11.0f);
-        g.drawText (juce::String::formatted ("%.1fx", (double) zoomLevel),
+        g.drawText (juce::String::formatted ("%.1fx", zoomLevel),
                     bounds.removeFromBottom (16.0f), juce::Justification::centredRight, false);
     }
 }
@@ -106,35 +180,24 @@ void WaveformComponent::paint (juce::Graphics& g)
 // ─────────────────────────────────────────────────────────────────────────────
 void WaveformComponent::resized()
 {
-    // Width changed → force path rebuild on next timer tick
-    cachedPathWidth = 0;
+    // タイルは高さが変わったときだけ描き直される（WaveformTileCache::draw）
+    repaint();
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-void WaveformComponent::timerCallback()
+bool WaveformComponent::advanceFrame (const FrameScheduler::Frame& frame)
 {
-    // 録音中または再生中は再描画
-    if (audioEngine.isRecording() || audioEngine.isPlaying())
-    {
-        rebuildWaveformPath();
-        repaint();
-        return;
-    }
-
     // ── Flick momentum animation (Issue #15) ────────────────────────────
-    if (std::abs (flickVelocity) > 5.0f)
+    const bool flicking = std::abs (flickVelocity) > minFlickVelocity && ! isPinching && primaryTouchIndex < 0;
+
+    if (flicking)
     {
-        double now = juce::Time::getMillisecondCounterHiRes();
-        double dt = (now - lastFlickTime) * 0.001;
-        lastFlickTime = now;
+        const double dt = frame.deltaMs * 0.001;
 
         if (dt > 0.0 && dt < 0.2)
         {
-            float visibleFraction = 1.0f / juce::jmax (zoomLevel, 1.0f);
-            float maxScroll = 1.0f - visibleFraction;
-
-            scrollOffset += flickVelocity * dt * 0.001f;
-            scrollOffset = juce::jlimit (0.0f, juce::jmax (maxScroll, 0.0f), scrollOffset);
+            scrollOffset += flickVelocity * dt * 0.001;
+            clampScroll();
 
             // Apply friction
             flickVelocity *= 0.92f;
@@ -142,21 +205,55 @@ void WaveformComponent::timerCallback()
             repaint();
         }
     }
-    else if (std::abs (flickVelocity) > 0.0f)
+    else if (primaryTouchIndex < 0)
     {
         flickVelocity = 0.0f;
     }
+
+    // 録音中はタイルが伸び（長さが変わると全体の縮尺も変わる）→ 全体を描き直す
+    // 再生中は再生位置の線が動くだけ → 前の線と今の線の帯だけ無効化する
+    const auto sampleCount = audioEngine.getRecordedSamplesCount();
+    const auto playbackPosition = audioEngine.getPlaybackPosition();
+
+    if (sampleCount != paintedSampleCount)
+    {
+        hasPlayheadToPaint = false;
+        repaint();
+    }
+    else if (playbackPosition != paintedPlaybackPosition)
+    {
+        repaint (getPlayheadStrip (paintedPlaybackPosition));
+        repaint (getPlayheadStrip (playbackPosition));
+        playheadToPaint = playbackPosition; // paint はこの位置に描く（帯の中に収まる）
+        hasPlayheadToPaint = true;
+    }
+
+    return flicking || audioEngine.isRecording() || audioEngine.isPlaying();
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-void WaveformComponent::changeListenerCallback (juce::ChangeBroadcaster* /*source*/)
+void WaveformComponent::changeListenerCallback (juce::ChangeBroadcaster* source)
 {
-    // Recording started/stopped or file loaded → full rebuild needed
-    cachedPathWidth = 0;
-    cachedThumbHash = 0;
-    zoomLevel = 1.0f;
-    scrollOffset = 0.0f;
-    rebuildWaveformPath();
+    // 帯域の解析が進んだ: 該当するタイルは draw が描き直す
+    if (source == &audioEngine.getWaveformPeaks())
+    {
+        repaint();
+        return;
+    }
+
+    // キューマーカー更新などデッキの中身が同じなら、ズームを保ったまま再描画
+    // （サムネイルの作り直しは paint がタイルを捨てて拾う）
+    if (audioEngine.getDeckGeneration() == cachedDeckGeneration)
+    {
+        repaint();
+        return;
+    }
+
+    cachedDeckGeneration = audioEngine.getDeckGeneration();
+
+    // Recording started or file loaded → back to fit-to-width
+    zoomLevel = 1.0;
+    scrollOffset = 0.0;
     repaint();
 }
 
@@ -166,25 +263,52 @@ void WaveformComponent::setExpanded (bool shouldExpand)
     if (isExpanded != shouldExpand)
     {
         isExpanded = shouldExpand;
-        cachedPathWidth = 0;
         resized();
     }
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+void WaveformComponent::setChannelLayout (WaveformTileCache::ChannelLayout newLayout)
+{
+    if (newLayout == waveformTiles.getChannelLayout())
+        return;
+
+    waveformTiles.setChannelLayout (newLayout); // タイルは次の paint で描き直す
+    repaint();
+}
+
 // ─── Mouse interaction (desktop) ─────────────────────────────────────────────
 
+void WaveformComponent::mouseDown (const juce::MouseEvent& e)
+{
+    // 右クリック: チャンネルの並べ方（モノラルでは意味が無いので出さない）
+    if (! e.mods.isPopupMenu() || audioEngine.getWaveformPeaks().getNumChannels() < 2)
+        return;
+
+    using Layout = WaveformTileCache::ChannelLayout;
+    const auto current = waveformTiles.getChannelLayout();
+    juce::Component::SafePointer<WaveformComponent> safeThis (this);
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader ("Channels");
+    menu.addItem ("Stacked lanes", true, current == Layout::stacked,
+                  [safeThis] { if (safeThis != nullptr) safeThis->setChannelLayout (Layout::stacked); });
+    menu.addItem ("Overlaid", true, current == Layout::overlaid,
+                  [safeThis] { if (safeThis != nullptr) safeThis->setChannelLayout (Layout::overlaid); });
+    menu.showMenuAsync (juce::PopupMenu::Options().withTargetComponent (this).withMousePosition());
+}
+
 void WaveformComponent::mouseDrag (const juce::MouseEvent& e)
 {
-    float visibleFraction = 1.0f / juce::jmax (zoomLevel, 1.0f);
-    float maxScroll = 1.0f - visibleFraction;
-    if (maxScroll <= 0.0f) return;
+    const double visibleFraction = 1.0 / juce::jmax (zoomLevel, 1.0);
+    if (visibleFraction >= 1.0) return;
 
-    float dx = e.getDistanceFromDragStartX() - e.mouseDownPosition.getX();
-    float width = (float) getWidth();
-    if (width <= 0.0f) return;
+    const double dx = e.getDistanceFromDragStartX() - e.mouseDownPosition.getX();
+    const double width = getWidth();
+    if (width <= 0.0) return;
 
     scrollOffset -= dx / (width * visibleFraction);
-    scrollOffset = juce::jlimit (0.0f, maxScroll, scrollOffset);
+    clampScroll();
     repaint();
 }
 
@@ -198,30 +322,26 @@ void WaveformComponent::mouseWheelMove (const juce::MouseEvent& e,
         // Ctrl+scroll or Shift+scroll → zoom
         if (e.mods.isCtrlDown() || e.mods.isShiftDown())
         {
-            float oldZoom = zoomLevel;
-            zoomLevel *= (wheel.deltaY > 0.0f) ? 1.15f : (1.0f / 1.15f);
-            zoomLevel = juce::jlimit (1.0f, 20.0f, zoomLevel);
+            const double oldZoom = zoomLevel;
+            zoomLevel *= (wheel.deltaY > 0.0f) ? 1.15 : (1.0 / 1.15);
+            zoomLevel = juce::jlimit (1.0, getMaxZoom(), zoomLevel);
 
             // Zoom towards mouse position
-            if (oldZoom > 0.0f && getWidth() > 0)
+            if (oldZoom > 0.0 && getWidth() > 0)
             {
-                float mouseX = (float) e.position.x / (float) getWidth();
-                float oldScrollCenter = scrollOffset + mouseX / oldZoom;
-                float newScrollCenter = scrollOffset + mouseX / zoomLevel;
-                scrollOffset += (oldScrollCenter - newScrollCenter) * 0.5f;
+                const double mouseX = (double) e.position.x / (double) getWidth();
+                const double oldScrollCenter = scrollOffset + mouseX / oldZoom;
+                const double newScrollCenter = scrollOffset + mouseX / zoomLevel;
+                scrollOffset += (oldScrollCenter - newScrollCenter) * 0.5;
             }
 
-            clampScroll();
-            cachedPathWidth = 0; // rebuild for new zoom
-            rebuildWaveformPath();
+            clampScroll(); // タイルは貼る倍率が変わるだけ
         }
         else
         {
             // Normal scroll
-            float visibleFraction = 1.0f / juce::jmax (zoomLevel, 1.0f);
-            float maxScroll = 1.0f - visibleFraction;
-            scrollOffset += wheel.deltaY * 0.1f;
-            scrollOffset = juce::jlimit (0.0f, juce::jmax (maxScroll, 0.0f), scrollOffset);
+            scrollOffset += wheel.deltaY * 0.1;
+            clampScroll();
         }
         repaint();
     }
@@ -247,10 +367,8 @@ void WaveformComponent::touchStarted (const juce::TouchEvent& e)
         if (dist < 30.0f && (now - lastTapTime) < doubleTapThreshold)
         {
             // Double-tap → reset zoom to fit
-            zoomLevel = 1.0f;
-            scrollOffset = 0.0f;
-            cachedPathWidth = 0;
-            rebuildWaveformPath();
+            zoomLevel = 1.0;
+            scrollOffset = 0.0;
             repaint();
             lastTapTime = 0.0; // prevent triple-tap
             return;
@@ -305,23 +423,18 @@ void WaveformComponent::touchMoved (const juce::TouchEvent& e)
             float scale = currentDistance / pinchStartDistance;
 
             zoomLevel = pinchStartZoom * scale;
-            zoomLevel = juce::jlimit (1.0f, 20.0f, zoomLevel);
+            zoomLevel = juce::jlimit (1.0, getMaxZoom(), zoomLevel);
 
             // Pinch center → adjust scroll to zoom toward center
             juce::Point<float> pinchCenter = (p1 + p2) * 0.5f;
-            float centerNorm = pinchCenter.x / (float) getWidth();
+            const double centerNorm = pinchCenter.x / (double) getWidth();
 
-            float oldZoom = pinchStartZoom;
-            if (oldZoom > 0.0f)
+            if (pinchStartZoom > 0.0)
             {
-                float visibleFraction = 1.0f / zoomLevel;
-                float maxScroll = 1.0f - visibleFraction;
                 scrollOffset = centerNorm - centerNorm / zoomLevel;
-                scrollOffset = juce::jlimit (0.0f, juce::jmax (maxScroll, 0.0f), scrollOffset);
+                clampScroll();
             }
 
-            cachedPathWidth = 0;
-            rebuildWaveformPath();
             repaint();
         }
     }
@@ -331,8 +444,8 @@ void WaveformComponent::touchMoved (const juce::TouchEvent& e)
         const auto& touch = e.getTouch (primaryTouchIndex);
         if (!touch.isValid()) return;
 
-        float visibleFraction = 1.0f / juce::jmax (zoomLevel, 1.0f);
-        if (visibleFraction >= 1.0f) return;
+        const double visibleFraction = 1.0 / juce::jmax (zoomLevel, 1.0);
+        if (visibleFraction >= 1.0) return;
 
         double now = juce::Time::getMillisecondCounterHiRes();
         double dt = now - lastFlickTime;
@@ -346,12 +459,11 @@ void WaveformComponent::touchMoved (const juce::TouchEvent& e)
         lastFlickTime = now;
         lastFlickX = touch.position.x;
 
-        float maxScroll = 1.0f - visibleFraction;
-        float width = (float) getWidth();
-        if (width > 0.0f)
+        const double width = getWidth();
+        if (width > 0.0)
         {
             scrollOffset -= dx / (width * visibleFraction);
-            scrollOffset = juce::jlimit (0.0f, juce::jmax (maxScroll, 0.0f), scrollOffset);
+            clampScroll();
             repaint();
         }
     }
@@ -371,105 +483,46 @@ void WaveformComponent::touchEnded (const juce::TouchEvent& e)
         primaryTouchIndex = -1;
         isPinching = false;
         secondaryTouchIndex = -1;
-        // Flick momentum continues via timerCallback
+        // Flick momentum continues via advanceFrame
+        frameScheduler.requestFrames();
     }
 }
 
-// ─────────────────────────────────────────────────────────────────────────────
-// rebuildWaveformPath()
-//
-// Uses juce::AudioThumbnail::getMinAndMaxChannel() which returns pre-computed
-// peak data — each call is O(1), so the whole loop is O(width) regardless of
-// how many samples are in the buffer (e.g. 1.3M samples @ 44.1kHz = 30s).
-// ─────────────────────────────────────────────────────────────────────────────
-void WaveformComponent::rebuildWaveformPath()
+void WaveformComponent::setView (double newZoomLevel, double newScrollOffset)
 {
-    auto& thumb = audioEngine.getRecordedThumbnail();
-    int64 totalFinished = thumb.getNumSamplesFinished();
-
-    // Skip if nothing to draw
-    if (totalFinished <= 0)
-    {
-        waveformPath.clear();
-        return;
-    }
-
-    int currentWidth = getWidth();
-
-    // ── Cache check: skip rebuild if nothing changed ───────────────────
-    if (currentWidth == cachedPathWidth && totalFinished == cachedThumbHash)
-        return;
-
-    auto bounds = getLocalBounds().toFloat().reduced (2);
-    float width  = bounds.getWidth();
-    float height = bounds.getHeight();
-    float centerY = bounds.getCentreY();
-
-    if (width <= 0.0f || height <= 0.0f)
-        return;
-
-    waveformPath.clear();
-
-    // Build waveform using thumbnail peaks — O(width) loop
-    waveformPath.startNewSubPath (bounds.getX(), centerY);
-
-    for (int x = 0; x < static_cast<int> (width); ++x)
-    {
-        // Map pixel x to sample range
-        double startSample = (static_cast<double> (x) / width) * static_cast<double> (totalFinished);
-        double endSample   = (static_cast<double> (x + 1) / width) * static_cast<double> (totalFinished);
-
-        float minValue = 0.0f, maxValue = 0.0f;
-
-        if (thumb.getMinAndMaxChannel (0,
-                                       static_cast<int64> (startSample),
-                                       static_cast<int64> (endSample),
-                                       minValue, maxValue))
-        {
-            float absMax = juce::jmax (std::abs (minValue), std::abs (maxValue));
-            float y = centerY - absMax * (height * 0.45f);
-            waveformPath.lineTo (bounds.getX() + static_cast<float> (x), y);
-        }
-        else
-        {
-            waveformPath.lineTo (bounds.getX() + static_cast<float> (x), centerY);
-        }
-    }
-
-    // Mirror (bottom half)
-    for (int x = static_cast<int> (width) - 1; x >= 0; --x)
-    {
-        double startSample = (static_cast<double> (x) / width) * static_cast<double> (totalFinished);
-        double endSample   = (static_cast<double> (x + 1) / width) * static_cast<double> (totalFinished);
+    zoomLevel = juce::jlimit (1.0, getMaxZoom(), newZoomLevel);
+    scrollOffset = newScrollOffset;
+    flickVelocity = 0.0f;
+    clampScroll();
+    repaint();
+}
 
-        float minValue = 0.0f, maxValue = 0.0f;
+// ── Helper ──────────────────────────────────────────────────────────────────
+double WaveformComponent::getMaxZoom() const
+{
+    // 1 サンプルが maxPixelsPerSample ピクセルになるまで（短いテイクでも従来の 20 倍までは）
+    const auto totalSamples = (double) audioEngine.getRecordedSamplesCount();
+    const double fullZoom = totalSamples * maxPixelsPerSample / juce::jmax (1, getWidth());
+    return juce::jmax (20.0, fullZoom);
+}
 
-        if (thumb.getMinAndMaxChannel (0,
-                                       static_cast<int64> (startSample),
-                                       static_cast<int64> (endSample),
-                                       minValue, maxValue))
-        {
-            float absMax = juce::jmax (std::abs (minValue), std::abs (maxValue));
-            float y = centerY + absMax * (height * 0.45f);
-            waveformPath.lineTo (bounds.getX() + static_cast<float> (x), y);
-        }
-        else
-        {
-            waveformPath.lineTo (bounds.getX() + static_cast<float> (x), centerY);
-        }
-    }
+juce::Rectangle<int> WaveformComponent::getPlayheadStrip (double playbackPosition) const
+{
+    // paint() と同じ縮尺で再生位置の x を出す
+    const auto totalSamples = (double) audioEngine.getRecordedSamplesCount();
+    if (totalSamples <= 0.0 || playbackPosition < 0.0)
+        return {};
 
-    waveformPath.closeSubPath();
+    const double samplesPerPixel = totalSamples / juce::jmax (zoomLevel, 1.0) / juce::jmax (1.0, (double) getWidth());
+    const float x = (float) ((playbackPosition - scrollOffset) * totalSamples / samplesPerPixel);
 
-    // Update cache stamps
-    cachedPathWidth = currentWidth;
-    cachedThumbHash = totalFinished;
+    // 線の幅 2 + アンチエイリアスの端
+    return juce::Rectangle<float> (x - 2.0f, 0.0f, 4.0f, (float) getHeight()).getSmallestIntegerContainer()
+               .getIntersection (getLocalBounds());
 }
 
-// ── Helper ──────────────────────────────────────────────────────────────────
 void WaveformComponent::clampScroll()
 {
-    float visibleFraction = 1.0f / juce::jmax (zoomLevel, 1.0f);
-    float maxScroll = 1.0f - visibleFraction;
-    scrollOffset = juce::jlimit (0.0f, juce::jmax (maxScroll, 0.0f), scrollOffset);
+    const double maxScroll = 1.0 - 1.0 / juce::jmax (zoomLevel, 1.0);
+    scrollOffset = juce::jlimit (0.0, juce::jmax (maxScroll, 0.0), scrollOffset);
 }
@@ -8,21 +8,23 @@
 #pragma once
 #include <JuceHeader.h>
 #include "AudioEngine.h"
+#include "WaveformTileCache.h"
+#include "FrameScheduler.h"
 
 class WaveformComponent : public juce::Component,
-                          public juce::Timer,
-                          public juce::ChangeListener
+                          public juce::ChangeListener,
+                          private FrameScheduler::Client
 {
 public:
-    WaveformComponent (AudioEngine& engine);
+    WaveformComponent (AudioEngine& engine, FrameScheduler& scheduler);
     ~WaveformComponent() override;
 
     void paint (juce::Graphics& g) override;
     void resized() override;
-    void timerCallback() override;
     void changeListenerCallback (juce::ChangeBroadcaster* source) override;
 
     // Mouse interaction (desktop)
+    void mouseDown (const juce::MouseEvent& e) override; // 右クリックでチャンネルの並べ方
     void mouseDrag (const juce::MouseEvent& e) override;
     void mouseWheelMove (const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel) override;
 
@@ -33,41 +35,62 @@ public:
 
     void setExpanded (bool shouldExpand);
 
+    // 表示範囲を直接決める（ズームは最大倍率までに丸める。ベンチマークからも使う）
+    void setView (double newZoomLevel, double newScrollOffset);
+
+    // ステレオ以上のテイクのチャンネルを縦に並べるか 1 レーンに重ねるか
+    void setChannelLayout (WaveformTileCache::ChannelLayout newLayout);
+
 private:
-    // Rebuild waveformPath from AudioThumbnail.  O(width), NOT O(numSamples).
-    void rebuildWaveformPath();
+    // 画面のリフレッシュごと: 慣性スクロールを進め、録音・再生位置が描いたときから動いていれば repaint
+    bool advanceFrame (const FrameScheduler::Frame& frame) override;
+
     void clampScroll();
+    double getMaxZoom() const;
+    juce::Rectangle<int> getPlayheadStrip (double playbackPosition) const; // 再生位置の線が覆う帯
 
     AudioEngine& audioEngine;
+    FrameScheduler& frameScheduler;
     bool isExpanded = false;
 
     // ── Waveform zoom & scroll (Issue #15) ─────────────────────────────────
-    float zoomLevel = 1.0f;          // 1.0 = fit all, 2.0 = 2x zoom, etc.
-    float scrollOffset = 0.0f;       // 0..1 normalized scroll position
+    // 数時間の素材では表示幅が全体の 1e-6 以下になるので double で持つ（float だと左端が数十サンプル単位でしか動かない）
+    double zoomLevel = 1.0;          // 1.0 = fit all, 2.0 = 2x zoom, etc.
+    double scrollOffset = 0.0;       // 0..1 normalized scroll position（表示の左端 = scrollOffset * 全長）
+    static constexpr double maxPixelsPerSample = 8.0; // deepest zoom: one sample = 8 px
 
     // ── Pinch-zoom state ───────────────────────────────────────────────────
     int  primaryTouchIndex = -1;
     int  secondaryTouchIndex = -1;
     float pinchStartDistance = 0.0f;
-    float pinchStartZoom = 1.0f;
+    double pinchStartZoom = 1.0;
     bool isPinching = false;
 
     // ── Flick (momentum) state ─────────────────────────────────────────────
     float flickVelocity = 0.0f;      // pixels per second
     double lastFlickTime = 0.0;
     float lastFlickX = 0.0f;
+    static constexpr float minFlickVelocity = 5.0f;
 
     // ── Double-tap state ───────────────────────────────────────────────────
     double lastTapTime = 0.0;
     juce::Point<float> lastTapPos;
     static constexpr double doubleTapThreshold = 300.0; // ms
 
-    // ── Cached waveform path ──────────────────────────────────────────────
-    juce::Path waveformPath;
+    // ── Cached waveform tiles ─────────────────────────────────────────────
+    WaveformTileCache waveformTiles;
+
+    // Cache stamps — drop tiles / reset zoom only when the content changed
+    int cachedThumbnailGeneration = -1;
+    int cachedDeckGeneration = -1;
+
+    // 最後に描いたときの再生位置・録音済みサンプル数（変わったフレームだけ描き直す）
+    double paintedPlaybackPosition = -1.0;
+    juce::int64 paintedSampleCount = -1;
 
-    // Cache stamps — skip rebuild when nothing changed
-    int   cachedPathWidth   = 0;
-    int64 cachedThumbHash   = 0;
+    // advanceFrame が帯だけ無効化したときの再生位置（次の paint はエンジンを読み直さずこれを描く）
+    double playheadToPaint = 0.0;
+    bool hasPlayheadToPaint = false;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformComponent)
 };
@@ -0,0 +1,414 @@
+/*
+ ==============================================================================
+ WaveformPeaks.cpp
+ ==============================================================================
+ */
+#include "WaveformPeaks.h"
+
+namespace
+{
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+
+    constexpr int bandFftSize = 1 << WaveformPeaks::bandFftOrder;
+    constexpr int bandFramesPerBatch = 64;   // 1 回の読み出しで解析するフレーム数
+    constexpr juce::uint32 notifyIntervalMs = 100;
+
+    // 帯域の境目 [Hz]（低 / 中 / 高）。声の基音〜第 1 フォルマント / 母音 / 子音・息
+    constexpr double lowBandTopHz = 300.0;
+    constexpr double midBandTopHz = 3000.0;
+
+    // data は SIMD 境界、num は SIMD 幅の倍数
+    float sumOfSquares (const float* data, int num)
+    {
+        auto acc = SIMDFloat::expand (0.0f);
+
+        for (int i = 0; i < num; i += (int) SIMDFloat::SIMDNumElements)
+        {
+            const auto v = SIMDFloat::fromRawArray (data + i);
+            acc += v * v;
+        }
+
+        return acc.sum();
+    }
+
+    // 1 フレーム（bandFftSize 個のモノラル）を帯域ごとのエネルギーへ
+    class BandFrameAnalyser
+    {
+    public:
+        explicit BandFrameAnalyser (double sampleRateToUse)
+            : sampleRate (sampleRateToUse),
+              fft (WaveformPeaks::bandFftOrder),
+              window ((size_t) bandFftSize, juce::dsp::WindowingFunction<float>::hann, false),
+              storage ((size_t) (bandFftSize * 2 + (int) SIMDFloat::SIMDNumElements), true)
+        {
+            data = SIMDFloat::getNextSIMDAlignedPtr (storage.get());
+
+            // 出力は [re0, im0, re1, im1, ...]。帯域の境目のビンを SIMD 幅 / 2 の倍数に揃え、
+            // 各帯域が SIMD 境界から始まる連続した float の列になるようにする
+            const int align = juce::jmax (1, (int) SIMDFloat::SIMDNumElements / 2);
+            const int nyquistBin = bandFftSize / 2;
+
+            auto edgeFor = [&] (double hz, int minimum)
+            {
+                const int bin = juce::roundToInt (hz * bandFftSize / sampleRate);
+                return juce::jlimit (minimum, nyquistBin - align, (bin + align / 2) / align * align);
+            };
+
+            edges[0] = 0;
+            edges[1] = edgeFor (lowBandTopHz, align);
+            edges[2] = edgeFor (midBandTopHz, edges[1] + align);
+            edges[3] = nyquistBin;
+        }
+
+        const double sampleRate;
+
+        void process (const float* frame, WaveformPeaks::BandEnergies& energies)
+        {
+            std::copy (frame, frame + bandFftSize, data);
+            window.multiplyWithWindowingTable (data, (size_t) bandFftSize);
+            fft.performRealOnlyForwardTransform (data, true);
+
+            for (int band = 0; band < WaveformPeaks::numBands; ++band)
+                energies[(size_t) band] = sumOfSquares (data + 2 * edges[(size_t) band],
+                                                        2 * (edges[(size_t) band + 1] - edges[(size_t) band]));
+        }
+
+    private:
+        juce::dsp::FFT fft;
+        juce::dsp::WindowingFunction<float> window;
+        juce::HeapBlock<float> storage;
+        float* data = nullptr;
+        std::array<int, WaveformPeaks::numBands + 1> edges {};
+    };
+}
+
+WaveformPeaks::Pyramid::Pyramid (int numChannelsToUse, juce::int64 capacityToUse, double sampleRateToUse)
+    : numChannels (juce::jmax (0, numChannelsToUse)),
+      capacity (juce::jmax ((juce::int64) 0, capacityToUse)),
+      sampleRate (sampleRateToUse)
+{
+    // 最下段から、ビンが 1 つになるまで半分ずつ
+    auto halve = [] (juce::int64 n) { return n > 1 ? (n + 1) / 2 : (juce::int64) 0; };
+
+    bins.resize ((size_t) numChannels);
+    for (auto& levels : bins)
+        for (auto numBins = (capacity + baseBinSize - 1) >> baseShift; numBins > 0; numBins = halve (numBins))
+            levels.emplace_back ((size_t) numBins);
+
+    for (auto numFrames = (capacity + bandHopSize - 1) >> bandShift; numFrames > 0; numFrames = halve (numFrames))
+        bands.emplace_back ((size_t) numFrames, BandEnergies {});
+}
+
+WaveformPeaks::WaveformPeaks()
+    : juce::Thread ("WaveformPeaks")
+{
+}
+
+WaveformPeaks::~WaveformPeaks()
+{
+    stopBandAnalysis();
+}
+
+void WaveformPeaks::startBandAnalysis (SampleReader reader)
+{
+    stopBandAnalysis();
+    readSamples = std::move (reader);
+    startThread (juce::Thread::Priority::low);
+}
+
+void WaveformPeaks::stopBandAnalysis()
+{
+    stopThread (2000);
+    readSamples = nullptr;
+}
+
+void WaveformPeaks::reset (int numChannels, juce::int64 capacity, double sampleRate)
+{
+    auto fresh = std::make_shared<Pyramid> (numChannels, capacity, sampleRate);
+
+    {
+        const juce::ScopedLock pl (pyramidLock);
+        const juce::SpinLock::ScopedLockType sl (writeLock);
+        pyramid.swap (fresh);
+    }
+
+    notify(); // 解析スレッドを新しい中身へ
+
+    // 古いピラミッドはロック外で解放される（解析スレッドが持っていればそちらで）
+}
+
+juce::int16 WaveformPeaks::quantise (float value)
+{
+    return (juce::int16) juce::roundToInt (juce::jlimit (-1.0f, 1.0f, value) * 32767.0f);
+}
+
+void WaveformPeaks::addBlock (juce::int64 startSample, const juce::AudioBuffer<float>& source, int startOffset, int numSamples)
+{
+    // reset の差し替え中に来たブロックは捨てる（差し替え後は新しい中身が来る）
+    const juce::SpinLock::ScopedTryLockType sl (writeLock);
+    if (! sl.isLocked() || source.getNumChannels() == 0)
+        return;
+
+    auto& p = *pyramid;
+    const auto end = juce::jmin (startSample + numSamples, p.capacity);
+    if (startSample < 0 || end <= startSample)
+        return;
+
+    for (int ch = 0; ch < p.numChannels; ++ch)
+    {
+        const float* src = source.getReadPointer (juce::jmin (ch, source.getNumChannels() - 1), startOffset);
+        auto& levels = p.bins[(size_t) ch];
+
+        // 最下段のビンの境目で区切り、区間の min / max を全段のビンへ足し込む
+        for (auto pos = startSample; pos < end;)
+        {
+            const auto bin = pos >> baseShift;
+            const int num = (int) (juce::jmin (end, (bin + 1) << baseShift) - pos);
+            const auto range = juce::FloatVectorOperations::findMinAndMax (src + (pos - startSample), num);
+            const auto lo = quantise (range.getStart());
+            const auto hi = quantise (range.getEnd());
+
+            for (size_t level = 0; level < levels.size(); ++level)
+            {
+                auto& b = levels[level][(size_t) (bin >> level)];
+                b.min = juce::jmin (b.min, lo);
+                b.max = juce::jmax (b.max, hi);
+            }
+
+            pos += num;
+        }
+    }
+
+    if (end > p.numFinished.load (std::memory_order_relaxed))
+        p.numFinished.store (end, std::memory_order_release);
+}
+
+juce::int64 WaveformPeaks::getNumSamplesFinished() const
+{
+    return pyramid->numFinished.load (std::memory_order_acquire);
+}
+
+juce::int64 WaveformPeaks::getNumBandSamplesFinished() const
+{
+    return pyramid->numBandFrames.load (std::memory_order_acquire) << bandShift;
+}
+
+int WaveformPeaks::getNumChannels() const
+{
+    return pyramid->numChannels;
+}
+
+bool WaveformPeaks::getMinMax (int channel, juce::int64 start, juce::int64 end, float& minValue, float& maxValue) const
+{
+    const auto& p = *pyramid;
+    end = juce::jmin (end, p.numFinished.load (std::memory_order_acquire));
+    if (channel < 0 || channel >= p.numChannels || start < 0 || end <= start)
+        return false;
+
+    // 範囲の長さを超えない最も粗い段（揃った範囲ならビン 1 つ、そうでなくても 2〜3 個）
+    const auto& levels = p.bins[(size_t) channel];
+    size_t level = 0;
+    while (level + 1 < levels.size() && ((juce::int64) baseBinSize << (level + 1)) <= end - start)
+        ++level;
+
+    const int shift = baseShift + (int) level;
+    const auto& bins = levels[level];
+
+    Bin merged;
+    for (auto i = start >> shift; i <= (end - 1) >> shift; ++i)
+    {
+        merged.min = juce::jmin (merged.min, bins[(size_t) i].min);
+        merged.max = juce::jmax (merged.max, bins[(size_t) i].max);
+    }
+
+    if (merged.min > merged.max)
+        return false;
+
+    minValue = (float) merged.min / 32767.0f;
+    maxValue = (float) merged.max / 32767.0f;
+    return true;
+}
+
+bool WaveformPeaks::getBandEnergies (juce::int64 start, juce::int64 end, BandEnergies& energies) const
+{
+    const auto& p = *pyramid;
+    const auto numFrames = p.numBandFrames.load (std::memory_order_acquire);
+    const auto firstFrame = start >> bandShift;
+    if (start < 0 || end <= start || firstFrame >= numFrames)
+        return false;
+
+    const auto lastFrame = juce::jmin ((end - 1) >> bandShift, numFrames - 1);
+
+    // getMinMax と同じく、範囲を超えない最も粗い段から 1〜3 個
+    size_t level = 0;
+    while (level + 1 < p.bands.size() && ((juce::int64) 1 << (level + 1)) <= lastFrame - firstFrame + 1)
+        ++level;
+
+    energies = {};
+    for (auto i = firstFrame >> level; i <= lastFrame >> level; ++i)
+        for (int band = 0; band < numBands; ++band)
+            energies[(size_t) band] += p.bands[level][(size_t) i][(size_t) band];
+
+    return true;
+}
+
+int WaveformPeaks::getColumns (int channel, juce::int64 start, juce::int64 samplesPerColumn, int numColumns, ColumnPeak* dest) const
+{
+    const auto& p = *pyramid;
+    const auto finished = p.numFinished.load (std::memory_order_acquire);
+    if (channel < 0 || channel >= p.numChannels || start < 0 || samplesPerColumn <= 0 || numColumns <= 0)
+        return 0;
+
+    // 列の幅を超えない最も粗い段（2 の冪の列ならビン 1 つ、そうでなくても 2〜3 個）
+    const auto& levels = p.bins[(size_t) channel];
+    size_t level = 0;
+    while (level + 1 < levels.size() && ((juce::int64) baseBinSize << (level + 1)) <= samplesPerColumn)
+        ++level;
+
+    const int shift = baseShift + (int) level;
+    const auto& bins = levels[level];
+    int column = 0;
+
+    for (auto colStart = start; column < numColumns && colStart < finished; ++column, colStart += samplesPerColumn)
+    {
+        const auto colEnd = juce::jmin (colStart + samplesPerColumn, finished);
+
+        Bin merged;
+        for (auto i = colStart >> shift; i <= (colEnd - 1) >> shift; ++i)
+        {
+            merged.min = juce::jmin (merged.min, bins[(size_t) i].min);
+            merged.max = juce::jmax (merged.max, bins[(size_t) i].max);
+        }
+
+        auto& out = dest[column];
+        out = {};
+        if (merged.min <= merged.max)
+        {
+            out.min = (float) merged.min / 32767.0f;
+            out.max = (float) merged.max / 32767.0f;
+        }
+    }
+
+    return column;
+}
+
+int WaveformPeaks::getBandColumns (juce::int64 start, juce::int64 samplesPerColumn, int numColumns, BandEnergies* dest) const
+{
+    const auto& p = *pyramid;
+    const auto numFrames = p.numBandFrames.load (std::memory_order_acquire);
+    if (start < 0 || samplesPerColumn <= 0 || numColumns <= 0)
+        return 0;
+
+    // 1 列に入るフレーム数を超えない最も粗い段（列がフレームより細かければ最下段）
+    const auto framesPerColumn = juce::jmax ((juce::int64) 1, samplesPerColumn >> bandShift);
+    size_t level = 0;
+    while (level + 1 < p.bands.size() && ((juce::int64) 1 << (level + 1)) <= framesPerColumn)
+        ++level;
+
+    int column = 0;
+
+    for (auto colStart = start; column < numColumns; ++column, colStart += samplesPerColumn)
+    {
+        const auto firstFrame = colStart >> bandShift;
+        if (firstFrame >= numFrames)
+            break;
+
+        const auto lastFrame = juce::jmin ((colStart + samplesPerColumn - 1) >> bandShift, numFrames - 1);
+
+        auto& energies = dest[column];
+        energies = {};
+        for (auto i = firstFrame >> level; i <= lastFrame >> level; ++i)
+            for (int band = 0; band < numBands; ++band)
+                energies[(size_t) band] += p.bands[level][(size_t) i][(size_t) band];
+    }
+
+    return column;
+}
+
+// ── 帯域の解析スレッド ────────────────────────────────────────────────────
+void WaveformPeaks::run()
+{
+    // フレーム f の窓はホップ [f * hop, (f + 1) * hop) の中心に合わせる
+    constexpr int windowLead = bandFftSize / 2 - bandHopSize / 2;   // 窓の始まり = f * hop - windowLead
+    constexpr int windowTail = bandFftSize - windowLead;            // 窓の終わり = f * hop + windowTail
+
+    std::unique_ptr<BandFrameAnalyser> analyser;
+    std::vector<float> mono, channel;
+    bool unannounced = false;
+    auto lastNotify = juce::Time::getMillisecondCounter();
+
+    while (! threadShouldExit())
+    {
+        std::shared_ptr<Pyramid> p;
+        {
+            const juce::ScopedLock pl (pyramidLock);
+            p = pyramid;
+        }
+
+        const auto finished = p->numFinished.load (std::memory_order_acquire);
+        const auto firstFrame = p->numBandFrames.load (std::memory_order_relaxed);
+        const auto numFrames = p->bands.empty() ? (juce::int64) 0 : (juce::int64) p->bands[0].size();
+
+        // 窓の終わりまで揃ったフレームだけ。容量いっぱいまで来たら末尾は 0 埋めで
+        const bool complete = finished >= p->capacity;
+        auto endFrame = complete ? numFrames
+                                 : (finished >= windowTail ? (finished - windowTail) / bandHopSize + 1 : (juce::int64) 0);
+        endFrame = juce::jmin (endFrame, numFrames, firstFrame + bandFramesPerBatch);
+
+        if (endFrame <= firstFrame)
+        {
+            if (unannounced)
+            {
+                sendChangeMessage();
+                unannounced = false;
+            }
+
+            // 録音・デコード中は追いつくのを待つ。全部済んだら次の reset まで眠る
+            wait (complete ? -1 : 40);
+            continue;
+        }
+
+        if (analyser == nullptr || analyser->sampleRate != p->sampleRate)
+            analyser = std::make_unique<BandFrameAnalyser> (p->sampleRate);
+
+        // 窓の範囲をまとめて読み、チャンネルを平均してモノラルに（範囲外は 0）
+        const auto readStart = firstFrame * bandHopSize - windowLead;
+        const int readLength = (int) (endFrame - firstFrame - 1) * bandHopSize + bandFftSize;
+        mono.assign ((size_t) readLength, 0.0f);
+        channel.resize ((size_t) readLength);
+
+        const auto from = juce::jmax ((juce::int64) 0, readStart);
+        const int wanted = (int) (juce::jmin (readStart + readLength, finished) - from);
+        const int numChannels = juce::jmax (1, p->numChannels);
+
+        for (int ch = 0; ch < numChannels && wanted > 0; ++ch)
+        {
+            const int numRead = readSamples (ch, from, wanted, channel.data());
+            if (numRead > 0)
+                juce::FloatVectorOperations::addWithMultiply (mono.data() + (from - readStart), channel.data(),
+                                                              1.0f / (float) numChannels, numRead);
+        }
+
+        // 最下段に書き、上の段へ足し込む（min / max と同じく途中を読んでもそこまでの値）
+        for (auto frame = firstFrame; frame < endFrame; ++frame)
+        {
+            BandEnergies energies;
+            analyser->process (mono.data() + (frame - firstFrame) * bandHopSize, energies);
+
+            for (size_t level = 0; level < p->bands.size(); ++level)
+                for (int band = 0; band < numBands; ++band)
+                    p->bands[level][(size_t) (frame >> level)][(size_t) band] += energies[(size_t) band];
+        }
+
+        p->numBandFrames.store (endFrame, std::memory_order_release);
+        unannounced = true;
+
+        const auto now = juce::Time::getMillisecondCounter();
+        if (now - lastNotify >= notifyIntervalMs)
+        {
+            sendChangeMessage();
+            lastNotify = now;
+            unannounced = false;
+        }
+    }
+}
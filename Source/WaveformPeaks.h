@@ -0,0 +1,113 @@
+/*
+ ==============================================================================
+ WaveformPeaks.h
+ ==============================================================================
+ デッキ波形のピークのピラミッド（AudioThumbnail の代わり）。
+
+ • 最下段は 64 サンプル/ビンの min / max、1 段上がるごとにビンの幅が 2 倍
+   → どのズームでも「1 ピクセル列 = 1〜2 ビン」を読むだけ（表示幅に比例、長さに依らない）
+   64 サンプルより細かく見るときは呼び出し側が生のサンプルを読む
+ • 容量は reset で先に確保し、addBlock は確保しない（録音中はオーディオスレッドから呼ぶ）
+   min / max は足し込むだけなので、書きかけのビンを読んでもそこまでの値になる
+ • 値は int16 に量子化（1 時間のステレオでも数十 MB）
+ • チャンネルごとに持つ（ステレオ・多チャンネルのレーン表示用）。描画はタイル 1 枚の列を
+   getColumns で一括して読む（列ごとに段を選び直さない）
+
+ 帯域エネルギー（低 / 中 / 高）
+ • 専用スレッドが 256 サンプルごとに FFT（1024 点、Hann）し、帯域ごとのエネルギーを
+   ピークと同じ形のピラミッド（上の段は合計）に書き込む。子音・破裂音を探す色分け用
+ • 帯域の和は SIMD で取る（帯域の境目を SIMD 幅に揃えてある）
+ • 描画側は読むだけ（フレームごとの解析は無い）。進んだら sendChangeMessage
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+
+class WaveformPeaks : public juce::ChangeBroadcaster,
+                      private juce::Thread
+{
+public:
+    static constexpr int baseShift = 6;
+    static constexpr int baseBinSize = 1 << baseShift;
+
+    static constexpr int numBands = 3;           // 低 / 中 / 高
+    static constexpr int bandShift = 8;          // 帯域は 256 サンプルごと
+    static constexpr int bandHopSize = 1 << bandShift;
+    static constexpr int bandFftOrder = 10;      // 1024 点（窓の中心がホップの中心）
+    using BandEnergies = std::array<float, numBands>;
+
+    // 1 ピクセル列ぶんの min / max（-1..1）。まだ何も届いていない列は min > max
+    struct ColumnPeak
+    {
+        float min = 1.0f, max = -1.0f;
+        bool isEmpty() const { return min > max; }
+    };
+
+    // 帯域の解析に使う生のサンプル（channel の start から最大 num 個。読めた数を返す）
+    using SampleReader = std::function<int (int channel, juce::int64 start, int num, float* dest)>;
+
+    WaveformPeaks();
+    ~WaveformPeaks() override;
+
+    // 帯域の解析スレッド。reader は stopBandAnalysis まで生きていること
+    void startBandAnalysis (SampleReader reader);
+    void stopBandAnalysis();
+
+    // capacity サンプルぶんを確保して空にする（メッセージスレッド）
+    // 確保はロック外で行い、差し替える間だけ書き込みを止める
+    void reset (int numChannels, juce::int64 capacity, double sampleRate);
+
+    // startSample から numSamples を足す（書き込むスレッドは同時に 1 本。容量を超えた分は捨てる）
+    void addBlock (juce::int64 startSample, const juce::AudioBuffer<float>& source, int startOffset, int numSamples);
+
+    // 以下はメッセージスレッド専用
+    juce::int64 getNumSamplesFinished() const;
+    juce::int64 getNumBandSamplesFinished() const; // 帯域の解析が済んだ先頭
+    int getNumChannels() const;
+
+    // [start, end) の min / max。2^k * baseBinSize で揃った範囲ならビン 1 つを読むだけ
+    bool getMinMax (int channel, juce::int64 start, juce::int64 end, float& minValue, float& maxValue) const;
+
+    // [start, end) を含む帯域フレームのエネルギーの合計（比を見る用）。未解析なら false
+    bool getBandEnergies (juce::int64 start, juce::int64 end, BandEnergies& energies) const;
+
+    // 列ごとの一括読み出し（タイル 1 枚を 1 回で）。列 i = [start + i * samplesPerColumn, + samplesPerColumn)
+    // 段は最初に 1 度だけ選ぶ。samplesPerColumn は baseBinSize 以上のこと（細かい列は生のサンプルで）
+    // 揃っている先頭から埋めた列数を返す（途中の列は揃った所までの値）
+    int getColumns (int channel, juce::int64 start, juce::int64 samplesPerColumn, int numColumns, ColumnPeak* dest) const;
+    // 同じ列の帯域エネルギー。解析の済んでいない最初の列で止め、埋めた列数を返す
+    int getBandColumns (juce::int64 start, juce::int64 samplesPerColumn, int numColumns, BandEnergies* dest) const;
+
+private:
+    struct Bin
+    {
+        juce::int16 min = std::numeric_limits<juce::int16>::max();
+        juce::int16 max = std::numeric_limits<juce::int16>::min();
+    };
+
+    struct Pyramid
+    {
+        Pyramid (int numChannels, juce::int64 capacity, double sampleRate);
+
+        const int numChannels;
+        const juce::int64 capacity;
+        const double sampleRate;
+        std::vector<std::vector<std::vector<Bin>>> bins; // [channel][level][index]
+        std::atomic<juce::int64> numFinished { 0 };
+
+        std::vector<std::vector<BandEnergies>> bands;    // [level][frame]（上の段は合計）
+        std::atomic<juce::int64> numBandFrames { 0 };
+    };
+
+    void run() override;
+    static juce::int16 quantise (float value);
+
+    // pyramid を差し替えるのはメッセージスレッドだけ。解析スレッドは pyramidLock 内で複製を取る
+    std::shared_ptr<Pyramid> pyramid = std::make_shared<Pyramid> (0, 0, 44100.0);
+    juce::CriticalSection pyramidLock;
+    juce::SpinLock writeLock; // オーディオスレッドは try-lock（差し替え中のブロックは捨てる）
+
+    SampleReader readSamples;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformPeaks)
+};
@@ -0,0 +1,279 @@
+/*
+ ==============================================================================
+ WaveformTileCache.cpp
+ ==============================================================================
+ */
+#include "WaveformTileCache.h"
+
+WaveformTileCache::WaveformTileCache (WaveformPeaks& peaksToUse, SampleReader sampleReader, juce::Colour waveformColour)
+    : peaks (peaksToUse), readSamples (std::move (sampleReader)), colour (waveformColour),
+      bandColours { juce::Colour::fromString ("FFF97316"),    // 低: Orange 500
+                    waveformColour,                           // 中
+                    juce::Colour::fromString ("FF67E8F9") }   // 高: Cyan 300
+{
+}
+
+void WaveformTileCache::clear()
+{
+    tiles.clear();
+}
+
+void WaveformTileCache::setChannelLayout (ChannelLayout newLayout)
+{
+    if (layout == newLayout)
+        return;
+
+    layout = newLayout;
+    tiles.clear();
+}
+
+int WaveformTileCache::chooseLevel (double samplesPerPixel)
+{
+    // 2^level <= samplesPerPixel の最大の段（貼るときは縮小だけ。拡大するのは minLevel より細かく見るときだけ）
+    int level = minLevel;
+    while (level < maxLevel && std::ldexp (1.0, level + 1) <= samplesPerPixel)
+        ++level;
+
+    return level;
+}
+
+juce::int64 WaveformTileCache::getSamplesPerTile (int level)
+{
+    return level >= 0 ? (juce::int64) tileWidth << level : (juce::int64) (tileWidth >> -level);
+}
+
+void WaveformTileCache::draw (juce::Graphics& g, juce::Rectangle<float> area, double startSample, double endSample)
+{
+    const int height = juce::roundToInt (area.getHeight());
+    if (height <= 0 || area.getWidth() <= 0.0f || endSample <= startSample)
+        return;
+
+    // 高さが変わったら全タイルが無効（幅はサンプル位置で決まるので関係ない）
+    if (height != tileHeight)
+    {
+        tiles.clear();
+        tileHeight = height;
+    }
+
+    const auto numFinished = peaks.getNumSamplesFinished();
+    const double lastSample = juce::jmin (endSample, (double) numFinished);
+    if (lastSample <= startSample)
+        return;
+
+    const double samplesPerPixel = (endSample - startSample) / (double) area.getWidth();
+    const int level = chooseLevel (samplesPerPixel);
+    const auto samplesPerTile = getSamplesPerTile (level);
+
+    const auto firstTile = juce::jmax ((juce::int64) 0, (juce::int64) std::floor (startSample / (double) samplesPerTile));
+    const auto lastTile = (juce::int64) std::floor ((lastSample - 1.0) / (double) samplesPerTile);
+    const float tileScale = (float) ((double) samplesPerTile / samplesPerPixel) / (float) tileWidth;
+
+    g.saveState();
+    g.reduceClipRegion (area.getSmallestIntegerContainer());
+
+    for (auto index = firstTile; index <= lastTile; ++index)
+    {
+        const auto& tile = getTile (level, index, numFinished);
+        const float x = area.getX() + (float) (((double) (index * samplesPerTile) - startSample) / samplesPerPixel);
+
+        g.drawImageTransformed (tile.image, juce::AffineTransform::scale (tileScale, 1.0f).translated (x, area.getY()));
+    }
+
+    g.restoreState();
+
+    evict (level, firstTile, lastTile);
+}
+
+const WaveformTileCache::Tile& WaveformTileCache::getTile (int level, juce::int64 index, juce::int64 numFinished)
+{
+    auto& tile = tiles[{ level, index }];
+
+    // 描いた後に録音・デコード・帯域の解析が進んでいれば描き直す（伸びるのは最後のタイルだけ）
+    // 折れ線は次のタイルの先頭サンプルまで引くので 1 サンプル先まで見る
+    const auto tileEnd = (index + 1) * getSamplesPerTile (level);
+    if (! tile.image.isValid()
+        || tile.numSamplesCovered < juce::jmin (tileEnd + 1, numFinished)
+        || tile.numBandSamplesCovered < juce::jmin (tileEnd, peaks.getNumBandSamplesFinished()))
+        renderTile (tile, level, index, numFinished);
+
+    return tile;
+}
+
+void WaveformTileCache::renderTile (Tile& tile, int level, juce::int64 index, juce::int64 numFinished)
+{
+    if (tile.image.isValid())
+        tile.image.clear (tile.image.getBounds());
+    else
+        tile.image = juce::Image (juce::Image::ARGB, tileWidth, tileHeight, true);
+
+    juce::Graphics g (tile.image);
+    g.setColour (colour);
+
+    const auto tileStart = index * getSamplesPerTile (level);
+    const auto bandSamplesFinished = peaks.getNumBandSamplesFinished(); // 描く前に取る（途中で進んだ分は次で）
+
+    if (level >= 0)
+        renderPeaks (g, level, tileStart, numFinished);
+    else
+        renderSampleLine (g, level, tileStart, numFinished);
+
+    tile.numSamplesCovered = juce::jmin (tileStart + getSamplesPerTile (level) + 1, numFinished);
+    tile.numBandSamplesCovered = juce::jmin (tileStart + getSamplesPerTile (level), bandSamplesFinished);
+}
+
+WaveformTileCache::Lane WaveformTileCache::getLane (int channel, int numChannels) const
+{
+    // レーンの 90% を振幅 1 に（隣のレーンとの間に隙間を残す）
+    if (layout == ChannelLayout::overlaid || numChannels <= 1)
+        return { (float) tileHeight * 0.5f, (float) tileHeight * 0.45f };
+
+    const float laneHeight = (float) tileHeight / (float) numChannels;
+    return { laneHeight * ((float) channel + 0.5f), laneHeight * 0.45f };
+}
+
+float WaveformTileCache::getChannelAlpha (int channel) const
+{
+    // 重ねるときは 1 チャンネル目の上に薄く（差が出る所だけ色が変わる）
+    return layout == ChannelLayout::overlaid && channel > 0 ? 0.5f : 1.0f;
+}
+
+void WaveformTileCache::fillColumn (juce::Graphics& g, int x, Lane lane, WaveformPeaks::ColumnPeak peak,
+                                    const WaveformPeaks::BandEnergies* energies, float alpha) const
+{
+    // 上 = max、下 = min（非対称のまま）。無音でも 1 ピクセルは描く
+    const float top = lane.centre - juce::jlimit (-1.0f, 1.0f, peak.max) * lane.scale;
+    const float bottom = lane.centre - juce::jlimit (-1.0f, 1.0f, peak.min) * lane.scale;
+    const float barMid = (top + bottom) * 0.5f;
+    const float height = juce::jmax (1.0f, bottom - top);
+
+    if (energies == nullptr)
+    {
+        g.setColour (colour.withMultipliedAlpha (alpha));
+        g.fillRect ((float) x, barMid - height * 0.5f, 1.0f, height);
+        return;
+    }
+
+    // 振幅の比で分ける（エネルギーのままだと低域に潰される）
+    const float low = std::sqrt ((*energies)[0]), midBand = std::sqrt ((*energies)[1]), high = std::sqrt ((*energies)[2]);
+    const float total = low + midBand + high;
+    const float upperShare = total > 0.0f ? (midBand + high) / total : 0.0f;
+    const float highShare = total > 0.0f ? high / total : 0.0f;
+
+    // 外側から 低 → 中 → 高 の順に、バーの中点を中心に重ねる
+    const float heights[] = { height, height * upperShare, height * highShare };
+
+    for (int band = 0; band < WaveformPeaks::numBands; ++band)
+    {
+        if (heights[band] <= 0.0f)
+            break;
+
+        g.setColour (bandColours[(size_t) band].withMultipliedAlpha (alpha));
+        g.fillRect ((float) x, barMid - heights[band] * 0.5f, 1.0f, heights[band]);
+    }
+}
+
+void WaveformTileCache::renderPeaks (juce::Graphics& g, int level, juce::int64 tileStart, juce::int64 numFinished)
+{
+    const auto samplesPerPixel = (juce::int64) 1 << level;
+    const int numChannels = peaks.getNumChannels();
+
+    // ピラミッドより細かい段は生のサンプルを読む（タイル 1 枚 = 最大 tileWidth * 32 サンプル）
+    const bool fromSamples = samplesPerPixel < WaveformPeaks::baseBinSize;
+    const int wanted = fromSamples ? (int) juce::jmin (getSamplesPerTile (level), numFinished - tileStart) : 0;
+
+    columnScratch.resize ((size_t) tileWidth);
+    bandScratch.resize ((size_t) tileWidth);
+    sampleScratch.resize ((size_t) juce::jmax (0, wanted));
+
+    // 帯域はチャンネル共通（モノラルに混ぜて解析してある）
+    const int numBandColumns = peaks.getBandColumns (tileStart, samplesPerPixel, tileWidth, bandScratch.data());
+
+    // 1 ピクセル列 = 2^level サンプルの min / max。チャンネルごとにタイル 1 枚ぶんを一括で
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        int numColumns = 0;
+
+        if (fromSamples)
+        {
+            const int numRead = wanted > 0 ? readSamples (ch, tileStart, wanted, sampleScratch.data()) : 0;
+
+            for (int offset = 0; offset < numRead; offset += (int) samplesPerPixel, ++numColumns)
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax (sampleScratch.data() + offset,
+                                                                               juce::jmin ((int) samplesPerPixel, numRead - offset));
+                columnScratch[(size_t) numColumns] = { range.getStart(), range.getEnd() };
+            }
+        }
+        else
+        {
+            numColumns = peaks.getColumns (ch, tileStart, samplesPerPixel, tileWidth, columnScratch.data());
+        }
+
+        const auto lane = getLane (ch, numChannels);
+        const float alpha = getChannelAlpha (ch);
+
+        for (int x = 0; x < numColumns; ++x)
+            if (! columnScratch[(size_t) x].isEmpty())
+                fillColumn (g, x, lane, columnScratch[(size_t) x],
+                            x < numBandColumns ? &bandScratch[(size_t) x] : nullptr, alpha);
+    }
+}
+
+void WaveformTileCache::renderSampleLine (juce::Graphics& g, int level, juce::int64 tileStart, juce::int64 numFinished)
+{
+    // 1 サンプル = 2^-level ピクセル。前後のタイルと繋がるよう 1 サンプルずつはみ出して読む
+    const float pixelsPerSample = (float) (1 << -level);
+    const auto first = juce::jmax ((juce::int64) 0, tileStart - 1);
+    const int wanted = (int) (juce::jmin (tileStart + getSamplesPerTile (level) + 1, numFinished) - first);
+    if (wanted <= 0)
+        return;
+
+    sampleScratch.resize ((size_t) wanted);
+
+    // 1 タイル = 数十サンプルなので、帯域は一番強いものの色 1 色で（チャンネル共通）
+    auto lineColour = colour;
+    WaveformPeaks::BandEnergies energies;
+    if (peaks.getBandEnergies (tileStart, tileStart + getSamplesPerTile (level), energies))
+        lineColour = bandColours[(size_t) std::distance (energies.begin(), std::max_element (energies.begin(), energies.end()))];
+
+    const int numChannels = peaks.getNumChannels();
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const int numRead = readSamples (ch, first, wanted, sampleScratch.data());
+        if (numRead <= 0)
+            continue;
+
+        const auto lane = getLane (ch, numChannels);
+
+        auto pointAt = [&] (int i)
+        {
+            return juce::Point<float> ((float) (first + i - tileStart) * pixelsPerSample,
+                                       lane.centre - juce::jlimit (-1.0f, 1.0f, sampleScratch[(size_t) i]) * lane.scale);
+        };
+
+        juce::Path line;
+        line.startNewSubPath (pointAt (0));
+        for (int i = 1; i < numRead; ++i)
+            line.lineTo (pointAt (i));
+
+        g.setColour (lineColour.withMultipliedAlpha (getChannelAlpha (ch)));
+        g.strokePath (line, juce::PathStrokeType (1.5f));
+
+        // 1 サンプルが十分広ければサンプル点も打つ
+        if (pixelsPerSample >= 4.0f)
+            for (int i = 0; i < numRead; ++i)
+                g.fillEllipse (juce::Rectangle<float> (3.0f, 3.0f).withCentre (pointAt (i)));
+    }
+}
+
+void WaveformTileCache::evict (int level, juce::int64 firstVisible, juce::int64 lastVisible)
+{
+    // 上限を超えたら、見えているタイル以外から捨てる
+    for (auto it = tiles.begin(); it != tiles.end() && tiles.size() > maxCachedTiles;)
+    {
+        const bool visible = it->first.first == level
+                          && it->first.second >= firstVisible && it->first.second <= lastVisible;
+        it = visible ? std::next (it) : tiles.erase (it);
+    }
+}
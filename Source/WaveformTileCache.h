@@ -0,0 +1,104 @@
+/*
+ ==============================================================================
+ WaveformTileCache.h
+ ==============================================================================
+ デッキ波形のタイル描画。
+
+ • 波形を「サンプル位置で固定された」幅 tileWidth ピクセルのタイル画像に分けて持つ
+   タイル (level, index) は 1 ピクセル = 2^level サンプルで、
+   サンプル [index * tileWidth * 2^level, (index + 1) * tileWidth * 2^level) を描いたもの
+ • 描画はズームに最も近い（細かい側の）段のタイルを縮小して貼るだけ
+   → スクロール・ズームは貼る位置と倍率が変わるだけで描き直さない
+     （段が変わるのはズームが 2 倍変わったときだけ）
+ • 録音中に伸びるのは最後のタイルだけなので、描き直すのもそれだけ
+ • 1 回の描画で貼るのは画面幅ぶんのタイル数枚なので、テイクの長さ・ズームに依らない
+ • タイルを描くときの読み出しも「見える列数」に比例する
+     2^level >= 64   : ピークのピラミッドから 1 列 = 1 ビン
+     1 <= 2^level < 64: 生のサンプルを読んで列ごとの min / max
+     2^level < 1      : 生のサンプルを折れ線で（1 サンプルが数ピクセル）
+ • 帯域（低 / 中 / 高）の解析が済んだ列は 3 色の重ねたバーで描く
+     外側 = ピーク全体（低域の色）、その内側に 中 + 高 の割合、さらに内側に 高 の割合
+   子音・破裂音は高域の色が太く出る。解析が進んだタイルはそのとき描き直す
+ • チャンネルごとに本当の min / max で描く（上下非対称のまま。|max| で折り返さない）
+     stacked  : チャンネルごとのレーンを縦に並べる（L / R のパンが見える）
+     overlaid : 1 レーンに重ね、2 チャンネル目以降は薄く
+   ピークはタイル 1 枚ぶんの列をチャンネルごとに 1 回で読む（WaveformPeaks::getColumns）
+ ==============================================================================
+ */
+#pragma once
+#include <JuceHeader.h>
+#include "WaveformPeaks.h"
+
+class WaveformTileCache
+{
+public:
+    static constexpr int tileWidth = 256;
+
+    // 生のサンプルを読む（channel の start から最大 num 個。読めた数を返す）
+    using SampleReader = std::function<int (int channel, juce::int64 start, int num, float* dest)>;
+
+    enum class ChannelLayout { stacked, overlaid };
+
+    WaveformTileCache (WaveformPeaks& peaksToUse, SampleReader sampleReader, juce::Colour waveformColour);
+
+    // ピークの中身が入れ替わった（別のテイク・読み込み直し）→ 全部捨てる
+    void clear();
+
+    // チャンネルの並べ方（変えたら全タイルを描き直す）
+    void setChannelLayout (ChannelLayout newLayout);
+    ChannelLayout getChannelLayout() const { return layout; }
+
+    // サンプル範囲 [startSample, endSample) を area に描く。メッセージスレッド専用
+    void draw (juce::Graphics& g, juce::Rectangle<float> area, double startSample, double endSample);
+
+    int getNumCachedTiles() const { return (int) tiles.size(); }
+
+private:
+    struct Tile
+    {
+        juce::Image image;
+        juce::int64 numSamplesCovered = 0;     // 描いた時点で揃っていた範囲（タイルの末尾まで）
+        juce::int64 numBandSamplesCovered = 0; // 同じく帯域の解析が済んでいた範囲
+    };
+
+    using TileKey = std::pair<int, juce::int64>; // (level, index)
+
+    // チャンネル 1 本ぶんの縦の置き場所（0 の線の y と、振幅 1 の高さ）
+    struct Lane
+    {
+        float centre, scale;
+    };
+
+    const Tile& getTile (int level, juce::int64 index, juce::int64 numFinished);
+    void renderTile (Tile& tile, int level, juce::int64 index, juce::int64 numFinished);
+    void renderPeaks (juce::Graphics& g, int level, juce::int64 tileStart, juce::int64 numFinished);
+    void fillColumn (juce::Graphics& g, int x, Lane lane, WaveformPeaks::ColumnPeak peak,
+                     const WaveformPeaks::BandEnergies* energies, float alpha) const;
+    Lane getLane (int channel, int numChannels) const;
+    float getChannelAlpha (int channel) const;
+    void renderSampleLine (juce::Graphics& g, int level, juce::int64 tileStart, juce::int64 numFinished);
+    void evict (int level, juce::int64 firstVisible, juce::int64 lastVisible);
+    static int chooseLevel (double samplesPerPixel);
+    static juce::int64 getSamplesPerTile (int level);
+
+    WaveformPeaks& peaks;
+    const SampleReader readSamples;
+    const juce::Colour colour; // 帯域の解析前
+    const std::array<juce::Colour, WaveformPeaks::numBands> bandColours;
+
+    std::map<TileKey, Tile> tiles;
+    int tileHeight = 0;
+    ChannelLayout layout = ChannelLayout::stacked;
+
+    // タイル 1 枚を描く作業領域
+    std::vector<float> sampleScratch;                      // 生のサンプル（1 チャンネルぶん）
+    std::vector<WaveformPeaks::ColumnPeak> columnScratch;  // 列の min / max（1 チャンネルぶん）
+    std::vector<WaveformPeaks::BandEnergies> bandScratch;  // 列の帯域エネルギー
+
+    // 1 サンプル = 8 ピクセルまで（それ以上は拡大して貼る）
+    static constexpr int minLevel = -3;
+    static constexpr int maxLevel = 40;
+    static constexpr size_t maxCachedTiles = 48;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformTileCache)
+};